@@ -40,10 +40,6 @@
 #include "SurpriseFunction.h"
 #include "AsymptoticSurpriseFunction.h"
 
-#ifdef MATLAB_SUPPORT
-#include "mexInterrupt.h"
-#endif
-
 /**
  * @brief AgglomerativeOptimizer::AgglomerativeOptimizer
  * @param g
@@ -51,7 +47,7 @@
  * @param memb
  * @param weights
  */
-AgglomerativeOptimizer::AgglomerativeOptimizer(const igraph_t *g, const QualityFunction &fun, const igraph_vector_t *memb, const igraph_vector_t *weights) : QualityOptimizer(g, fun, memb)
+AgglomerativeOptimizer::AgglomerativeOptimizer(const igraph_t *g, const QualityFunction &fun, Membership *memb, const EdgeWeights &weights) : QualityOptimizer(g, fun, memb)
 {
     if (edges_order.empty())
     {
@@ -77,9 +73,9 @@ AgglomerativeOptimizer::~AgglomerativeOptimizer()
  * @param dest_comm
  * @return
  */
-double AgglomerativeOptimizer::diff_move(const igraph_t *g, const QualityFunction &fun, const igraph_vector_t *memb, int vert, size_t dest_comm, const igraph_vector_t *weights)
+double AgglomerativeOptimizer::diff_move(const igraph_t *g, const QualityFunction &fun, Membership *memb, int vert, size_t dest_comm, const EdgeWeights &weights)
 {
-    int orig_comm = memb->stor_begin[vert]; // save old original community of vert
+    int orig_comm = (*memb)[vert]; // save old original community of vert
 
     // Control the type of quality function with RTTI
     // Heuristic to skip edges in the same community. Surprise and AsymptoticSurprise do not change if the edge is already intracluster
@@ -87,20 +83,24 @@ double AgglomerativeOptimizer::diff_move(const igraph_t *g, const QualityFunctio
         return 0.0;
 
     // try to join the vertices
-    double pre = fun(par);
+    double pre = current_quality(fun);
+    ++counters.moves_attempted;
     bool vertex_moved = par->move_vertex(g, memb,vert,dest_comm,weights);
 
 
     if (vertex_moved)
     {
-        double post = fun(par);
+        double post = evaluate(fun);
         if (post<pre)
         {
             par->move_vertex(g, memb,vert,orig_comm,weights); // restore previous status
+            set_current_quality(pre);
+            ++counters.moves_reverted;
             return post-pre;
         }
         else
         {
+            ++counters.moves_accepted;
             return post-pre;
         }
     }
@@ -125,9 +125,10 @@ void AgglomerativeOptimizer::set_edges_order(const vector<int> &value)
  * @param weights
  * @return
  */
-double AgglomerativeOptimizer::optimize(const igraph_t *g, const QualityFunction &fun, const  igraph_vector_t *memb, const igraph_vector_t *weights)
+double AgglomerativeOptimizer::optimize(const igraph_t *g, const QualityFunction &fun, Membership *memb, const EdgeWeights &weights)
 {
-    par->init(g,memb,weights);
+    PACO_TRACE_SCOPE("AgglomerativeOptimizer::optimize");
+    init_partition_helper(g,memb,weights);
     if (edges_order.empty())
     {
         for (igraph_integer_t i=0; i<par->get_num_edges(); ++i)
@@ -141,9 +142,8 @@ double AgglomerativeOptimizer::optimize(const igraph_t *g, const QualityFunction
     size_t m = edges_order.size();
     for (size_t i=0; i<m; ++i)
     {
-        #ifdef MATLAB_SUPPORT
-            ctrlcCheckPoint(__FILE__, __LINE__);
-        #endif
+        if (interrupted())
+            break;
         int e = edges_order.at(i); // edge to consider
         int vert1, vert2;
         igraph_edge(g,e,&vert1,&vert2);
@@ -151,9 +151,9 @@ double AgglomerativeOptimizer::optimize(const igraph_t *g, const QualityFunction
         double deltaS=0;
         //printf(ANSI_COLOR_RED "Evaluating edge %d-%d\n",vert1,vert2);
 #endif
-        if ( rand()%2 ) // Randomly choose to aggregate vert1-->comm2 or vert2-->comm1
+        if ( random_integer(2) ) // Randomly choose to aggregate vert1-->comm2 or vert2-->comm1
         {
-            size_t dest_comm = memb->stor_begin[vert2];
+            size_t dest_comm = (*memb)[vert2];
 #ifdef DEBUG
             deltaS=
 #endif
@@ -161,7 +161,7 @@ double AgglomerativeOptimizer::optimize(const igraph_t *g, const QualityFunction
         }
         else
         {
-            size_t dest_comm = memb->stor_begin[vert1];
+            size_t dest_comm = (*memb)[vert1];
 #ifdef DEBUG
             deltaS=
 #endif
@@ -189,5 +189,5 @@ double AgglomerativeOptimizer::optimize(const igraph_t *g, const QualityFunction
 #endif
     //par->reindex(memb);
     //par->print();
-    return fun(par);
+    return final_quality(fun);
 }
@@ -43,13 +43,13 @@ class AgglomerativeOptimizer : public QualityOptimizer
 {
 public:
     AgglomerativeOptimizer() {}
-    AgglomerativeOptimizer(const igraph_t *g, const QualityFunction &fun, const  igraph_vector_t *memb,const igraph_vector_t *weights=NULL);
+    AgglomerativeOptimizer(const igraph_t *g, const QualityFunction &fun, Membership *memb,const EdgeWeights &weights=EdgeWeights());
     virtual ~AgglomerativeOptimizer();
-    double optimize(const igraph_t *g, const QualityFunction &fun, const igraph_vector_t *memb, const igraph_vector_t *weights=NULL);
+    double optimize(const igraph_t *g, const QualityFunction &fun, Membership *memb, const EdgeWeights &weights=EdgeWeights());
     void set_edges_order(const vector<int> &value);
 
 protected:
-    double diff_move(const igraph_t *g, const QualityFunction &fun, const igraph_vector_t *memb, int vert, size_t dest_comm, const igraph_vector_t *weights);
+    double diff_move(const igraph_t *g, const QualityFunction &fun, Membership *memb, int vert, size_t dest_comm, const EdgeWeights &weights);
     vector<int> edges_order;
 };
 
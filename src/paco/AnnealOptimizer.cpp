@@ -38,46 +38,60 @@
 #include "AnnealOptimizer.h"
 #include <set>
 
-#ifdef MATLAB_SUPPORT
-#include "mexInterrupt.h"
-#endif
+AnnealOptimizer::AnnealOptimizer()
+{
+    igraph_vector_init(&memb_igraph,0);
+}
 
-AnnealOptimizer::AnnealOptimizer(const igraph_t *g, const QualityFunction &fun,const  igraph_vector_t *memb, const igraph_vector_t *weights) : QualityOptimizer(g, fun, memb)
+AnnealOptimizer::AnnealOptimizer(const igraph_t *g, const QualityFunction &fun,Membership *memb, const EdgeWeights &weights) : QualityOptimizer(g, fun, memb)
 {
+    igraph_vector_init(&memb_igraph,0);
     this->optimize(g,fun,memb,weights);
 }
 
 AnnealOptimizer::~AnnealOptimizer()
 {
-
+    igraph_vector_destroy(&memb_igraph);
 }
 
-double AnnealOptimizer::diff_move(const igraph_t *g, const QualityFunction &fun, const igraph_vector_t *memb, int vert, size_t dest_comm, const igraph_vector_t *weights)
+double AnnealOptimizer::diff_move(const igraph_t *g, const QualityFunction &fun, Membership *memb, int vert, size_t dest_comm, const EdgeWeights &weights)
 {
     // try to join the vertices
-    double pre = fun(par);
-    int orig_comm = memb->stor_begin[vert]; // save old original community of vert
+    double pre = current_quality(fun);
+    int orig_comm = (*memb)[vert]; // save old original community of vert
+    ++counters.moves_attempted;
     bool vertex_moved = par->move_vertex(g, memb,vert,dest_comm,weights);
     if (vertex_moved)
     {
-        double post = fun(par);
+        double post = evaluate(fun);
         if (post<pre)
         {
             par->move_vertex(g, memb,vert,orig_comm,weights); // restore previous status
+            set_current_quality(pre);
+            ++counters.moves_reverted;
             return post-pre;
         }
         else
+        {
+            ++counters.moves_accepted;
             return post-pre;
+        }
     }
     else
         return 0;
 }
 
-double AnnealOptimizer::optimize(const igraph_t *g, const QualityFunction &fun, const  igraph_vector_t *memb, const igraph_vector_t *weights)
+double AnnealOptimizer::optimize(const igraph_t *g, const QualityFunction &fun, Membership *memb, const EdgeWeights &weights)
 {
-    par->init(g,memb);
-    igraph_rng_seed(igraph_rng_default(), time(0));
-    igraph_rng_t *rng = igraph_rng_default();
+    PACO_TRACE_SCOPE("AnnealOptimizer::optimize");
+    init_partition_helper(g,memb);
+    // Draws from the stream of the caller if set, otherwise from the igraph default one seeded on time
+    igraph_rng_t *rng = this->rng;
+    if (!rng)
+    {
+        rng = igraph_rng_default();
+        igraph_rng_seed(rng, time(0));
+    }
     int n = igraph_vcount(g);
     int nedges = igraph_ecount(g);
     size_t nhits = 0;
@@ -89,32 +103,28 @@ double AnnealOptimizer::optimize(const igraph_t *g, const QualityFunction &fun,
     //cerr << param.nIterations << " " << param.temperature << " " << param.temp_scale << " " << param.tolerance << " " << param.min_temp << endl;
 
     double best_val = 0;//std::numeric_limits<double>::min();
-    igraph_vector_t best_memb;
-    igraph_vector_init(&best_memb,n);
+    best_memb = *memb; // reuses the buffer of the previous calls
     // Start the optimization
 
     while (true)
     {
-        #ifdef MATLAB_SUPPORT
-            ctrlcCheckPoint(__FILE__, __LINE__);
-        #endif
-
         ++nstep;
-        double fval = fun(g,memb);
+        ++counters.quality_evaluations;
+        membership_to_igraph(*memb,&memb_igraph);
+        double fval = fun(g,&memb_igraph);
         if (fval > best_val)
         {
             best_val = fval;
-            cout << best_val << endl;
-            igraph_vector_update(&best_memb,memb);
+            best_memb = *memb;
         }
 
         temp = param.temperature*exp(-param.temp_scale*nstep/param.nIterations);
         // Choose a random edge
-        int e = rand()%igraph_ecount(g);
+        int e = random_integer(igraph_ecount(g));
         // Endpoints of random edge
         int ev1, ev2;
         igraph_edge(g,e,&ev1,&ev2);
-        size_t cev2 = memb->stor_begin[ev2];
+        size_t cev2 = (*memb)[ev2];
         // Get the difference in cost function of moving ev1 community to ev2 community
         double delta = diff_move(g,fun,memb,ev1,cev2,weights);
 
@@ -134,14 +144,14 @@ double AnnealOptimizer::optimize(const igraph_t *g, const QualityFunction &fun,
         if ( igraph_rng_get_unif01(rng) < 1E-3 )
         {
             int ec1=0,ec2=1;
-            int count_comms = std::set<int>(memb->stor_begin,memb->stor_end).size();
+            int count_comms = std::set<uint32_t>(memb->begin(),memb->end()).size();
             int c=0;
             while (c < count_comms)
             {
                 igraph_edge(g,igraph_rng_get_integer(rng,0,nedges-1),&ec1,&ec2);
-                if (memb->stor_begin[ec1] == memb->stor_begin[ec2])
+                if ((*memb)[ec1] == (*memb)[ec2])
                 {
-                    memb->stor_begin[ec1] = igraph_rng_get_integer(rng,0,n-1);
+                    (*memb)[ec1] = igraph_rng_get_integer(rng,0,n-1);
                 }
                 ++c;
             }
@@ -153,6 +163,10 @@ double AnnealOptimizer::optimize(const igraph_t *g, const QualityFunction &fun,
         {
             break;
         }
+        else if (interrupted())
+        {
+            break;
+        }
         else if (nhits > param.nHits || nstep>param.nIterations || temp < param.min_temp)
         {
             break;
@@ -160,8 +174,6 @@ double AnnealOptimizer::optimize(const igraph_t *g, const QualityFunction &fun,
     }
     //par->reindex(memb);
     // Copy the best solution to final membership
-    for (igraph_integer_t i=0; i<igraph_vector_size(memb); ++i)
-        VECTOR(*memb)[i] = VECTOR(best_memb)[i];
-    igraph_vector_destroy(&best_memb); // dispose memory
-    return fun(g,memb,weights);
+    memb->swap(best_memb);
+    return final_quality(g,fun,*memb,weights);
 }
@@ -67,18 +67,20 @@ public:
 class AnnealOptimizer : public QualityOptimizer
 {
 public:
-    AnnealOptimizer() {}
-    AnnealOptimizer(const igraph_t *g, const QualityFunction &fun, const igraph_vector_t *memb, const igraph_vector_t *weights=NULL);
+    AnnealOptimizer();
+    AnnealOptimizer(const igraph_t *g, const QualityFunction &fun, Membership *memb, const EdgeWeights &weights=EdgeWeights());
     virtual ~AnnealOptimizer();
     void set_parameters(const AnnealParameters &_par)
     {
         this->param = _par;
     }
-    double optimize(const igraph_t *g, const QualityFunction &fun, const igraph_vector_t *memb, const igraph_vector_t *weights=NULL);
+    double optimize(const igraph_t *g, const QualityFunction &fun, Membership *memb, const EdgeWeights &weights=EdgeWeights());
 
 protected:
-    double diff_move(const igraph_t *g, const QualityFunction &fun, const igraph_vector_t *memb, int vert, size_t dest_comm, const igraph_vector_t *weights);
+    double diff_move(const igraph_t *g, const QualityFunction &fun, Membership *memb, int vert, size_t dest_comm, const EdgeWeights &weights);
 
     AnnealParameters param;
+    Membership best_memb; // best membership found, kept between calls of optimize
+    igraph_vector_t memb_igraph; // membership converted for the quality function at every step, kept between calls
 };
 #endif // _ANNEALOPTIMIZER_H
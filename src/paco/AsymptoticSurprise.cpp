@@ -37,7 +37,7 @@
 
 #include "AsymptoticSurprise.h"
 
-double asymptoticSurprise(const long p, const long pi, const long m, const long mi)
+double asymptoticSurprise(const int64_t p, const int64_t pi, const int64_t m, const int64_t mi)
 {
     return m*KL(static_cast<double>(mi)/static_cast<double>(m), static_cast<double>(pi)/static_cast<double>(p));
 }
@@ -37,5 +37,6 @@
 
 #include "KLDivergence.h"
 #include <cmath>
+#include <stdint.h>
 
-double asymptoticSurprise(const long p, const long pi, const long m, const long mi);
+double asymptoticSurprise(const int64_t p, const int64_t pi, const int64_t m, const int64_t mi);
@@ -0,0 +1,314 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+#include <algorithm>
+#include <random>
+#include <unordered_set>
+#include <stdexcept>
+#include <cmath>
+#include "BenchmarkGraphs.h"
+
+/**
+ * @brief BenchmarkGraph::to_graph
+ * @param weighted uses the weights if they are set
+ * @return the graph, with all the num_nodes vertices even if some are isolated
+ */
+std::unique_ptr<GraphC> BenchmarkGraph::to_graph(bool weighted) const
+{
+    const double *w = (weighted && !weights.empty()) ? weights.data() : (const double*)NULL;
+    return std::unique_ptr<GraphC>(new GraphC(num_nodes,sources.size(),sources.data(),targets.data(),w));
+}
+
+/**
+ * @brief BenchmarkGraph::mixing
+ * @return the fraction of the edges between different communities of the ground truth
+ */
+double BenchmarkGraph::mixing() const
+{
+    size_t inter = 0;
+    for (size_t e=0; e<sources.size(); ++e)
+        inter += ground_truth[sources[e]]!=ground_truth[targets[e]];
+    return sources.empty() ? 0 : double(inter)/sources.size();
+}
+
+/**
+ * @brief add_edge Adds u-v if it is not a self loop nor an existing edge
+ * @return true if the edge was added
+ */
+static bool add_edge(BenchmarkGraph *graph, std::unordered_set<uint64_t> &existing, size_t u, size_t v)
+{
+    if (u==v)
+        return false;
+    if (u>v)
+        std::swap(u,v);
+    if (!existing.insert(static_cast<uint64_t>(u)*graph->num_nodes + v).second)
+        return false;
+    graph->sources.push_back(u);
+    graph->targets.push_back(v);
+    return true;
+}
+
+/**
+ * @brief planted_partition_graph Random graph with num_communities planted communities of equal size: every edge
+ * joins two vertices of different communities with probability mixing, of the same community otherwise.
+ * Vertex v belongs to community v % num_communities.
+ * @param num_nodes
+ * @param num_communities
+ * @param density fraction of the vertex pairs that are edges
+ * @param mixing
+ * @param seed
+ * @param graph
+ */
+void planted_partition_graph(size_t num_nodes, size_t num_communities, double density, double mixing, unsigned int seed, BenchmarkGraph *graph)
+{
+    const size_t n = num_nodes, k = num_communities;
+    if (n<2 || k<1 || k>n || !(density>0 && density<=1) || !(mixing>=0 && mixing<=1))
+        throw std::invalid_argument("Non valid planted partition parameters");
+    graph->num_nodes = n;
+    graph->sources.clear();
+    graph->targets.clear();
+    graph->weights.clear();
+    graph->ground_truth.resize(n);
+    for (size_t v=0; v<n; ++v)
+        graph->ground_truth[v] = v%k;
+
+    const uint64_t npairs = static_cast<uint64_t>(n)*(n-1)/2;
+    const uint64_t m = std::max<uint64_t>(1,static_cast<uint64_t>(density*npairs));
+    uint64_t intra_pairs = 0;
+    for (size_t c=0; c<k; ++c)
+    {
+        uint64_t csize = (n-c+k-1)/k;
+        intra_pairs += csize*(csize-1)/2;
+    }
+    // Rejection sampling gets too slow close to complete communities or bipartite parts
+    if ((1-mixing)*m > 0.9*intra_pairs || mixing*m > 0.9*(npairs-intra_pairs))
+        throw std::invalid_argument("Density too high for the number of communities and the mixing");
+
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<size_t> vertex(0,n-1);
+    std::uniform_real_distribution<double> unif(0,1);
+    std::unordered_set<uint64_t> existing;
+    while (graph->sources.size()<m)
+    {
+        // The kind of edge is drawn once and kept until an edge is added, otherwise the rejections of the
+        // denser intra community pairs would bias the mixing upwards
+        const bool intra = unif(gen)>=mixing;
+        for (bool added=false; !added; )
+        {
+            size_t u = vertex(gen), v;
+            if (intra)
+            {
+                // Community c has the vertices c, c+k, ... below n
+                size_t c = graph->ground_truth[u];
+                v = std::uniform_int_distribution<size_t>(0,(n-c+k-1)/k-1)(gen)*k + c;
+            }
+            else
+            {
+                v = vertex(gen);
+                if (graph->ground_truth[u]==graph->ground_truth[v])
+                    continue;
+            }
+            added = add_edge(graph,existing,u,v);
+        }
+    }
+}
+
+/**
+ * @brief power_law_sampler Distribution of the integers in [lo,hi] with probability proportional to x^-exponent
+ */
+static std::discrete_distribution<size_t> power_law_sampler(double exponent, size_t lo, size_t hi)
+{
+    std::vector<double> p(hi-lo+1);
+    for (size_t x=lo; x<=hi; ++x)
+        p[x-lo] = std::pow(double(x),-exponent);
+    return std::discrete_distribution<size_t>(p.begin(),p.end());
+}
+
+/**
+ * @brief power_law_mean Mean of the integers in [lo,hi] with probability proportional to x^-exponent
+ */
+static double power_law_mean(double exponent, size_t lo, size_t hi)
+{
+    double num = 0, den = 0;
+    for (size_t x=lo; x<=hi; ++x)
+    {
+        double p = std::pow(double(x),-exponent);
+        num += x*p;
+        den += p;
+    }
+    return num/den;
+}
+
+/**
+ * @brief lfr_graph LFR-style graph. Degrees follow a power law in [kmin,max_degree], with kmin chosen to match the average
+ * degree, and community sizes a power law in [min_community,max_community] summing to num_nodes. Every vertex gets
+ * round((1-mixing)*degree) stubs inside its community and the others outside, then the stubs are paired at random
+ * inside every community and across communities. Self loops, multiple edges and external stubs paired inside the same
+ * community are dropped, so degrees are slightly below the sampled ones. The realized mixing is given by BenchmarkGraph::mixing.
+ * @param pars
+ * @param seed
+ * @param graph
+ */
+void lfr_graph(const LFRParams &pars, unsigned int seed, BenchmarkGraph *graph)
+{
+    const size_t n = pars.num_nodes;
+    if (n<2 || !(pars.mixing>=0 && pars.mixing<=1) || pars.min_community<2 || pars.min_community>pars.max_community
+            || pars.max_community>n || pars.max_degree>=n || !(pars.avg_degree>=1 && pars.avg_degree<=pars.max_degree))
+        throw std::invalid_argument("Non valid LFR parameters");
+    std::mt19937 gen(seed);
+    graph->num_nodes = n;
+    graph->sources.clear();
+    graph->targets.clear();
+    graph->weights.clear();
+
+    // Degrees, the minimum one is the one whose mean is closest to the requested average
+    size_t kmin = 1;
+    for (size_t k=1; k<=pars.max_degree; ++k)
+    {
+        if (std::fabs(power_law_mean(pars.degree_exponent,k,pars.max_degree)-pars.avg_degree)
+                < std::fabs(power_law_mean(pars.degree_exponent,kmin,pars.max_degree)-pars.avg_degree))
+            kmin = k;
+    }
+    std::discrete_distribution<size_t> degree_sampler = power_law_sampler(pars.degree_exponent,kmin,pars.max_degree);
+    std::vector<size_t> degree(n);
+    for (size_t v=0; v<n; ++v)
+        degree[v] = kmin + degree_sampler(gen);
+
+    // Community sizes, the excess of the last one is removed from the largest ones
+    std::discrete_distribution<size_t> size_sampler = power_law_sampler(pars.community_exponent,pars.min_community,pars.max_community);
+    std::vector<size_t> sizes;
+    size_t total = 0;
+    while (total<n)
+    {
+        sizes.push_back(pars.min_community + size_sampler(gen));
+        total += sizes.back();
+    }
+    while (total>n)
+    {
+        std::vector<size_t>::iterator largest = std::max_element(sizes.begin(),sizes.end());
+        if (*largest<=pars.min_community)
+        {
+            // Can't shrink any more, drop the last community and grow the others
+            total -= sizes.back();
+            sizes.pop_back();
+            for (size_t c=0; total<n; c=(c+1)%sizes.size(), ++total)
+                ++sizes[c];
+            break;
+        }
+        --(*largest);
+        --total;
+    }
+
+    // Vertices by decreasing internal degree go to random communities large enough to hold it
+    std::vector<size_t> internal(n);
+    for (size_t v=0; v<n; ++v)
+        internal[v] = static_cast<size_t>(std::floor((1-pars.mixing)*degree[v]+0.5));
+    std::vector<size_t> order(n);
+    for (size_t v=0; v<n; ++v)
+        order[v] = v;
+    std::shuffle(order.begin(),order.end(),gen);
+    std::stable_sort(order.begin(),order.end(),[&](size_t a, size_t b) { return internal[a]>internal[b]; });
+    const size_t ncomms = sizes.size();
+    std::vector<size_t> free_slots(sizes);
+    std::vector<std::vector<size_t> > members(ncomms);
+    graph->ground_truth.assign(n,0);
+    std::uniform_int_distribution<size_t> community(0,ncomms-1);
+    for (size_t i=0; i<n; ++i)
+    {
+        size_t v = order[i], chosen = ncomms;
+        for (int attempt=0; attempt<50 && chosen==ncomms; ++attempt)
+        {
+            size_t c = community(gen);
+            if (free_slots[c]>0 && sizes[c]>internal[v])
+                chosen = c;
+        }
+        for (size_t c=0; c<ncomms && chosen==ncomms; ++c)
+        {
+            if (free_slots[c]>0 && sizes[c]>internal[v])
+                chosen = c;
+        }
+        for (size_t c=0; c<ncomms && chosen==ncomms; ++c)
+        {
+            if (free_slots[c]>0)
+                chosen = c;
+        }
+        internal[v] = std::min(internal[v],sizes[chosen]-1);
+        --free_slots[chosen];
+        members[chosen].push_back(v);
+        graph->ground_truth[v] = chosen;
+    }
+
+    // Pair the internal stubs of every community, then the external ones
+    std::unordered_set<uint64_t> existing;
+    std::vector<size_t> stubs;
+    for (size_t c=0; c<ncomms; ++c)
+    {
+        stubs.clear();
+        for (size_t i=0; i<members[c].size(); ++i)
+            stubs.insert(stubs.end(),internal[members[c][i]],members[c][i]);
+        std::shuffle(stubs.begin(),stubs.end(),gen);
+        for (size_t i=0; i+1<stubs.size(); i+=2)
+            add_edge(graph,existing,stubs[i],stubs[i+1]);
+    }
+    stubs.clear();
+    for (size_t v=0; v<n; ++v)
+        stubs.insert(stubs.end(),degree[v]-internal[v],v);
+    std::shuffle(stubs.begin(),stubs.end(),gen);
+    for (size_t i=0; i+1<stubs.size(); i+=2)
+    {
+        if (graph->ground_truth[stubs[i]]!=graph->ground_truth[stubs[i+1]])
+            add_edge(graph,existing,stubs[i],stubs[i+1]);
+    }
+}
+
+/**
+ * @brief set_benchmark_weights Sets weights uniform in [0.5,1.5) on the edges inside the communities of the ground truth
+ * and the same scaled by inter_weight on the edges between them
+ * @param graph
+ * @param inter_weight
+ * @param seed
+ */
+void set_benchmark_weights(BenchmarkGraph *graph, double inter_weight, unsigned int seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> unif(0.5,1.5);
+    graph->weights.resize(graph->num_edges());
+    for (size_t e=0; e<graph->num_edges(); ++e)
+    {
+        graph->weights[e] = unif(gen);
+        if (graph->ground_truth[graph->sources[e]]!=graph->ground_truth[graph->targets[e]])
+            graph->weights[e] *= inter_weight;
+    }
+}
@@ -0,0 +1,85 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+#ifndef _BENCHMARK_GRAPHS_H_
+#define _BENCHMARK_GRAPHS_H_
+
+#include <vector>
+#include <memory>
+#include <stdint.h>
+#include "Common.h"
+#include "Graph.h"
+
+/**
+ * A synthetic graph with a ground truth partition. Edge e joins sources[e] < targets[e], there are
+ * no self loops nor multiple edges. Weights are empty until set_benchmark_weights is called.
+ */
+struct BenchmarkGraph
+{
+    int32_t num_nodes;
+    std::vector<int32_t> sources;
+    std::vector<int32_t> targets;
+    std::vector<double> weights;
+    Membership ground_truth;
+
+    size_t num_edges() const
+    {
+        return sources.size();
+    }
+    std::unique_ptr<GraphC> to_graph(bool weighted) const;
+    double mixing() const;
+};
+
+/**
+ * Parameters of LFR-style graphs, after Lancichinetti, Fortunato and Radicchi, Phys. Rev. E 78, 046110 (2008):
+ * power law degrees and community sizes, every vertex has a fraction mixing of its edges outside its community.
+ */
+struct LFRParams
+{
+    size_t num_nodes=1000;
+    double mixing=0.3;
+    double avg_degree=20;
+    size_t max_degree=50;
+    double degree_exponent=2;
+    double community_exponent=1;
+    size_t min_community=20;
+    size_t max_community=100;
+};
+
+void planted_partition_graph(size_t num_nodes, size_t num_communities, double density, double mixing, unsigned int seed, BenchmarkGraph *graph);
+void lfr_graph(const LFRParams &pars, unsigned int seed, BenchmarkGraph *graph);
+void set_benchmark_weights(BenchmarkGraph *graph, double inter_weight, unsigned int seed);
+
+#endif // _BENCHMARK_GRAPHS_H_
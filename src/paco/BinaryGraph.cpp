@@ -0,0 +1,192 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+#include <climits>
+
+#include "BinaryGraph.h"
+#include "Graph.h"
+
+/**
+ * @brief BinaryGraph::BinaryGraph Map a .pacobin file and check its consistency
+ * @param filename
+ */
+BinaryGraph::BinaryGraph(const std::string &filename) : file(filename), header(NULL)
+{
+    this->validate(filename);
+}
+
+/**
+ * @brief BinaryGraph::validate Check the header, that every section lies inside the file and that every edge
+ * endpoint is a vertex, otherwise igraph would silently add the missing vertices
+ * @param filename
+ */
+void BinaryGraph::validate(const std::string &filename)
+{
+    if (file.size() < sizeof(PacoBinHeader))
+        throw std::runtime_error("Error, file " + filename + " is too short to be a .pacobin graph");
+    const PacoBinHeader *h = reinterpret_cast<const PacoBinHeader*>(file.data());
+    if (strncmp(h->magic,PACOBIN_MAGIC,8)!=0)
+        throw std::runtime_error("Error, file " + filename + " is not a .pacobin graph");
+    if (h->version != PACOBIN_VERSION)
+        throw std::runtime_error("Error, file " + filename + " has a non supported .pacobin version, convert it again with paco_convert");
+    if (h->byte_order != PACOBIN_BYTE_ORDER)
+        throw std::runtime_error("Error, file " + filename + " was written on a machine with different byte order");
+    if (h->num_vertices > static_cast<uint64_t>(INT_MAX) || h->num_edges > static_cast<uint64_t>(INT_MAX))
+        throw std::runtime_error("Error, file " + filename + " is too large for igraph integer indices");
+
+    uint64_t n = h->num_vertices;
+    uint64_t m = h->num_edges;
+    uint64_t fsize = file.size();
+    struct
+    {
+        uint64_t offset;
+        uint64_t bytes;
+    } sections[] = {
+        {h->edges_offset, 2*m*sizeof(uint32_t)},
+        {h->weights_offset, (h->flags & PACOBIN_WEIGHTED) ? m*((h->flags & PACOBIN_FLOAT32_WEIGHTS) ? sizeof(float) : sizeof(double)) : 0}
+    };
+    for (size_t i=0; i<sizeof(sections)/sizeof(sections[0]); ++i)
+    {
+        if (sections[i].bytes==0)
+            continue;
+        // Compared without sums, that could wrap around for corrupted offsets
+        if (sections[i].offset % sizeof(uint64_t) != 0 || sections[i].offset < sizeof(PacoBinHeader)
+                || sections[i].offset > fsize || sections[i].bytes > fsize - sections[i].offset)
+            throw std::runtime_error("Error, file " + filename + " is a truncated or corrupted .pacobin graph");
+    }
+    header = h;
+    const uint32_t *endpoints = edges();
+    for (uint64_t k=0; k<2*m; ++k)
+    {
+        if (endpoints[k] >= n)
+            throw std::runtime_error("Error, file " + filename + " has an edge endpoint out of the vertex range");
+    }
+}
+
+/**
+ * @brief align_offset
+ * @param offset
+ * @return the smallest multiple of PACOBIN_ALIGNMENT not less than offset
+ */
+static uint64_t align_offset(uint64_t offset)
+{
+    return ((offset + PACOBIN_ALIGNMENT - 1)/PACOBIN_ALIGNMENT)*PACOBIN_ALIGNMENT;
+}
+
+/**
+ * @brief write_section Write a block of data at the given absolute offset, padding with zeros
+ * @param out
+ * @param offset
+ * @param data
+ * @param bytes
+ */
+static void write_section(std::ofstream &out, uint64_t offset, const void *data, uint64_t bytes)
+{
+    static const char zeros[PACOBIN_ALIGNMENT] = {0};
+    uint64_t pos = static_cast<uint64_t>(out.tellp());
+    if (pos < offset)
+        out.write(zeros, offset-pos);
+    if (bytes>0)
+        out.write(static_cast<const char*>(data), bytes);
+}
+
+/**
+ * @brief write_binary_graph
+ * @param g
+ * @param filename
+ * @param float32_weights
+ */
+void write_binary_graph(const GraphC &g, const std::string &filename, bool float32_weights)
+{
+    const uint64_t n = g.number_of_nodes();
+    const uint64_t m = g.number_of_edges();
+    const EdgeWeights w = g.get_weights();
+
+    // Edge endpoints in edge id order
+    std::vector<uint32_t> edges(2*m);
+    for (uint64_t e=0; e<m; ++e)
+    {
+        std::pair<igraph_integer_t,igraph_integer_t> ft = g.get_edge(e);
+        edges[2*e] = ft.first;
+        edges[2*e+1] = ft.second;
+    }
+    std::vector<float> weights32;
+    std::vector<double> weights64;
+    if (w && float32_weights)
+    {
+        weights32.resize(m);
+        for (uint64_t e=0; e<m; ++e)
+            weights32[e] = static_cast<float>(w[e]);
+    }
+    else if (w && w.is_single_precision())
+    {
+        weights64.resize(m);
+        for (uint64_t e=0; e<m; ++e)
+            weights64[e] = w[e];
+    }
+
+    PacoBinHeader h;
+    memset(&h,0,sizeof(h));
+    strncpy(h.magic,PACOBIN_MAGIC,8);
+    h.version = PACOBIN_VERSION;
+    h.byte_order = PACOBIN_BYTE_ORDER;
+    h.flags = (w ? PACOBIN_WEIGHTED : 0) | ((w && float32_weights) ? PACOBIN_FLOAT32_WEIGHTS : 0) | (g.is_directed() ? PACOBIN_DIRECTED : 0);
+    h.num_vertices = n;
+    h.num_edges = m;
+    uint64_t weight_bytes = w ? m*(float32_weights ? sizeof(float) : sizeof(double)) : 0;
+    h.edges_offset = align_offset(sizeof(PacoBinHeader));
+    h.weights_offset = w ? align_offset(h.edges_offset + 2*m*sizeof(uint32_t)) : 0;
+
+    std::ofstream out(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out.good())
+        throw std::ios_base::failure("Error, cannot open file " + filename + " for writing");
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    write_section(out, h.edges_offset, edges.data(), 2*m*sizeof(uint32_t));
+    if (w)
+    {
+        if (float32_weights)
+            write_section(out, h.weights_offset, weights32.data(), weight_bytes);
+        else
+            write_section(out, h.weights_offset, w.is_single_precision() ? weights64.data() : w.igraph_vector()->stor_begin, weight_bytes);
+    }
+    if (!out.good())
+        throw std::ios_base::failure("Error writing file " + filename);
+    out.close();
+}
@@ -0,0 +1,154 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+
+#ifndef _BINARY_GRAPH_H_
+#define _BINARY_GRAPH_H_
+
+#include <string>
+#include <stdint.h>
+#include "MemoryMappedFile.h"
+
+class GraphC;
+
+/**
+ * The .pacobin file format is a native binary representation of a graph that can be memory mapped
+ * and used without any parsing. All the numbers are stored in the machine byte order, the order is
+ * checked at load time through the byte_order field of the header.
+ * The layout is a fixed size header followed by sections aligned at PACOBIN_ALIGNMENT bytes:
+ *
+ *   edges       uint32[2m]   edge endpoints (from,to) in edge id order, every endpoint less than n
+ *   weights     float64[m] or float32[m], only if PACOBIN_WEIGHTED
+ *
+ * The CSR adjacency and the vertex strengths are derived from the edges by GraphContext at load time.
+ * Files of version 1, which stored them too, must be converted again with paco_convert.
+ */
+
+#define PACOBIN_MAGIC "PACOBIN"
+#define PACOBIN_VERSION 2
+#define PACOBIN_BYTE_ORDER 0x01020304
+#define PACOBIN_ALIGNMENT 64
+
+enum PacoBinFlags
+{
+    PACOBIN_WEIGHTED = 1,
+    PACOBIN_FLOAT32_WEIGHTS = 2,
+    PACOBIN_DIRECTED = 8
+};
+
+struct PacoBinHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t flags;
+    uint32_t reserved0;
+    uint64_t num_vertices;
+    uint64_t num_edges;
+    uint64_t edges_offset;
+    uint64_t weights_offset;
+    uint64_t reserved[8];
+};
+
+/**
+ * @brief The BinaryGraph class is a read-only, zero-copy view on a memory mapped .pacobin file.
+ */
+class BinaryGraph
+{
+public:
+    BinaryGraph(const std::string &filename);
+    ~BinaryGraph() {}
+
+    size_t number_of_nodes() const
+    {
+        return header->num_vertices;
+    }
+
+    size_t number_of_edges() const
+    {
+        return header->num_edges;
+    }
+
+    bool is_weighted() const
+    {
+        return (header->flags & PACOBIN_WEIGHTED)!=0;
+    }
+
+    bool is_directed() const
+    {
+        return (header->flags & PACOBIN_DIRECTED)!=0;
+    }
+
+    bool has_float32_weights() const
+    {
+        return (header->flags & PACOBIN_FLOAT32_WEIGHTS)!=0;
+    }
+
+    const uint32_t *edges() const
+    {
+        return section<uint32_t>(header->edges_offset);
+    }
+
+    const double *weights64() const
+    {
+        return (is_weighted() && !has_float32_weights()) ? section<double>(header->weights_offset) : NULL;
+    }
+
+    const float *weights32() const
+    {
+        return (is_weighted() && has_float32_weights()) ? section<float>(header->weights_offset) : NULL;
+    }
+
+private:
+    template <class T>
+    const T *section(uint64_t offset) const
+    {
+        return reinterpret_cast<const T*>(file.data()+offset);
+    }
+    void validate(const std::string &filename);
+
+    MemoryMappedFile file;
+    const PacoBinHeader *header;
+};
+
+/**
+ * @brief write_binary_graph Save a graph in the .pacobin format
+ * @param g the graph to save
+ * @param filename
+ * @param float32_weights store the edge weights in single precision
+ */
+void write_binary_graph(const GraphC &g, const std::string &filename, bool float32_weights=false);
+
+#endif
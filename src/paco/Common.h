@@ -42,6 +42,7 @@
 #include <vector>
 #include <set>
 #include <map>
+#include <stdint.h>
 //#include <map>
 //#include <set>
 
@@ -73,9 +74,9 @@ using std::ofstream;
 /**
  * @brief num_pairs
  * @param x
- * @return
+ * @return x*(x-1)/2, computed in 64 bits so that it doesn't overflow for x>46341
  */
-inline int num_pairs(int x)
+inline int64_t num_pairs(int64_t x)
 {
     if (x<=1)
         return 0;
@@ -83,6 +84,54 @@ inline int num_pairs(int x)
         return x*(x-1)/2;
 }
 
+/**
+ * @brief mix64 splitmix64 step, a well mixed hash of x
+ * @param x
+ * @return
+ */
+inline uint64_t mix64(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief derived_seed Seed of the k-th stream drawn from seed, like a repetition or a batch job: a hash of seed and
+ * of k, so that every stream is independent of the thread it runs on
+ * @param seed
+ * @param k
+ * @return a nonnegative seed
+ */
+inline int derived_seed(int seed, size_t k)
+{
+    return static_cast<int>(mix64(static_cast<uint64_t>(seed) + 0x9E3779B97F4A7C15ULL*k) & 0x7FFFFFFF);
+}
+
+
+/**
+ * Membership of the vertices as used by the optimizers and PartitionHelper, membership[v] is the community of vertex v.
+ * The igraph_vector_t of reals form is only used at the API boundaries, see membership_from_igraph and membership_to_igraph.
+ */
+typedef vector<uint32_t> Membership;
+
+/**
+ * @brief renumber_first_appearance Renumbers the communities of memb in order of first appearance, so that equal
+ * partitions have equal memberships
+ * @param memb
+ */
+inline void renumber_first_appearance(Membership *memb)
+{
+    map<uint32_t,uint32_t> group_map;
+    for (size_t v=0; v<memb->size(); ++v)
+    {
+        map<uint32_t,uint32_t>::iterator it = group_map.find((*memb)[v]);
+        if (it==group_map.end())
+            it = group_map.insert(std::make_pair((*memb)[v],(uint32_t)group_map.size())).first;
+        (*memb)[v] = it->second;
+    }
+}
 
 /**
  * @brief mapvalue_sum
@@ -53,6 +53,10 @@
 #include "AnnealOptimizer.h"
 #include "AgglomerativeOptimizer.h"
 #include "RandomOptimizer.h"
+#include "LocalMoveOptimizer.h"
+#include "Surprise.h"
+#include "Timer.h"
+#include "Trace.h"
 
 
 /**
@@ -69,7 +73,7 @@ CommunityStructure::CommunityStructure(const GraphC *G)
  */
 CommunityStructure::~CommunityStructure()
 {
-    igraph_vector_destroy(&this->membership);
+    igraph_vector_destroy(&this->membership_igraph);
     igraph_vector_destroy(&edges_sim);
     igraph_rng_destroy(&this->rng);
 }
@@ -80,44 +84,36 @@ CommunityStructure::~CommunityStructure()
  */
 void CommunityStructure::read_membership_from_file(const string &filename)
 {
-    std::ifstream membership_file(filename.c_str());
-    if (!membership_file.good())
-        throw std::runtime_error(std::string("File not found"));
-
-    string line;
-    vector<igraph_real_t> vmemb;
-    while ( getline(membership_file,line) )
-    {
-        if (line.size() == 0)
-            continue;
-        std::stringstream str(line);
-        igraph_real_t memb;
-        str >> memb;
-        vmemb.push_back(memb);
-    }
-    if (vmemb.size() != static_cast<unsigned int>(this->nVertices))
-        throw std::runtime_error("Error loading membership file. Vertex number not consistent with current graph.");
+    this->initialize(FileInitializer(filename));
+}
 
-    for (igraph_integer_t i=0; i<this->nVertices; ++i)
-        VECTOR(membership)[i] = vmemb[i];
+/**
+ * @brief CommunityStructure::initialize Sets the membership with the initializer stage init, the optimizers start from it
+ * @param init
+ */
+void CommunityStructure::initialize(const PartitionInitializer &init)
+{
+    local_optimizer.reset();
+    init.initialize(*this->get_graph_context(),&membership,&this->rng);
 }
 
 void CommunityStructure::save_membership(const char *filename, const igraph_vector_t *m)
 {
+    std::ofstream outputmembership;
+    outputmembership.open(filename);
+    if (!outputmembership.good())
+        throw std::ios_base::failure("Error, file" + std::string(filename)+ " exists");
     if (m==NULL)
     {
-        save_membership(filename,&membership);
+        for (size_t i=0; i<membership.size(); i++)
+            outputmembership << membership[i] << endl;
     }
     else
     {
-        std::ofstream outputmembership;
-        outputmembership.open(filename);
-        if (!outputmembership.good())
-            throw std::ios_base::failure("Error, file" + std::string(filename)+ " exists");
         for (long int i=0; i<igraph_vector_size(m); i++)
             outputmembership << m->stor_begin[i] << endl;
-        outputmembership.close();
     }
+    outputmembership.close();
 }
 
 /**
@@ -128,18 +124,30 @@ void CommunityStructure::init(const GraphC *G)
 {
     // Copy the graph instance pointer
     this->pgraph = G;
+    this->context.reset();
+    this->initial_partition = InitialPrevious;
+    this->local_optimizer.reset();
+    this->local_weighted = false;
+    this->time_budget = 0;
+    this->budget_expired = false;
+    this->progress_callback = NULL;
+    this->progress_data = NULL;
+    this->progress_interval = 8192;
+    this->cancel_requested = false;
+    this->was_cancelled = false;
     if (G->number_of_nodes() ==0)
         throw std::logic_error("Graph with no vertices");
     if (G->number_of_edges()==0)
         throw std::logic_error("Graph with no edges");
     this->nVertices = G->number_of_nodes();
     this->nEdges = G->number_of_edges();
-    this->nPairs = nVertices*(nVertices-1)/2;
+    this->nPairs = num_pairs(nVertices);
 
     // Init the membership vector
-    IGRAPH_TRY(igraph_vector_init(&membership,nVertices));
+    membership.resize(nVertices);
     for (igraph_integer_t i=0; i<nVertices; ++i)
-        VECTOR(membership)[i]=i;
+        membership[i]=i;
+    IGRAPH_TRY(igraph_vector_init(&membership_igraph,0));
 
     // Initialize the vector containing the edges similarities
     IGRAPH_TRY(igraph_vector_init(&edges_sim,0));
@@ -150,7 +158,8 @@ void CommunityStructure::init(const GraphC *G)
 
 void CommunityStructure::print_membership()
 {
-    igraph_vector_print(&membership);
+    for (size_t i=0; i<membership.size(); ++i)
+        printf(i+1<membership.size() ? "%u " : "%u\n",membership[i]);
 }
 
 /**
@@ -188,10 +197,12 @@ void CommunityStructure::set_random_seed(int seed)
  */
 void CommunityStructure::reindex_membership()
 {
-    IGRAPH_TRY(igraph_reindex_membership(&this->membership,NULL));
-    int minC = igraph_vector_min(&this->membership);
+    local_optimizer.reset();
+    membership_to_igraph(membership,&membership_igraph);
+    IGRAPH_TRY(igraph_reindex_membership(&membership_igraph,NULL));
+    int minC = igraph_vector_min(&membership_igraph);
     for (igraph_integer_t i=0; i<nVertices; ++i)
-        VECTOR(membership)[i] -= minC;
+        membership[i] = VECTOR(membership_igraph)[i] - minC;
 }
 
 /**
@@ -201,39 +212,17 @@ void CommunityStructure::reindex_membership()
  */
 void CommunityStructure::order_membership()
 {
+    local_optimizer.reset();
     // groupmap
-    igraph_vector_t group_map; igraph_vector_init(&group_map,this->nVertices);
-    igraph_vector_fill(&group_map,-1);
-    int current_number=0;
+    std::map<uint32_t,uint32_t> group_map;
+    uint32_t current_number=0;
     for (int i=0; i<this->nVertices; ++i)
     {
-        if (group_map.stor_begin[int(membership.stor_begin[i])] < 0)
-        {
-            group_map.stor_begin[int(membership.stor_begin[i])] = current_number;
-            ++current_number;
-        }
+        std::map<uint32_t,uint32_t>::iterator it = group_map.find(membership[i]);
+        if (it == group_map.end())
+            it = group_map.insert(std::make_pair(membership[i],current_number++)).first;
+        membership[i] = it->second;
     }
-
-
-    igraph_vector_t newmemb;
-    igraph_vector_init(&newmemb,this->nVertices);
-    igraph_vector_fill(&newmemb,-1);
-
-    for (int i=0; i<this->nVertices; ++i)
-    {
-        int val = group_map.stor_begin[int(membership.stor_begin[i])];
-        if (val<0)
-            val = *(group_map.stor_end);
-        newmemb.stor_begin[i] = val;
-    }
-
-    //igraph_vector_print(&group_map);
-    //igraph_vector_print(&newmemb);
-
-    igraph_vector_update(&membership,&newmemb);
-    // Clean memory
-    igraph_vector_destroy(&group_map);
-    igraph_vector_destroy(&newmemb);
 }
 
 
@@ -246,10 +235,11 @@ void CommunityStructure::order_membership()
  */
 double CommunityStructure::optimize(QualityType qual, OptimizerType optmethod, int nrep)
 {
+    PACO_TRACE_SCOPE("CommunityStructure::optimize");
     QualityOptimizer *opt;
     QualityFunction *fun;
 
-    const igraph_vector_t *edge_weights = pgraph->get_edge_weights();
+    const EdgeWeights edge_weights = pgraph->get_weights();
 
 #ifdef WIN32
 	double finalqual = -1E10;
@@ -257,57 +247,37 @@ double CommunityStructure::optimize(QualityType qual, OptimizerType optmethod, i
     double finalqual = std::numeric_limits<double>::min();
 #endif
 
-    // Select the quality function
-    switch (qual)
-    {
-    case QualitySurprise:
+    local_optimizer.reset();
+    counters.clear();
+    budget_expired = false;
+    was_cancelled = false;
+    Timer timer;
+    timer.start();
+    const uint64_t surprise_terms = surpriseTailTerms();
+    // The budget includes the initialization, Infomap runs to completion
+    const std::chrono::steady_clock::time_point deadline = budget_deadline();
+    progress = OptimizerProgress();
+    progress.repetitions = nrep;
+    progress.best_quality = std::numeric_limits<double>::quiet_NaN();
+
+    // For Infomap it selects the partition with the minimum description length (last argument) and it saves it to final qual
+    if (qual==QualityInfoMap)
     {
-        if (pgraph->is_weighted())
-        {
-            throw std::logic_error("Can't optimize discrete surprise on weighted graph. Use AsymptoticSurprise instead.");
-        }
-        else
-        {
-            fun = dynamic_cast<SurpriseFunction*>(new SurpriseFunction);
-        }
-        break;
-    }
-    case QualitySignificance:
-    {
-        fun = dynamic_cast<SignificanceFunction*>(new SignificanceFunction);
-        break;
-    }
-    case QualityAsymptoticSurprise:
-    {
-        fun = dynamic_cast<AsymptoticSurpriseFunction*>(new AsymptoticSurpriseFunction);
-        break;
-    }
-    case QualityInfoMap:
-    {
-        // For Infomap it selects the partition with the minimum description length (last argument) and it saves it to final qual
-        igraph_community_infomap(pgraph->get_igraph(),edge_weights,NULL,nrep,&membership,&finalqual);
+        igraph_vector_t infomap_weights;
+        igraph_vector_init(&infomap_weights,0);
+        if (edge_weights.is_single_precision())
+            edge_weights.copy_to(&infomap_weights);
+        igraph_community_infomap(pgraph->get_igraph(),edge_weights.is_single_precision() ? &infomap_weights : edge_weights.igraph_vector(),NULL,nrep,&membership_igraph,&finalqual);
+        igraph_vector_destroy(&infomap_weights);
+        membership_from_igraph(&membership_igraph,membership);
+        timer.stop();
+        counters.optimize_time = timer.getElapsedTimeInSec();
+        cancel_requested = false;
         return finalqual;
     }
-//    case QualityAsymptoticModularity:
-//    {
-//        fun = dynamic_cast<AsymptoticModularityFunction*>(new AsymptoticModularityFunction);
-//        break;
-//    }
-//    case QualityWonder:
-//    {
-//        fun = dynamic_cast<WonderFunction*>(new WonderFunction);
-//        break;
-//    }
-//    case QualityDegreeCorrectedSurprise:
-//    {
-//        fun = dynamic_cast<DegreeCorrectedSurpriseFunction*>(new DegreeCorrectedSurpriseFunction);
-//        break;
-//    }
-    default:
-    {
-        throw std::logic_error("Non supported quality function");
-    }
-    }
+
+    // Select the quality function
+    fun = this->new_quality_function(qual);
 
     // Select the optimization method
     switch (optmethod)
@@ -315,7 +285,12 @@ double CommunityStructure::optimize(QualityType qual, OptimizerType optmethod, i
     case MethodAgglomerative:
     {
         opt = dynamic_cast<AgglomerativeOptimizer*>( new AgglomerativeOptimizer);
+        PACO_TRACE_SCOPE("edges order");
+        Timer sort_timer;
+        sort_timer.start();
         dynamic_cast<AgglomerativeOptimizer*>(opt)->set_edges_order(this->get_sorted_edges_indices());
+        sort_timer.stop();
+        counters.sort_time = sort_timer.getElapsedTimeInSec();
         break;
     }
     case MethodRandom:
@@ -334,23 +309,56 @@ double CommunityStructure::optimize(QualityType qual, OptimizerType optmethod, i
     }
     }
 
+    // All the repetitions share the same degrees, strengths and adjacency
+    opt->set_graph_context(this->get_graph_context());
+    // and draw from the random stream of this instance, independent from the other threads
+    opt->set_rng(&this->rng);
+    set_interruption(opt,deadline);
+
+    // The starting partition of the repetitions other than the one in membership
+    if (initial_partition==InitialGiven)
+        initial_membership = membership;
+
     // Now select the partition with the MAXIMUM quality value
-    igraph_vector_t best_membership;
-    igraph_vector_init(&best_membership,pgraph->number_of_nodes());
+    best_membership = membership;
+    timer.stop();
+    counters.init_time = timer.getElapsedTimeInSec() - counters.sort_time;
+    timer.start();
     //try
     //{
         for (int i=0; i<nrep; ++i)
         {
+            PACO_TRACE_SCOPE("repetition");
+            progress.repetition = i;
+            if (initial_partition==InitialSingletons)
+            {
+                for (size_t v=0; v<membership.size(); ++v)
+                    membership[v]=v;
+            }
+            else if (initial_partition==InitialGiven && i>0)
+                std::copy(initial_membership.begin(),initial_membership.end(),membership.begin());
+
+            // An interrupted repetition still gives a valid partition with its quality
             double qual = opt->optimize(pgraph->get_igraph(),*fun,&membership,edge_weights);
             if (qual>finalqual)
             {
                 finalqual = qual;
-                igraph_vector_update(&best_membership,&membership);
+                best_membership = membership;
             }
+            progress.best_quality = finalqual;
+            budget_expired = opt->deadline_expired() || (time_budget>0 && std::chrono::steady_clock::now()>=deadline);
+            was_cancelled = opt->cancelled() || cancel_requested || (i+1<nrep && !report_repetition(opt));
+            if (budget_expired || was_cancelled)
+                break;
         }
+        cancel_requested = false;
         // then copy back the content of best_membership to membership
-        igraph_vector_update(&membership,&best_membership);
-        igraph_vector_destroy(&best_membership);
+        membership.swap(best_membership);
+        timer.stop();
+        const OptimizerCounters &opt_counters = opt->get_counters();
+        counters += opt_counters;
+        counters.optimize_time = timer.getElapsedTimeInSec() - opt_counters.init_time - opt_counters.evaluation_time;
+        counters.surprise_terms = surpriseTailTerms() - surprise_terms;
     //}
     //catch ( std::exception &e )
     //{
@@ -362,6 +370,138 @@ double CommunityStructure::optimize(QualityType qual, OptimizerType optmethod, i
     return finalqual;
 }
 
+/**
+ * @brief CommunityStructure::quality Evaluates the current membership
+ * @param qual any quality type but Infomap
+ * @return
+ */
+double CommunityStructure::quality(QualityType qual) const
+{
+    if (qual==QualityInfoMap)
+        throw std::logic_error("Infomap has no quality function");
+    std::unique_ptr<QualityFunction> fun(this->new_quality_function(qual));
+    return (*fun)(pgraph->get_igraph(),membership,pgraph->get_weights());
+}
+
+/**
+ * @brief CommunityStructure::new_quality_function Creates the quality function qual, to be deleted by the caller
+ * @param qual any quality type but Infomap, which has no quality function
+ * @return
+ */
+QualityFunction *CommunityStructure::new_quality_function(QualityType qual) const
+{
+    switch (qual)
+    {
+    case QualitySurprise:
+    {
+        if (pgraph->is_weighted())
+        {
+            throw std::logic_error("Can't optimize discrete surprise on weighted graph. Use AsymptoticSurprise instead.");
+        }
+        else
+        {
+            return new SurpriseFunction;
+        }
+    }
+    case QualitySignificance:
+    {
+        return new SignificanceFunction;
+    }
+    case QualityAsymptoticSurprise:
+    {
+        return new AsymptoticSurpriseFunction;
+    }
+//    case QualityAsymptoticModularity:
+//    {
+//        return new AsymptoticModularityFunction;
+//    }
+//    case QualityWonder:
+//    {
+//        return new WonderFunction;
+//    }
+//    case QualityDegreeCorrectedSurprise:
+//    {
+//        return new DegreeCorrectedSurpriseFunction;
+//    }
+    default:
+    {
+        throw std::logic_error("Non supported quality function");
+    }
+    }
+}
+
+/**
+ * @brief CommunityStructure::reoptimize Re-optimizes the current membership after the graph has been edited
+ * in place with GraphC::apply_edits. The vertices of the changed edges are moved with local moves, that
+ * spread to their neighbors only while the quality improves. The partition aggregates are kept between
+ * successive calls and updated in O(changes), while the graph context is rebuilt from the edited graph.
+ * Any other change of the membership, such as optimize or initialize, recomputes them at the next call.
+ * @param changes as returned by GraphC::apply_edits
+ * @param qual
+ * @return the quality of the re-optimized membership
+ */
+double CommunityStructure::reoptimize(const std::vector<EdgeChange> &changes, QualityType qual)
+{
+    PACO_TRACE_SCOPE("CommunityStructure::reoptimize");
+    if (pgraph->number_of_nodes() != static_cast<size_t>(nVertices))
+        throw std::logic_error("Edited graph has a different number of vertices");
+    if (qual==QualityInfoMap)
+        throw std::logic_error("Infomap can't be re-optimized incrementally");
+    QualityFunction *fun = this->new_quality_function(qual);
+    budget_expired = false;
+    was_cancelled = false;
+    const std::chrono::steady_clock::time_point deadline = budget_deadline();
+    progress = OptimizerProgress();
+    progress.repetitions = 1;
+    progress.best_quality = std::numeric_limits<double>::quiet_NaN();
+
+    // The edge ids have changed
+    this->nEdges = pgraph->number_of_edges();
+    this->sorted_edges.clear();
+    this->get_graph_context();
+
+    // Aggregates updated with unit weights can't be reused once the graph is weighted, and the other way round
+    if (local_optimizer && local_weighted != pgraph->is_weighted())
+        local_optimizer.reset();
+    if (!local_optimizer)
+        local_optimizer.reset(new LocalMoveOptimizer);
+    local_weighted = pgraph->is_weighted();
+    local_optimizer->update_graph(context,changes,&membership);
+    local_optimizer->clear_counters();
+    set_interruption(local_optimizer.get(),deadline);
+    const uint64_t surprise_terms = surpriseTailTerms();
+    Timer timer;
+    timer.start();
+
+    std::vector<size_t> active;
+    active.reserve(2*changes.size());
+    for (size_t i=0; i<changes.size(); ++i)
+    {
+        active.push_back(changes[i].source);
+        active.push_back(changes[i].target);
+    }
+    double qual_value = local_optimizer->optimize_active(*fun,&membership,active);
+    budget_expired = local_optimizer->deadline_expired();
+    was_cancelled = local_optimizer->cancelled();
+    cancel_requested = false;
+    timer.stop();
+    counters = local_optimizer->get_counters();
+    counters.optimize_time = timer.getElapsedTimeInSec() - counters.evaluation_time;
+    counters.surprise_terms = surpriseTailTerms() - surprise_terms;
+    delete fun;
+    return qual_value;
+}
+
+/**
+ * @brief CommunityStructure::set_initial_partition Sets the partition every repetition of optimize starts from.
+ * The default InitialPrevious chains the repetitions, each one refining the output of the previous one.
+ * @param init
+ */
+void CommunityStructure::set_initial_partition(InitialPartition init)
+{
+    this->initial_partition = init;
+}
+
 /**
  * @brief CommunityStructure::compute_edges_similarities
  * See the implementation of "Density-based shrinkage for revealing hierarchical and overlapping
@@ -369,6 +509,7 @@ community structure in networks" Physica A 390 (2011) 2160-2171
  */
 void CommunityStructure::compute_edges_similarities()
 {
+    PACO_TRACE_SCOPE("edge similarities");
     if (!this->pgraph->is_weighted())
     {
         // Query the similarities for all edges
@@ -380,11 +521,18 @@ void CommunityStructure::compute_edges_similarities()
     }
     else
     {
+        // Single precision weights are widened only for the time of the computation
+        const EdgeWeights w = this->pgraph->get_weights();
+        igraph_vector_t wide_weights;
+        igraph_vector_init(&wide_weights,0);
+        if (w.is_single_precision())
+            w.copy_to(&wide_weights);
         igraph_similarity_jaccard_weighted_es(this->pgraph->get_igraph(),&edges_sim,
                                               igraph_ess_all(IGRAPH_EDGEORDER_ID),
-                                              this->pgraph->get_edge_weights(),
+                                              w.is_single_precision() ? &wide_weights : w.igraph_vector(),
                                               IGRAPH_ALL,
                                               false);
+        igraph_vector_destroy(&wide_weights);
         /*
         cerr << "=== EDGE WEIGHTS ===" << endl;
         for (igraph_integer_t i=0; i<this->nEdges; ++i)
@@ -401,6 +549,7 @@ void CommunityStructure::compute_edges_similarities()
  */
 void CommunityStructure::sort_edges()
 {
+    PACO_TRACE_SCOPE("sort edges");
     this->compute_edges_similarities(); // initialize the edges_sim igraph_vector_t
     sorted_edges.resize(nEdges);
 
@@ -436,7 +585,8 @@ void CommunityStructure::sort_edges()
             }
         }
         if (k>1)
-            std::random_shuffle(sorted_edges.begin()+i,sorted_edges.begin()+(k-1)+i);
+            std::random_shuffle(sorted_edges.begin()+i,sorted_edges.begin()+(k-1)+i,
+                                [this](long n) { return igraph_rng_get_integer(&this->rng,0,n-1); });
         if (k==0)
             break; // no further improvement has been done
         i+=k;
@@ -456,13 +606,152 @@ vector<int> CommunityStructure::get_sorted_edges_indices()
     return ei;
 }
 
+/**
+ * @brief CommunityStructure::get_counters
+ * @return the counters and the phase timings of the last call of optimize or reoptimize
+ */
+const OptimizerCounters &CommunityStructure::get_counters() const
+{
+    return counters;
+}
+
+/**
+ * @brief CommunityStructure::set_time_budget Limits the wall-clock time of the next calls of optimize and reoptimize.
+ * The optimizers check the clock while moving vertices and stop when the budget is over, then optimize returns the best
+ * of the repetitions done so far, the last one possibly incomplete. Infomap is run by igraph and ignores the budget.
+ * @param milliseconds the budget, no budget if zero or negative
+ */
+void CommunityStructure::set_time_budget(double milliseconds)
+{
+    this->time_budget = milliseconds;
+}
+
+/**
+ * @brief CommunityStructure::time_budget_expired
+ * @return true if the last optimize or reoptimize has been stopped by the time budget
+ */
+bool CommunityStructure::time_budget_expired() const
+{
+    return budget_expired;
+}
+
+/**
+ * @brief CommunityStructure::budget_deadline
+ * @return the time when the budget set by set_time_budget ends, counting from now
+ */
+std::chrono::steady_clock::time_point CommunityStructure::budget_deadline() const
+{
+    return std::chrono::steady_clock::now() + std::chrono::microseconds(static_cast<int64_t>(std::max(time_budget,0.0)*1000));
+}
+
+/**
+ * @brief CommunityStructure::set_interruption Makes opt stop at the deadline of the time budget, at cancel and when
+ * the progress callback returns false
+ * @param opt
+ * @param deadline
+ */
+void CommunityStructure::set_interruption(QualityOptimizer *opt, const std::chrono::steady_clock::time_point &deadline)
+{
+    opt->reset_interruption();
+    if (time_budget>0)
+        opt->set_deadline(deadline);
+    else
+        opt->clear_deadline();
+    opt->set_cancel_flag(&cancel_requested);
+    opt->set_progress_callback(progress_callback ? &CommunityStructure::report_progress : NULL,this,progress_interval);
+}
+
+/**
+ * @brief CommunityStructure::set_progress_callback Sets the function called every interval steps of the optimizers
+ * and at the end of every repetition but the last one. Returning false it stops optimize or reoptimize as cancel does.
+ * @param callback NULL for none
+ * @param data passed to callback
+ * @param interval
+ */
+void CommunityStructure::set_progress_callback(ProgressCallback callback, void *data, unsigned int interval)
+{
+    this->progress_callback = callback;
+    this->progress_data = data;
+    this->progress_interval = interval;
+}
+
+/**
+ * @brief CommunityStructure::cancel Stops the optimize or reoptimize running in another thread, or the next one, that returns
+ * the best partition found so far. It can be called from any thread and from the progress callback, Infomap ignores it.
+ */
+void CommunityStructure::cancel()
+{
+    cancel_requested = true;
+}
+
+/**
+ * @brief CommunityStructure::cancelled
+ * @return true if the last optimize or reoptimize has been stopped by cancel or by the progress callback
+ */
+bool CommunityStructure::cancelled() const
+{
+    return was_cancelled;
+}
+
+/**
+ * @brief CommunityStructure::report_progress Adds the repetitions to the progress of the optimizer and passes it to the callback
+ * @param progress
+ * @param data the CommunityStructure
+ * @return the return value of the callback
+ */
+bool CommunityStructure::report_progress(const OptimizerProgress &progress, void *data)
+{
+    CommunityStructure *comm = static_cast<CommunityStructure*>(data);
+    OptimizerProgress p = progress;
+    p.repetition = comm->progress.repetition;
+    p.repetitions = comm->progress.repetitions;
+    p.best_quality = comm->progress.best_quality;
+    return comm->progress_callback(p,comm->progress_data);
+}
+
+/**
+ * @brief CommunityStructure::report_repetition Calls the progress callback at the end of a repetition
+ * @param opt
+ * @return false if the callback cancels the optimization
+ */
+bool CommunityStructure::report_repetition(QualityOptimizer *opt)
+{
+    if (!progress_callback)
+        return true;
+    return report_progress(opt->get_progress(),this);
+}
+
+/**
+ * @brief CommunityStructure::set_graph_context Shares a context already built on the same graph,
+ * for example by other CommunityStructure instances optimizing it concurrently
+ * @param ctx
+ */
+void CommunityStructure::set_graph_context(const std::shared_ptr<const GraphContext> &ctx)
+{
+    if (ctx && ctx->get_igraph()!=pgraph->get_igraph())
+        throw std::logic_error("Graph context built on a different graph");
+    this->context = ctx;
+}
+
+/**
+ * @brief CommunityStructure::get_graph_context
+ * @return the shared context of the graph, built on first use and again after the graph is edited
+ */
+std::shared_ptr<const GraphContext> CommunityStructure::get_graph_context()
+{
+    if (!context || context->get_graph_revision()!=pgraph->get_revision())
+        context = std::make_shared<const GraphContext>(*pgraph);
+    return context;
+}
+
 /**
  * @brief CommunityStructure::get_membership
  * @return
  */
 const igraph_vector_t* CommunityStructure::get_membership() const
 {
-    return &this->membership;
+    membership_to_igraph(this->membership,&this->membership_igraph);
+    return &this->membership_igraph;
 }
 
 /**
@@ -473,7 +762,7 @@ vector<int> CommunityStructure::get_membership_vector() const
 {
     vector<int> memb(this->nVertices);
     for (int i=0; i<nVertices; ++i)
-        memb.at(i) = this->membership.stor_begin[i];
+        memb.at(i) = this->membership[i];
     return memb;
 }
 
@@ -484,6 +773,6 @@ vector<int> CommunityStructure::get_membership_vector() const
  */
 size_t CommunityStructure::get_membership(size_t i) const
 {
-    return static_cast<size_t>(std::floor(this->membership.stor_begin[i]));
+    return this->membership.at(i);
 }
 
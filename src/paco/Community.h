@@ -38,6 +38,8 @@
 #define _COMMUNITY_H_
 
 #include <memory>
+#include <atomic>
+#include <chrono>
 #include <vector>
 #include <map>
 #include <algorithm>
@@ -45,6 +47,15 @@
 #include <sstream>
 
 #include "Graph.h"
+#include "GraphContext.h"
+#include "PartitionInitializer.h"
+#include "GraphEdits.h"
+#include "OptimizerCounters.h"
+#include "OptimizerProgress.h"
+
+class LocalMoveOptimizer;
+class QualityOptimizer;
+class QualityFunction;
 
 enum OptimizerType
 {
@@ -68,6 +79,13 @@ enum QualityType
 #endif
 };
 
+enum InitialPartition
+{
+    InitialPrevious = 0,    // every repetition starts from the partition found by the previous one
+    InitialSingletons = 1,  // every repetition starts from singleton communities
+    InitialGiven = 2        // every repetition starts from the membership given before optimize
+};
+
 class CommunityStructure
 {
 public:
@@ -78,6 +96,7 @@ public:
 
     // Methods that work on membership
     void read_membership_from_file(const std::string &filename);
+    void initialize(const PartitionInitializer &init);
     const igraph_vector_t* get_membership() const;
     vector<int> get_membership_vector() const; // for python version of PACO
     size_t get_membership(size_t i) const;
@@ -90,18 +109,62 @@ public:
     void sort_edges();
     vector<int> get_sorted_edges_indices();
     double optimize(QualityType qual, OptimizerType opt, int nrep=1);
+    double quality(QualityType qual) const;
+    void set_initial_partition(InitialPartition init);
+    // Re-optimizes the current membership around the edges changed by GraphC::apply_edits
+    double reoptimize(const std::vector<EdgeChange> &changes, QualityType qual);
+
+    // Read-only graph data shared by the optimizers, built at the first optimization if not set
+    void set_graph_context(const std::shared_ptr<const GraphContext> &ctx);
+    std::shared_ptr<const GraphContext> get_graph_context();
+
+    // Counters and phase timings of the last optimize or reoptimize
+    const OptimizerCounters &get_counters() const;
+
+    // Wall-clock budget of optimize and reoptimize, after which they return the best partition found so far
+    void set_time_budget(double milliseconds);
+    bool time_budget_expired() const;
+
+    // Progress reports of optimize and reoptimize, and their cancellation from any thread
+    void set_progress_callback(ProgressCallback callback, void *data=NULL, unsigned int interval=8192);
+    void cancel();
+    bool cancelled() const;
 
 protected:
+    QualityFunction *new_quality_function(QualityType qual) const;
     void compute_pairwise_similarities();
     void compute_edges_similarities();
+    std::chrono::steady_clock::time_point budget_deadline() const;
+    void set_interruption(QualityOptimizer *opt, const std::chrono::steady_clock::time_point &deadline);
+    bool report_repetition(QualityOptimizer *opt);
+    static bool report_progress(const OptimizerProgress &progress, void *data);
 
 private:
     const GraphC* pgraph; // internal pointer to Graph proxy
     igraph_integer_t nVertices;
     igraph_integer_t nEdges;
-    igraph_integer_t nPairs;
+    int64_t nPairs;
+
+    std::shared_ptr<const GraphContext> context;
+    Membership membership;
+    // Buffers of optimize, kept between calls so that repetitions do not reallocate them
+    Membership best_membership;
+    Membership initial_membership;
+    InitialPartition initial_partition;
+    OptimizerCounters counters;
+    double time_budget; // milliseconds, no budget if not positive
+    bool budget_expired;
+    ProgressCallback progress_callback;
+    void *progress_data;
+    unsigned int progress_interval;
+    OptimizerProgress progress; // repetitions of the optimization in progress
+    std::atomic<bool> cancel_requested;
+    bool was_cancelled;
 
-    igraph_vector_t membership;
+    // Partition helper kept by reoptimize between successive edits, dropped when the membership changes otherwise
+    std::unique_ptr<LocalMoveOptimizer> local_optimizer;
+    bool local_weighted;
+    mutable igraph_vector_t membership_igraph; // real-valued copy handed out by get_membership()
 
     // Random number generator
     igraph_rng_t rng;
@@ -33,15 +33,15 @@ void ConditionalSurpriseFunction::eval(const igraph_t *g, const igraph_vector_t
 {
     size_t n = igraph_vcount(g);
     size_t m = igraph_ecount(g);
-    size_t p = n*(n-1)/2;
+    int64_t p = num_pairs(n);
 
     if (n != (size_t)igraph_vector_size(memb) )
         throw std::runtime_error("Non consistent length of membership vector");
 
     // Sum of intracluster edge weights
-    size_t mzeta=0;
+    int64_t mzeta=0;
     // Sum of intracluster pairs
-    size_t pzeta=0;
+    int64_t pzeta=0;
 
     // Initialize the vectors of edges and configuration model
     size_t nComms=(size_t)igraph_vector_max(memb)+1; // XXX to fix in a future...
@@ -56,14 +56,14 @@ void ConditionalSurpriseFunction::eval(const igraph_t *g, const igraph_vector_t
         igraph_edge(g, edge_id, &from, &to);
         igraph_integer_t comm_from=*(memb->stor_begin+from); // Community node "from" belongs
         igraph_integer_t comm_to=*(memb->stor_begin+to);  // Community node "to" belongs
-        mzeta += size_t(comm_from==comm_to);
+        mzeta += int64_t(comm_from==comm_to);
     }
 
     // Sum the count of vertex pairs in every community
     for (size_t c=0; c<nComms; c++)
     {
         size_t vertices_count = std::count(memb->stor_begin, memb->stor_end, c);
-        pzeta += vertices_count*(vertices_count-1)/2;
+        pzeta += num_pairs(vertices_count);
     }
     cerr <<"Error FIX compute conditional Surprise" << endl;
     //#pragma message("Error FIX compute conditional Surprise")
@@ -72,10 +72,10 @@ void ConditionalSurpriseFunction::eval(const igraph_t *g, const igraph_vector_t
 
 void ConditionalSurpriseFunction::eval(const PartitionHelper *par) const
 {
-    double p = par->get_graph_total_pairs();
-    double pi = par->get_total_incomm_pairs();
-    double m = par->get_graph_total_weight();
-    double mi = par->get_total_incomm_weight();
+    int64_t p = par->get_graph_total_pairs();
+    int64_t pi = par->get_total_incomm_pairs();
+    int64_t m = checkedCount(par->get_graph_total_weight(),"m");
+    int64_t mi = checkedCount(par->get_total_incomm_weight(),"mi");
     size_t n = par->get_num_vertices();
     cerr <<"Error FIX compute conditional Surprise" << endl;
     //#pragma message("Error FIX compute conditional Surprise")
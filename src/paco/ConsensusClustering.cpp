@@ -0,0 +1,196 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include "ConsensusClustering.h"
+#include "RepetitionRace.h"
+#include "PartitionInitializer.h"
+#include "Trace.h"
+#include "igraph_utils.h"
+
+/**
+ * Co-assignment counts of the edges of a round, one vector per thread so that the threads don't contend
+ */
+struct CoAssignment
+{
+    std::vector<igraph_integer_t> sources;
+    std::vector<igraph_integer_t> targets;
+    std::vector< std::vector<uint32_t> > counts; // [thread][edge]
+    std::vector<size_t> repetitions;             // [thread]
+};
+
+/**
+ * @brief accumulate_coassignment Repetition callback, counts the edges within a community
+ * @param comm
+ * @param quality
+ * @param thread
+ * @param data the CoAssignment
+ */
+static void accumulate_coassignment(const CommunityStructure &comm, double quality, unsigned int thread, void *data)
+{
+    CoAssignment *co = static_cast<CoAssignment*>(data);
+    std::vector<uint32_t> &count = co->counts[thread];
+    for (size_t e=0; e<count.size(); ++e)
+        count[e] += comm.get_membership(co->sources[e])==comm.get_membership(co->targets[e]);
+    ++co->repetitions[thread];
+}
+
+/**
+ * @brief ConsensusClustering::ConsensusClustering
+ * @param g
+ * @param nthreads 0 for all the cores, or one if igraph isn't thread safe. More than one throws std::logic_error
+ * without a thread safe igraph.
+ */
+ConsensusClustering::ConsensusClustering(const GraphC &g, unsigned int nthreads) : graph(g), nthreads(nthreads), threshold(0.5), max_iterations(10), passes(1)
+{
+    igraph_threads(nthreads);
+}
+
+/**
+ * @brief ConsensusClustering::set_threshold
+ * @param threshold minimum fraction of the repetitions that put the endpoints of an edge together for the edge
+ * to be kept in the consensus graph, in (0,1], default 0.5
+ */
+void ConsensusClustering::set_threshold(double threshold)
+{
+    if (!(threshold>0 && threshold<=1))
+        throw std::invalid_argument("Consensus threshold must be in (0,1]");
+    this->threshold = threshold;
+}
+
+/**
+ * @brief ConsensusClustering::set_max_iterations
+ * @param iterations maximum number of rounds of repetitions, default 10
+ */
+void ConsensusClustering::set_max_iterations(size_t iterations)
+{
+    this->max_iterations = std::max<size_t>(iterations,1);
+}
+
+/**
+ * @brief ConsensusClustering::set_passes
+ * @param passes optimizer passes of every repetition, see RepetitionRace::set_passes, default 1
+ */
+void ConsensusClustering::set_passes(size_t passes)
+{
+    this->passes = passes;
+}
+
+/**
+ * @brief ConsensusClustering::run Runs rounds of nrep repetitions until they agree
+ * @param qual any quality but Infomap
+ * @param method
+ * @param nrep repetitions of every round
+ * @param seed the rounds draw from seeds derived from it. Negative for a seed based on time
+ * @return the consensus partition
+ */
+ConsensusResult ConsensusClustering::run(QualityType qual, OptimizerType method, size_t nrep, int seed) const
+{
+    if (qual==QualityInfoMap)
+        throw std::logic_error("Infomap can't be used for consensus clustering");
+    if (nrep<1)
+        throw std::invalid_argument("Non valid number of repetitions");
+    if (seed<0)
+        seed = static_cast<int>(std::chrono::system_clock::now().time_since_epoch().count() & 0x7FFFFFFF);
+    const size_t n = graph.number_of_nodes();
+
+    ConsensusResult result;
+    result.iterations = 0;
+    result.converged = false;
+    std::unique_ptr<GraphC> consensus; // graph of the current round, the input graph at the first one
+    const GraphC *current = &graph;
+    while (result.iterations<max_iterations)
+    {
+        PACO_TRACE_SCOPE("consensus round");
+        RepetitionRace race(*current,nthreads);
+        race.set_margin(-1);
+        race.set_passes(passes);
+        CoAssignment co;
+        const size_t m = current->number_of_edges();
+        co.sources.resize(m);
+        co.targets.resize(m);
+        for (size_t e=0; e<m; ++e)
+        {
+            std::pair<igraph_integer_t,igraph_integer_t> ends = current->get_edge(e);
+            co.sources[e] = ends.first;
+            co.targets[e] = ends.second;
+        }
+        const unsigned int nt = race.number_of_threads(nrep);
+        co.counts.assign(nt,std::vector<uint32_t>(m,0));
+        co.repetitions.assign(nt,0);
+        race.set_repetition_callback(accumulate_coassignment,&co);
+        RaceResult round = race.run(qual,method,nrep,static_cast<int>((seed + 0x9E3779B9U*result.iterations) & 0x7FFFFFFF));
+        Membership previous;
+        previous.swap(result.membership);
+        result.membership = round.membership;
+        renumber_first_appearance(&result.membership);
+        ++result.iterations;
+
+        // Sum of the threads, then the edges kept for the next round
+        for (unsigned int t=1; t<nt; ++t)
+            for (size_t e=0; e<m; ++e)
+                co.counts[0][e] += co.counts[t][e];
+        size_t total = 0;
+        for (unsigned int t=0; t<nt; ++t)
+            total += co.repetitions[t];
+        std::vector<EdgeEdit> kept;
+        result.converged = true;
+        for (size_t e=0; e<m; ++e)
+        {
+            uint32_t c = co.counts[0][e];
+            result.converged = result.converged && (c==0 || c==total);
+            double fraction = static_cast<double>(c)/total;
+            if (fraction>=threshold)
+                kept.push_back(EdgeEdit(EdgeEdit::Insert,co.sources[e],co.targets[e],qual==QualitySurprise ? 1.0 : fraction));
+        }
+        // Stable when the best partition is the same of the previous round
+        result.converged = result.converged || result.membership==previous;
+        if (result.converged || kept.empty())
+            break;
+        std::unique_ptr<GraphC> next(new GraphC(n));
+        next->apply_edits(kept);
+        consensus.swap(next);
+        current = consensus.get();
+    }
+
+    // Quality of the consensus partition on the input graph
+    CommunityStructure comm(&graph);
+    comm.initialize(MembershipInitializer(result.membership));
+    result.quality = comm.quality(qual);
+    return result;
+}
@@ -0,0 +1,80 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+#ifndef _CONSENSUS_CLUSTERING_H_
+#define _CONSENSUS_CLUSTERING_H_
+
+#include "Graph.h"
+#include "Community.h"
+
+/**
+ * @brief Outcome of a ConsensusClustering
+ */
+struct ConsensusResult
+{
+    double quality;        // of the consensus partition on the input graph
+    Membership membership; // consensus partition, communities numbered in order of first appearance
+    size_t iterations;     // rounds of repetitions run
+    bool converged;        // true if the repetitions of the last round agreed on every edge, or on the previous partition
+};
+
+/**
+ * Consensus clustering, after Lancichinetti and Fortunato, Sci. Rep. 2, 336 (2012). The repetitions of
+ * a round are run in parallel by a RepetitionRace without racing, and for every edge of the graph the
+ * fraction of them that put its endpoints in the same community is accumulated, per thread. The edges
+ * with a fraction of at least threshold make the consensus graph of the next round, weighted by the
+ * fraction, or unweighted for the binary Surprise, so that the co-assignment matrix is kept on the support
+ * of the graph edges. The rounds stop when the repetitions agree on every edge, when the best partition of
+ * a round is the one of the previous round, or after max_iterations. The result is the best partition of
+ * the last round.
+ */
+class ConsensusClustering
+{
+public:
+    ConsensusClustering(const GraphC &g, unsigned int nthreads=0);
+    void set_threshold(double threshold);
+    void set_max_iterations(size_t iterations);
+    void set_passes(size_t passes);
+    ConsensusResult run(QualityType qual, OptimizerType method, size_t nrep, int seed=-1) const;
+
+private:
+    const GraphC &graph;
+    unsigned int nthreads;  // 0 for all the cores, see igraph_threads
+    double threshold;
+    size_t max_iterations;
+    size_t passes;          // optimizer passes of every repetition
+};
+
+#endif // _CONSENSUS_CLUSTERING_H_
@@ -58,16 +58,16 @@ void DegreeCorrectedSurpriseFunction::eval(const PartitionHelper *par) const
     igraph_real_t m = par->get_graph_total_weight();
     igraph_real_t p = par->get_graph_total_pairs();
 
-    for (CommMapCIter iter=par->get_communities().begin(); iter!=par->get_communities().end(); ++iter)
+    for (CommListCIter iter=par->get_communities().begin(); iter!=par->get_communities().end(); ++iter)
     {
-        size_t c = iter->first;
+        size_t c = *iter;
         igraph_real_t mc = par->get_incomm_weight().at(c);
         igraph_real_t Kc = par->get_incomm_deg().at(c);
         igraph_real_t nc = par->get_incomm_nvert().at(c);
         igraph_real_t pc = nc*(nc-1.0)/2.0;
-        for (CommMapCIter iter=par->get_communities().begin(); iter!=par->get_communities().end(); ++iter)
+        for (CommListCIter iter=par->get_communities().begin(); iter!=par->get_communities().end(); ++iter)
         {
-            size_t d = iter->first;
+            size_t d = *iter;
             igraph_real_t mcd = 0;//par->weight_to_from_community(par->get_i)
             igraph_real_t Kd = par->get_incomm_deg().at(d);
             quality *= logC(Kc*Kd,mcd)-logC(4*m*m,2*m);
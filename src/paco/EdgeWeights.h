@@ -0,0 +1,134 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+
+#ifndef _EDGE_WEIGHTS_H_
+#define _EDGE_WEIGHTS_H_
+
+#include <cstddef>
+#include <igraph.h>
+#include "igraph_utils.h"
+
+/**
+ * Read-only view over the edge weights of a graph, stored either in double precision as an
+ * igraph_vector_t or in single precision (see GraphC::set_float32_weights).
+ * Weights are always returned as double, so that every accumulation done by the callers
+ * (strengths, intracluster weights, incident weights) is carried on in double precision.
+ * An empty view stands for an unweighted graph, as a NULL igraph_vector_t pointer does.
+ *
+ * Rounding the weights to float32 introduces a relative error of at most 2^-24 (about 6E-8) on
+ * every weight. Since the weights are non negative and summed in double precision, every aggregate
+ * used by the quality functions has the same relative error bound, so that quality values agree with
+ * the double precision ones to about 7 significant digits. Near ties between moves may however be
+ * resolved differently, hence the optimizers can end in a different local optimum.
+ */
+class EdgeWeights
+{
+public:
+    EdgeWeights(const igraph_vector_t *w=NULL) : vec(w), w64(w ? w->stor_begin : NULL), w32(NULL), n(w ? igraph_vector_size(w) : 0)
+    {
+    }
+
+    /**
+     * @brief single_precision Makes a view over an array of float weights, that must outlive the view
+     * @param w
+     * @param num_edges
+     */
+    static EdgeWeights single_precision(const float *w, size_t num_edges)
+    {
+        EdgeWeights ew;
+        ew.w32 = w;
+        ew.n = w ? num_edges : 0;
+        return ew;
+    }
+
+    explicit operator bool() const
+    {
+        return w64!=NULL || w32!=NULL;
+    }
+
+    double operator[](size_t e) const
+    {
+        return w32 ? static_cast<double>(w32[e]) : w64[e];
+    }
+
+    size_t size() const
+    {
+        return n;
+    }
+
+    bool is_single_precision() const
+    {
+        return w32!=NULL;
+    }
+
+    /**
+     * @brief igraph_vector The double precision igraph vector viewed, NULL if unweighted or single precision
+     */
+    const igraph_vector_t *igraph_vector() const
+    {
+        return vec;
+    }
+
+    /**
+     * @brief sum Sum of all the weights, accumulated in double precision
+     */
+    double sum() const
+    {
+        double s = 0.0;
+        for (size_t e=0; e<n; ++e)
+            s += (*this)[e];
+        return s;
+    }
+
+    /**
+     * @brief copy_to Widens the weights into an initialized igraph vector, for the igraph routines that need them
+     * @param dst
+     */
+    void copy_to(igraph_vector_t *dst) const
+    {
+        IGRAPH_TRY(igraph_vector_resize(dst,n));
+        for (size_t e=0; e<n; ++e)
+            VECTOR(*dst)[e] = (*this)[e];
+    }
+
+private:
+    const igraph_vector_t *vec;
+    const igraph_real_t *w64;
+    const float *w32;
+    size_t n;
+};
+
+#endif // _EDGE_WEIGHTS_H_
@@ -0,0 +1,477 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <exception>
+#include <thread>
+
+#include "FastParser.h"
+#include "MemoryMappedFile.h"
+
+/**
+ * @brief split_at_newlines
+ * @param begin
+ * @param end
+ * @param nchunks
+ * @return
+ */
+std::vector<const char*> split_at_newlines(const char *begin, const char *end, size_t nchunks)
+{
+    std::vector<const char*> bounds;
+    bounds.push_back(begin);
+    if (nchunks<1)
+        nchunks = 1;
+    size_t len = end-begin;
+    for (size_t k=1; k<nchunks; ++k)
+    {
+        const char *p = begin + (len*k)/nchunks;
+        if (p < bounds.back())
+            p = bounds.back();
+        const char *nl = static_cast<const char*>(memchr(p,'\n',end-p));
+        if (nl==NULL)
+            break;
+        if (nl+1 > bounds.back() && nl+1 < end)
+            bounds.push_back(nl+1);
+    }
+    bounds.push_back(end);
+    return bounds;
+}
+
+/**
+ * @brief parsing_threads
+ * @param nbytes
+ * @param nthreads
+ * @return
+ */
+unsigned int parsing_threads(size_t nbytes, unsigned int nthreads)
+{
+    if (nthreads==0)
+        nthreads = std::thread::hardware_concurrency();
+    if (nthreads==0)
+        nthreads = 1;
+    size_t max_threads = std::max<size_t>(1,nbytes/(1<<20));
+    return static_cast<unsigned int>(std::min<size_t>(nthreads,max_threads));
+}
+
+/**
+ * @brief parse_error Throw a parsing error reporting the line where it happened
+ * @param begin
+ * @param pos
+ * @param what
+ */
+static void parse_error(const char *begin, const char *pos, const char *what)
+{
+    std::stringstream ss;
+    ss << "Parsing failed at line " << std::count(begin,pos,'\n')+1 << ": " << what;
+    throw std::runtime_error(ss.str());
+}
+
+/**
+ * @brief run_on_chunks Run job(k) for k=0..nchunks-1, each on its own thread, and wait for all of them.
+ * If any job throws, the exception of the first failing chunk is rethrown, that is the first error in the file.
+ * @param nchunks
+ * @param job
+ */
+template <class Job>
+static void run_on_chunks(size_t nchunks, const Job &job)
+{
+    if (nchunks==1)
+    {
+        job(0);
+        return;
+    }
+    std::vector<std::exception_ptr> errors(nchunks);
+    std::vector<std::thread> workers;
+    for (size_t k=0; k<nchunks; ++k)
+    {
+        workers.push_back(std::thread([&,k]()
+        {
+            try
+            {
+                job(k);
+            }
+            catch (...)
+            {
+                errors[k] = std::current_exception();
+            }
+        }));
+    }
+    for (size_t k=0; k<nchunks; ++k)
+        workers[k].join();
+    for (size_t k=0; k<nchunks; ++k)
+    {
+        if (errors[k])
+            std::rethrow_exception(errors[k]);
+    }
+}
+
+/**
+ * @brief parse_edge_list_chunk Parse the lines in [begin,end) appending to edges and weights
+ * @param file_begin start of the whole text, only used to report the line number
+ * @param begin
+ * @param end
+ * @param weighted
+ * @param edges
+ * @param weights
+ */
+static void parse_edge_list_chunk(const char *file_begin, const char *begin, const char *end, bool weighted, std::vector<igraph_real_t> &edges, std::vector<igraph_real_t> &weights)
+{
+    // Rough estimate of the number of lines to limit reallocations
+    size_t estimated_lines = (end-begin)/(weighted ? 16 : 10) + 1;
+    edges.reserve(2*estimated_lines);
+    if (weighted)
+        weights.reserve(estimated_lines);
+
+    const char *p = begin;
+    while (p<end)
+    {
+        p = skip_blanks(p,end);
+        if (p==end)
+            break;
+        if (*p=='\n') // empty line
+        {
+            ++p;
+            continue;
+        }
+        long int from, to;
+        const char *q = parse_uint(p,end,&from);
+        if (q==NULL)
+            parse_error(file_begin,p,"invalid source vertex");
+        p = skip_blanks(q,end);
+        q = parse_uint(p,end,&to);
+        if (q==NULL)
+            parse_error(file_begin,p,"invalid target vertex");
+        p = skip_blanks(q,end);
+        if (weighted)
+        {
+            double w;
+            q = parse_real(p,end,&w);
+            if (q==NULL)
+                parse_error(file_begin,p,"invalid weight");
+            p = skip_blanks(q,end);
+            weights.push_back(w);
+        }
+        if (p<end && *p!='\n')
+            parse_error(file_begin,p,"unexpected characters at end of line");
+        edges.push_back(from);
+        edges.push_back(to);
+    }
+}
+
+/**
+ * @brief parse_edge_list
+ * @param begin
+ * @param end
+ * @param weighted
+ * @param edges
+ * @param weights
+ * @param nthreads
+ */
+void parse_edge_list(const char *begin, const char *end, bool weighted, std::vector<igraph_real_t> &edges, std::vector<igraph_real_t> &weights, unsigned int nthreads)
+{
+    edges.clear();
+    if (weighted)
+        weights.clear();
+    if (begin==NULL || begin==end)
+        return;
+
+    nthreads = parsing_threads(end-begin,nthreads);
+    if (nthreads==1)
+    {
+        parse_edge_list_chunk(begin,begin,end,weighted,edges,weights);
+        return;
+    }
+
+    std::vector<const char*> bounds = split_at_newlines(begin,end,nthreads);
+    size_t nchunks = bounds.size()-1;
+    std::vector< std::vector<igraph_real_t> > chunk_edges(nchunks), chunk_weights(nchunks);
+    run_on_chunks(nchunks,[&](size_t k)
+    {
+        parse_edge_list_chunk(begin,bounds[k],bounds[k+1],weighted,chunk_edges[k],chunk_weights[k]);
+    });
+
+    // Concatenate the chunks in file order, copying them in parallel at their final offset
+    std::vector<size_t> offsets(nchunks+1,0);
+    for (size_t k=0; k<nchunks; ++k)
+        offsets[k+1] = offsets[k] + chunk_edges[k].size()/2;
+    edges.resize(2*offsets[nchunks]);
+    if (weighted)
+        weights.resize(offsets[nchunks]);
+    run_on_chunks(nchunks,[&](size_t k)
+    {
+        std::copy(chunk_edges[k].begin(),chunk_edges[k].end(),edges.begin()+2*offsets[k]);
+        std::vector<igraph_real_t>().swap(chunk_edges[k]);
+        if (weighted)
+        {
+            std::copy(chunk_weights[k].begin(),chunk_weights[k].end(),weights.begin()+offsets[k]);
+            std::vector<igraph_real_t>().swap(chunk_weights[k]);
+        }
+    });
+}
+
+/**
+ * @brief read_edge_list_file
+ * @param filename
+ * @param weighted
+ * @param edges
+ * @param weights
+ * @param nthreads
+ */
+void read_edge_list_file(const std::string &filename, bool weighted, std::vector<igraph_real_t> &edges, std::vector<igraph_real_t> &weights, unsigned int nthreads)
+{
+    MemoryMappedFile file;
+    if (!file.open(filename))
+        throw std::ios_base::failure("Error, file " + filename + " doesn't exist");
+    parse_edge_list(file.data(),file.data()+file.size(),weighted,edges,weights,nthreads);
+}
+
+/**
+ * @brief skip_token Skip a blank separated token without converting it
+ * @param p
+ * @param end
+ * @return the position just after the token
+ */
+static inline const char* skip_token(const char *p, const char *end)
+{
+    while (p<end && !is_blank(*p) && *p!='\n')
+        ++p;
+    return p;
+}
+
+/**
+ * @brief count_matrix_rows Count the non empty lines in [begin,end)
+ * @param begin
+ * @param end
+ * @return
+ */
+static size_t count_matrix_rows(const char *begin, const char *end)
+{
+    size_t rows = 0;
+    const char *p = begin;
+    while (p<end)
+    {
+        p = skip_blanks(p,end);
+        if (p==end)
+            break;
+        if (*p!='\n')
+            ++rows;
+        const char *nl = static_cast<const char*>(memchr(p,'\n',end-p));
+        p = (nl==NULL) ? end : nl+1;
+    }
+    return rows;
+}
+
+/**
+ * @brief The AdjMatrixChunk struct keeps what is known about a block of rows of the matrix
+ */
+struct AdjMatrixChunk
+{
+    AdjMatrixChunk() : first_row(0), nnz(0), first_weight(0), uniform_weights(true) {}
+    size_t first_row;
+    size_t nnz;
+    double first_weight;
+    bool uniform_weights;
+};
+
+/**
+ * @brief parse_adj_matrix_rows Parse the rows of a n x n matrix in [begin,end), the first being chunk.first_row.
+ * If edges is NULL every entry is parsed and validated and the nonzero upper triangular entries are counted in chunk.nnz.
+ * Otherwise only the upper triangular entries are converted and the nonzero ones are written as edges (i,j) with i<j
+ * and weights starting from edges and weights, the lower triangle is skipped without conversion.
+ * @param file_begin start of the whole text, only used to report the line number
+ * @param begin
+ * @param end
+ * @param n
+ * @param edges
+ * @param weights
+ * @param chunk
+ */
+static void parse_adj_matrix_rows(const char *file_begin, const char *begin, const char *end, size_t n, igraph_real_t *edges, igraph_real_t *weights, AdjMatrixChunk &chunk)
+{
+    const bool validate = (edges==NULL);
+    size_t i = chunk.first_row;
+    size_t nnz = 0;
+    const char *p = begin;
+    while (p<end)
+    {
+        p = skip_blanks(p,end);
+        if (p==end)
+            break;
+        if (*p=='\n') // empty line
+        {
+            ++p;
+            continue;
+        }
+        for (size_t j=0; j<n; ++j)
+        {
+            if (p==end || *p=='\n')
+                parse_error(file_begin,p,"row shorter than the first one, non square adjacency matrix");
+            if (!validate && j<=i)
+            {
+                p = skip_blanks(skip_token(p,end),end);
+                continue;
+            }
+            double w;
+            const char *q = parse_real(p,end,&w);
+            if (q==NULL || (q<end && !is_blank(*q) && *q!='\n'))
+                parse_error(file_begin,p,"invalid matrix entry");
+            if (j==i && w!=0)
+                parse_error(file_begin,p,"adjacency matrix has self-loops, only simple graphs allowed");
+            if (j>i && w!=0)
+            {
+                if (w<0)
+                    parse_error(file_begin,p,"negative edge weight found, only positive weights supported");
+                if (validate)
+                {
+                    if (nnz==0)
+                        chunk.first_weight = w;
+                    else if (w!=chunk.first_weight)
+                        chunk.uniform_weights = false;
+                }
+                else
+                {
+                    edges[2*nnz] = i;
+                    edges[2*nnz+1] = j;
+                    weights[nnz] = w;
+                }
+                ++nnz;
+            }
+            p = skip_blanks(q,end);
+        }
+        if (p<end && *p!='\n')
+            parse_error(file_begin,p,"row longer than the first one, non square adjacency matrix");
+        ++i;
+    }
+    chunk.nnz = nnz;
+}
+
+/**
+ * @brief parse_adj_matrix
+ * @param begin
+ * @param end
+ * @param edges
+ * @param weights
+ * @param num_vertices
+ * @param is_weighted
+ * @param nthreads
+ */
+void parse_adj_matrix(const char *begin, const char *end, std::vector<igraph_real_t> &edges, std::vector<igraph_real_t> &weights, igraph_integer_t *num_vertices, bool *is_weighted, unsigned int nthreads)
+{
+    edges.clear();
+    weights.clear();
+    *num_vertices = 0;
+    *is_weighted = false;
+
+    // The number of entries in the first row sets the matrix size
+    const char *p = begin;
+    while (p<end && (is_blank(*p) || *p=='\n'))
+        ++p;
+    size_t n = 0;
+    while (p<end && *p!='\n')
+    {
+        p = skip_blanks(skip_token(p,end),end);
+        ++n;
+    }
+    if (n==0)
+        return;
+    if (n > static_cast<size_t>(INT_MAX))
+        throw std::runtime_error("Adjacency matrix too large");
+
+    nthreads = parsing_threads(end-begin,nthreads);
+    std::vector<const char*> bounds = split_at_newlines(begin,end,nthreads);
+    size_t nchunks = bounds.size()-1;
+    std::vector<AdjMatrixChunk> chunks(nchunks);
+
+    // First pass: count the rows of every block, to know the index of its first row
+    std::vector<size_t> rows(nchunks);
+    run_on_chunks(nchunks,[&](size_t k)
+    {
+        rows[k] = count_matrix_rows(bounds[k],bounds[k+1]);
+    });
+    for (size_t k=1; k<nchunks; ++k)
+        chunks[k].first_row = chunks[k-1].first_row + rows[k-1];
+    if (chunks[nchunks-1].first_row + rows[nchunks-1] != n)
+        throw std::runtime_error("Non square adjacency matrix");
+
+    // Second pass: validate and count the edges, so that the output is allocated once with its final size
+    run_on_chunks(nchunks,[&](size_t k)
+    {
+        parse_adj_matrix_rows(begin,bounds[k],bounds[k+1],n,NULL,NULL,chunks[k]);
+    });
+    std::vector<size_t> offsets(nchunks+1,0);
+    bool uniform = true;
+    double first_weight = 0;
+    for (size_t k=0; k<nchunks; ++k)
+    {
+        offsets[k+1] = offsets[k] + chunks[k].nnz;
+        if (chunks[k].nnz==0)
+            continue;
+        if (offsets[k]==0)
+            first_weight = chunks[k].first_weight;
+        uniform = uniform && chunks[k].uniform_weights && chunks[k].first_weight==first_weight;
+    }
+
+    // Third pass: write the upper triangular nonzero entries straight to their final position
+    edges.resize(2*offsets[nchunks]);
+    weights.resize(offsets[nchunks]);
+    run_on_chunks(nchunks,[&](size_t k)
+    {
+        parse_adj_matrix_rows(begin,bounds[k],bounds[k+1],n,edges.data()+2*offsets[k],weights.data()+offsets[k],chunks[k]);
+    });
+
+    *num_vertices = static_cast<igraph_integer_t>(n);
+    *is_weighted = !uniform;
+}
+
+/**
+ * @brief read_adj_matrix_file
+ * @param filename
+ * @param edges
+ * @param weights
+ * @param num_vertices
+ * @param is_weighted
+ * @param nthreads
+ */
+void read_adj_matrix_file(const std::string &filename, std::vector<igraph_real_t> &edges, std::vector<igraph_real_t> &weights, igraph_integer_t *num_vertices, bool *is_weighted, unsigned int nthreads)
+{
+    MemoryMappedFile file;
+    if (!file.open(filename))
+        throw std::ios_base::failure("Error, file " + filename + " doesn't exist");
+    parse_adj_matrix(file.data(),file.data()+file.size(),edges,weights,num_vertices,is_weighted,nthreads);
+}
@@ -0,0 +1,261 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+
+#ifndef _FAST_PARSER_H_
+#define _FAST_PARSER_H_
+
+#include <vector>
+#include <string>
+#include <cmath>
+#include <climits>
+#include <igraph.h>
+
+/**
+ * Hand-written number parsers working directly on a [p,end) character range, typically a
+ * memory mapped file. They never read past end, so the range doesn't need to be zero-terminated.
+ * Every parser returns the position after the parsed token or NULL if no valid token is found.
+ */
+
+/**
+ * @brief is_blank
+ * @param c
+ * @return true for spaces, tabs and carriage returns. Newlines are handled separately.
+ */
+inline bool is_blank(char c)
+{
+    return c==' ' || c=='\t' || c=='\r';
+}
+
+/**
+ * @brief skip_blanks
+ * @param p
+ * @param end
+ * @return the first non blank character position
+ */
+inline const char* skip_blanks(const char *p, const char *end)
+{
+    while (p<end && is_blank(*p))
+        ++p;
+    return p;
+}
+
+/**
+ * @brief parse_uint Parse a non negative integer that fits in an igraph_integer_t
+ * @param p
+ * @param end
+ * @param value
+ * @return
+ */
+inline const char* parse_uint(const char *p, const char *end, long int *value)
+{
+    const char *start = p;
+    long int v = 0;
+    while (p<end && *p>='0' && *p<='9')
+    {
+        v = v*10 + (*p-'0');
+        if (v > INT_MAX)
+            return NULL;
+        ++p;
+    }
+    if (p==start)
+        return NULL;
+    *value = v;
+    return p;
+}
+
+/**
+ * @brief pow10_exact
+ * @param e
+ * @return 10^e, exactly representable in a double for 0<=e<=22
+ */
+inline double pow10_exact(int e)
+{
+    static const double table[] = {1E0, 1E1, 1E2, 1E3, 1E4, 1E5, 1E6, 1E7, 1E8, 1E9, 1E10, 1E11,
+                                   1E12, 1E13, 1E14, 1E15, 1E16, 1E17, 1E18, 1E19, 1E20, 1E21, 1E22};
+    if (e>=0 && e<=22)
+        return table[e];
+    return std::pow(10.0,e);
+}
+
+/**
+ * @brief parse_real Parse a floating point number in fixed or scientific notation.
+ * The first 19 significant digits are accumulated in an integer mantissa which is then scaled
+ * by a power of ten, so the result is within one ulp of what strtod would return.
+ * @param p
+ * @param end
+ * @param value
+ * @return
+ */
+inline const char* parse_real(const char *p, const char *end, double *value)
+{
+    bool negative = false;
+    if (p<end && (*p=='-' || *p=='+'))
+    {
+        negative = (*p=='-');
+        ++p;
+    }
+    unsigned long long mantissa = 0;
+    int ndigits = 0;
+    int exponent = 0;
+    bool any_digit = false;
+    while (p<end && *p>='0' && *p<='9')
+    {
+        if (ndigits<19)
+        {
+            mantissa = mantissa*10 + (*p-'0');
+            ndigits += (mantissa!=0);
+        }
+        else
+            ++exponent;
+        any_digit = true;
+        ++p;
+    }
+    if (p<end && *p=='.')
+    {
+        ++p;
+        while (p<end && *p>='0' && *p<='9')
+        {
+            if (ndigits<19)
+            {
+                mantissa = mantissa*10 + (*p-'0');
+                ndigits += (mantissa!=0);
+                --exponent;
+            }
+            any_digit = true;
+            ++p;
+        }
+    }
+    if (!any_digit)
+        return NULL;
+    if (p<end && (*p=='e' || *p=='E'))
+    {
+        ++p;
+        bool negative_exp = false;
+        if (p<end && (*p=='-' || *p=='+'))
+        {
+            negative_exp = (*p=='-');
+            ++p;
+        }
+        if (p==end || *p<'0' || *p>'9')
+            return NULL;
+        int e = 0;
+        while (p<end && *p>='0' && *p<='9')
+        {
+            if (e<10000)
+                e = e*10 + (*p-'0');
+            ++p;
+        }
+        exponent += negative_exp ? -e : e;
+    }
+    double v = static_cast<double>(mantissa);
+    if (exponent<0)
+        v /= pow10_exact(-exponent);
+    else if (exponent>0)
+        v *= pow10_exact(exponent);
+    *value = negative ? -v : v;
+    return p;
+}
+
+/**
+ * @brief split_at_newlines Split the range [begin,end) in at most nchunks contiguous chunks
+ * whose boundaries fall just after a newline, so that no line is shared between two chunks.
+ * @param begin
+ * @param end
+ * @param nchunks
+ * @return the nchunks+1 (or less) chunk boundaries, first is begin and last is end
+ */
+std::vector<const char*> split_at_newlines(const char *begin, const char *end, size_t nchunks);
+
+/**
+ * @brief parsing_threads Number of threads to use for parsing a buffer of nbytes bytes.
+ * Small buffers are parsed by a single thread, every thread gets at least 1MB of text.
+ * @param nbytes
+ * @param nthreads requested number of threads, 0 means hardware concurrency
+ * @return
+ */
+unsigned int parsing_threads(size_t nbytes, unsigned int nthreads=0);
+
+/**
+ * @brief parse_edge_list Parse a text edges list, one edge per line in the form "from to" or
+ * "from to weight" if weighted. The text is split at line boundaries over nthreads threads
+ * and the results are written in file order.
+ * @param begin
+ * @param end
+ * @param weighted
+ * @param edges on output the 2*m endpoints of the edges, ready to be viewed by igraph_create
+ * @param weights on output the m edge weights, untouched if weighted is false
+ * @param nthreads 0 means hardware concurrency
+ */
+void parse_edge_list(const char *begin, const char *end, bool weighted, std::vector<igraph_real_t> &edges, std::vector<igraph_real_t> &weights, unsigned int nthreads=0);
+
+/**
+ * @brief read_edge_list_file Memory map the file and parse it with parse_edge_list
+ * @param filename
+ * @param weighted
+ * @param edges
+ * @param weights
+ * @param nthreads
+ */
+void read_edge_list_file(const std::string &filename, bool weighted, std::vector<igraph_real_t> &edges, std::vector<igraph_real_t> &weights, unsigned int nthreads=0);
+
+/**
+ * @brief parse_adj_matrix Parse a dense text adjacency matrix, one row per line with blank separated entries.
+ * The size n is given by the number of entries in the first row. Only the upper triangle is converted, the matrix
+ * is assumed symmetric: every nonzero entry (i,j) with i<j becomes an undirected edge, in row major order.
+ * The rows are streamed in parallel blocks without materializing the dense matrix, the output is allocated once.
+ * Diagonal nonzero entries, negative weights and non square matrices throw a std::runtime_error.
+ * @param begin
+ * @param end
+ * @param edges on output the 2*m endpoints of the edges, ready to be viewed by igraph_create
+ * @param weights on output the m edge weights
+ * @param num_vertices on output the matrix size n
+ * @param is_weighted on output false if all the edges have the same weight
+ * @param nthreads 0 means hardware concurrency
+ */
+void parse_adj_matrix(const char *begin, const char *end, std::vector<igraph_real_t> &edges, std::vector<igraph_real_t> &weights, igraph_integer_t *num_vertices, bool *is_weighted, unsigned int nthreads=0);
+
+/**
+ * @brief read_adj_matrix_file Memory map the file and parse it with parse_adj_matrix
+ * @param filename
+ * @param edges
+ * @param weights
+ * @param num_vertices
+ * @param is_weighted
+ * @param nthreads
+ */
+void read_adj_matrix_file(const std::string &filename, std::vector<igraph_real_t> &edges, std::vector<igraph_real_t> &weights, igraph_integer_t *num_vertices, bool *is_weighted, unsigned int nthreads=0);
+
+#endif
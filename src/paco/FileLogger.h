@@ -40,49 +40,108 @@
 
 #include <sstream>
 #include <string>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <memory>
+#include <algorithm>
 #include <stdio.h>
+#include <stdint.h>
 
 inline std::string NowTime();
 
 enum TLogLevel {logERROR=0, logWARNING=1, logINFO=2, logDEBUG=3, logDEBUG1=4, logDEBUG2=5, logDEBUG3=6, logDEBUG4=7};
 
+/**
+ * @brief The LogBuffer class is a stream buffer appending to a string, which keeps its capacity between messages
+ */
+class LogBuffer : public std::streambuf
+{
+public:
+    std::string text;
+protected:
+    int_type overflow(int_type c)
+    {
+        if (!traits_type::eq_int_type(c,traits_type::eof()))
+            text.push_back(traits_type::to_char_type(c));
+        return traits_type::not_eof(c);
+    }
+    std::streamsize xsputn(const char *s, std::streamsize n)
+    {
+        text.append(s,static_cast<size_t>(n));
+        return n;
+    }
+};
+
+/**
+ * Stream of the messages of a thread, formatted in place without allocations once its buffer has grown.
+ * The messages of a thread can't be nested, that is a message can't be logged while another one is formatted.
+ */
+struct LogStream
+{
+    LogBuffer buffer;
+    std::ostream os;
+    LogStream() : os(&buffer) {}
+};
+
+inline LogStream& ThreadLogStream()
+{
+    static thread_local LogStream stream;
+    return stream;
+}
+
 template <typename T>
 class Log
 {
 public:
     Log();
     virtual ~Log();
-    std::ostringstream& Get(TLogLevel level = logINFO);
+    std::ostream& Get(TLogLevel level = logINFO);
 public:
     static TLogLevel& ReportingLevel();
-    static std::string ToString(TLogLevel level);
+    static const char* ToString(TLogLevel level);
     static TLogLevel FromString(const std::string& level);
-protected:
-    std::ostringstream os;
 private:
+    TLogLevel messageLevel;
     Log(const Log&);
     Log& operator =(const Log&);
 };
 
 template <typename T>
-Log<T>::Log()
+Log<T>::Log() : messageLevel(logINFO)
 {
 }
 
 template <typename T>
-std::ostringstream& Log<T>::Get(TLogLevel level)
+std::ostream& Log<T>::Get(TLogLevel level)
 {
+    messageLevel = level;
+    LogStream &stream = ThreadLogStream();
+    stream.buffer.text.clear();
+    // Formatting flags set by the previous message are reset
+    stream.os.flags(std::ios_base::dec | std::ios_base::skipws);
+    stream.os.precision(6);
+    stream.os.fill(' ');
     //os << "- " << NowTime();
-    os << "[" << ToString(level) << "] ";
-    os << std::string(level > logDEBUG ? level - logDEBUG : 0, '\t');
-    return os;
+    stream.os << "[" << ToString(level) << "] ";
+    if (level > logDEBUG)
+        stream.buffer.text.append(level - logDEBUG, '\t');
+    return stream.os;
 }
 
 template <typename T>
 Log<T>::~Log()
 {
-    os << std::endl;
-    T::Output(os.str());
+    LogStream &stream = ThreadLogStream();
+    stream.buffer.text.push_back('\n');
+    // Errors are written before returning, often the process is about to stop. Flush gives up if the writer is gone
+    if (messageLevel == logERROR)
+    {
+        T::Flush();
+        T::Write(stream.buffer.text);
+    }
+    else
+        T::Output(stream.buffer.text);
 }
 
 template <typename T>
@@ -93,7 +152,7 @@ TLogLevel& Log<T>::ReportingLevel()
 }
 
 template <typename T>
-std::string Log<T>::ToString(TLogLevel level)
+const char* Log<T>::ToString(TLogLevel level)
 {
     static const char* const buffer[] = {"ERROR", "WARNING", "INFO", "DEBUG", "DEBUG1", "DEBUG2", "DEBUG3", "DEBUG4"};
     return buffer[level];
@@ -122,11 +181,47 @@ TLogLevel Log<T>::FromString(const std::string& level)
     return logINFO;
 }
 
+/**
+ * @brief The AsyncLogWriter class writes the messages of all the threads from a background thread.
+ * Messages go through a bounded lock-free queue (D. Vyukov's bounded MPMC queue, with a single consumer).
+ * The strings of the message and of the slot are swapped, so that their buffers circulate between the
+ * producers and the writer without allocations. The writer flushes the stream only when the queue is empty.
+ * Remaining messages are written at exit.
+ */
+class AsyncLogWriter
+{
+public:
+    static AsyncLogWriter& Instance();
+    static bool& Alive();
+    bool Push(std::string &msg);
+    bool Flush();
+    ~AsyncLogWriter();
+private:
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        std::string text;
+    };
+    static const size_t capacity = 4096;
+    AsyncLogWriter();
+    void Run();
+    bool WriteNext();
+
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<size_t> enqueue_pos;
+    std::atomic<size_t> dequeue_pos; // only the writer advances it
+    std::atomic<size_t> flushed_pos; // messages written and flushed
+    std::atomic<bool> stopping;
+    std::thread writer;
+};
+
 class Output2FILE
 {
 public:
     static FILE*& Stream();
-    static void Output(const std::string& msg);
+    static void Output(std::string& msg);
+    static void Write(const std::string& msg);
+    static void Flush();
 };
 
 inline FILE*& Output2FILE::Stream()
@@ -135,15 +230,177 @@ inline FILE*& Output2FILE::Stream()
     return pStream;
 }
 
-inline void Output2FILE::Output(const std::string& msg)
+/**
+ * @brief Output2FILE::Output Hands the message to the writer thread. msg gets a recycled buffer in exchange.
+ * Messages are written directly when the queue stays full or at exit, after the writer has stopped.
+ */
+inline void Output2FILE::Output(std::string& msg)
+{
+    if (!AsyncLogWriter::Alive() || !AsyncLogWriter::Instance().Push(msg))
+        Write(msg);
+}
+
+/**
+ * @brief Output2FILE::Write Writes the message to the stream from the calling thread
+ */
+inline void Output2FILE::Write(const std::string& msg)
 {
     FILE* pStream = Stream();
     if (!pStream)
         return;
-    fprintf(pStream, "%s", msg.c_str());
+    fwrite(msg.data(), 1, msg.size(), pStream);
     fflush(pStream);
 }
 
+/**
+ * @brief Output2FILE::Flush Waits until the messages logged so far are written, for example before changing Stream().
+ * Gives up when the writer makes no progress for a second, the next messages are then written directly.
+ */
+inline void Output2FILE::Flush()
+{
+    if (AsyncLogWriter::Alive())
+        AsyncLogWriter::Instance().Flush();
+}
+
+inline AsyncLogWriter& AsyncLogWriter::Instance()
+{
+    static AsyncLogWriter instance;
+    return instance;
+}
+
+/**
+ * @brief AsyncLogWriter::Alive
+ * @return false once the writer has been destroyed at exit
+ */
+inline bool& AsyncLogWriter::Alive()
+{
+    static bool alive = true;
+    return alive;
+}
+
+inline AsyncLogWriter::AsyncLogWriter() : slots(new Slot[capacity]), enqueue_pos(0), dequeue_pos(0), flushed_pos(0), stopping(false)
+{
+    for (size_t i=0; i<capacity; ++i)
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    writer = std::thread(&AsyncLogWriter::Run, this);
+}
+
+inline AsyncLogWriter::~AsyncLogWriter()
+{
+    // Later messages are written directly
+    Alive() = false;
+    stopping.store(true, std::memory_order_release);
+    writer.join();
+    while (WriteNext())
+        ;
+    if (Output2FILE::Stream())
+        fflush(Output2FILE::Stream());
+}
+
+/**
+ * @brief AsyncLogWriter::Push Enqueues msg, waiting for the writer if the queue is full
+ * @param msg swapped with the buffer of a written message
+ * @return false if the queue is still full after a second, as in a forked process without the writer thread
+ */
+inline bool AsyncLogWriter::Push(std::string &msg)
+{
+    std::chrono::steady_clock::time_point deadline;
+    for (bool waiting=false; ; )
+    {
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        Slot &slot = slots[pos & (capacity-1)];
+        intptr_t dif = static_cast<intptr_t>(slot.sequence.load(std::memory_order_acquire)) - static_cast<intptr_t>(pos);
+        if (dif == 0)
+        {
+            if (enqueue_pos.compare_exchange_weak(pos, pos+1, std::memory_order_relaxed))
+            {
+                slot.text.swap(msg);
+                slot.sequence.store(pos+1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (dif < 0) // full, the writer is behind
+        {
+            if (!waiting)
+            {
+                waiting = true;
+                deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+            }
+            else if (std::chrono::steady_clock::now() > deadline)
+                return false;
+            std::this_thread::yield();
+        }
+    }
+}
+
+/**
+ * @brief AsyncLogWriter::WriteNext Writes the oldest message if it has been published
+ * @return false if the queue is empty
+ */
+inline bool AsyncLogWriter::WriteNext()
+{
+    size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+    Slot &slot = slots[pos & (capacity-1)];
+    if (slot.sequence.load(std::memory_order_acquire) != pos+1)
+        return false;
+    FILE* pStream = Output2FILE::Stream();
+    if (pStream)
+        fwrite(slot.text.data(), 1, slot.text.size(), pStream);
+    slot.text.clear();
+    slot.sequence.store(pos+capacity, std::memory_order_release);
+    dequeue_pos.store(pos+1, std::memory_order_release);
+    return true;
+}
+
+inline void AsyncLogWriter::Run()
+{
+    int idle_ms = 1; // polling interval, longer while nothing is logged
+    while (true)
+    {
+        bool written = false;
+        while (WriteNext())
+            written = true;
+        if (written)
+        {
+            if (Output2FILE::Stream())
+                fflush(Output2FILE::Stream());
+            flushed_pos.store(dequeue_pos.load(std::memory_order_relaxed), std::memory_order_release);
+            idle_ms = 1;
+        }
+        else if (stopping.load(std::memory_order_acquire))
+            break;
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(idle_ms));
+            idle_ms = std::min(2*idle_ms, 16);
+        }
+    }
+}
+
+/**
+ * @brief AsyncLogWriter::Flush Waits until the messages enqueued so far are written and flushed
+ * @return false if the writer made no progress for a second, as in a forked process without the writer thread
+ */
+inline bool AsyncLogWriter::Flush()
+{
+    const size_t target = enqueue_pos.load(std::memory_order_acquire);
+    size_t flushed = flushed_pos.load(std::memory_order_acquire);
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (flushed < target)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        size_t now_flushed = flushed_pos.load(std::memory_order_acquire);
+        if (now_flushed != flushed)
+        {
+            flushed = now_flushed;
+            deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        }
+        else if (std::chrono::steady_clock::now() > deadline)
+            return false;
+    }
+    return true;
+}
+
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
 #   if defined (BUILDING_FILELOG_DLL)
 #       define FILELOG_DECLSPEC   __declspec (dllexport)
@@ -163,9 +420,10 @@ class FILELOG_DECLSPEC FILELog : public Log<Output2FILE> {};
 #define FILELOG_MAX_LEVEL logDEBUG4
 #endif
 
+// The level is compared first, so that disabled levels cost a single branch and no formatting
 #define FILE_LOG(level) \
     if (level > FILELOG_MAX_LEVEL) ;\
-    else if (level > FILELog::ReportingLevel() || !Output2FILE::Stream()) ; \
+    else if (level > FILELog::ReportingLevel()) ; \
     else FILELog().Get(level)
 
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
@@ -35,8 +35,13 @@
 
 
 #include <sstream>
+#include <climits>
+#include <algorithm>
 #include "Graph.h"
+#include "FastParser.h"
+#include "BinaryGraph.h"
 #include "FileLogger.h"
+#include "Trace.h"
 /**
  * @brief GraphC::GraphC
  */
@@ -65,13 +70,25 @@ GraphC::GraphC(const GraphC &rhs)
 
     // Copy edge weights
     this->edge_weights_stl = rhs.edge_weights_stl;
+    this->edge_weights_stl32 = rhs.edge_weights_stl32;
+    this->_float32_weights = rhs._float32_weights;
     // Copy vertices strenghts
     this->vertices_strenghts_stl = rhs.vertices_strenghts_stl;
     // Copy vertices degrees
     this->vertices_degrees_stl = rhs.vertices_degrees_stl;
 
-    // Set the edge weights vector as a view on underlying STL structure
-    igraph_vector_view(&edge_weights,edge_weights_stl.data(),edge_weights_stl.size());
+    // Share the memory mapped binary file, if any
+    this->binary_graph = rhs.binary_graph;
+
+    // Set the edge weights vector as a view on underlying STL structure, or on the mapped file if weights are viewed in place
+    if (binary_graph && edge_weights_stl.empty())
+        igraph_vector_view(&edge_weights,rhs.edge_weights.stor_begin,igraph_vector_size(&rhs.edge_weights));
+    else
+        igraph_vector_view(&edge_weights,edge_weights_stl.data(),edge_weights_stl.size());
+    if (binary_graph && edge_weights_stl32.empty())
+        this->edge_weights32 = rhs.edge_weights32;
+    else
+        this->edge_weights32 = edge_weights_stl32.empty() ? NULL : edge_weights_stl32.data();
 }
 
 /**
@@ -97,6 +114,7 @@ GraphC::GraphC(size_t nvertices)
     IGRAPH_TRY(igraph_empty(&this->ig,nvertices,IGRAPH_UNDIRECTED));
     _is_directed = false;
     _is_weighted = false;
+    _has_selfloops = false;
     _must_delete = true;
 }
 
@@ -138,21 +156,44 @@ GraphC::GraphC(const double *edges_list, const double *edges_weights, int nedges
  */
 void GraphC::init(const double *ewlist, int _weighted, int num_edges)
 {
-    vector<double> elist,wlist;
-    int iplus = (_weighted? 3 : 2);
-    for (int i=0; i<iplus*num_edges; i+=iplus)
-    {
-        elist.push_back(ewlist[i]);
-        elist.push_back(ewlist[i+1]);
-    }
-    for (int i=0; i<iplus*num_edges; i+=iplus)
+    this->init_edges(ewlist,num_edges,_weighted!=0);
+}
+
+/**
+ * @brief GraphC::init_edges Build an undirected graph from a row major edges list with num_edges rows
+ * "from to" if unweighted or "from to weight" if weighted, as a numpy array of any integer or floating point type.
+ * Every row is an edge. The list is read in its own type and written once in the arrays needed by igraph.
+ * @param ewlist
+ * @param num_edges
+ * @param weighted
+ */
+template <class T>
+void GraphC::init_edges(const T *ewlist, size_t num_edges, bool weighted)
+{
+    const size_t ncols = weighted ? 3 : 2;
+    vector<igraph_real_t> edges(2*num_edges);
+    edge_weights_stl.resize(num_edges);
+    _has_selfloops = false;
+    for (size_t k=0; k<num_edges; ++k)
     {
-        if (_weighted)
-            wlist.push_back(ewlist[i+2]);
-        else
-            wlist.push_back(1);
+        const T *row = ewlist + ncols*k;
+        edges[2*k] = static_cast<igraph_real_t>(row[0]);
+        edges[2*k+1] = static_cast<igraph_real_t>(row[1]);
+        edge_weights_stl[k] = weighted ? static_cast<igraph_real_t>(row[2]) : 1.0;
+        _has_selfloops = _has_selfloops || (row[0]==row[1]);
     }
-    this->init(elist.data(),wlist.data(),num_edges);
+    igraph_vector_t edges_view;
+    igraph_vector_view(&edges_view,edges.data(),edges.size());
+    // The graph is already built, as an empty one by GraphC()
+    IGRAPH_TRY(igraph_destroy(&this->ig));
+    IGRAPH_TRY(igraph_create(&this->ig,&edges_view,0,IGRAPH_UNDIRECTED));
+    view_edge_weights(edge_weights_stl.data(),edge_weights_stl.size());
+    _must_delete = true;
+    _is_directed = false;
+    // As in set_edge_weights, the graph is weighted only if it has at least two different weights
+    _is_weighted = false;
+    for (size_t k=1; weighted && k<num_edges && !_is_weighted; ++k)
+        _is_weighted = (edge_weights_stl[k]!=edge_weights_stl[0]);
 }
 
 /**
@@ -173,7 +214,7 @@ void GraphC::init(const double *elist, const double *weights, int num_edges)
         weights_stl.assign(weights, weights + num_edges);
     
     this->set_edge_weights(weights_stl);
-    igraph_vector_view(&edge_weights,edge_weights_stl.data(),edge_weights_stl.size());
+    view_edge_weights(edge_weights_stl.data(),edge_weights_stl.size());
     _must_delete = true;
     // Check for self-loops
     _is_directed = this->ig.directed;
@@ -231,25 +272,311 @@ void GraphC::init(const Eigen::MatrixXd &W)
         throw std::logic_error("Non consistent length of edge weigths vector, or diagonal entries in adjacency matrix.");
     }
 
-    igraph_vector_view(&edge_weights,edge_weights_stl.data(),edge_weights_stl.size());
+    view_edge_weights(edge_weights_stl.data(),edge_weights_stl.size());
     _is_directed = false;
 
     size_t num_different_edge_weight_values = set<double>(W.data(),W.data()+W.rows()*W.cols()).size();
     _is_weighted = num_different_edge_weight_values != 2;
 }
 
+/**
+ * @brief GraphC::GraphC
+ * @param W sparse symmetric adjacency matrix, see init(const Eigen::SparseMatrix<double>&)
+ */
+GraphC::GraphC(const Eigen::SparseMatrix<double> &W)
+{
+    this->init(W);
+}
+
+/**
+ * @brief GraphC::GraphC Build the graph from the CSR arrays of its adjacency matrix, see init_csr
+ * @param n
+ * @param indptr
+ * @param indices
+ * @param values
+ */
+template <class Index, class Real>
+GraphC::GraphC(Index n, const Index *indptr, const Index *indices, const Real *values)
+{
+    this->init_csr(n,indptr,indices,values);
+}
+
+/**
+ * @brief GraphC::GraphC Build the graph from the COO arrays of its adjacency matrix, see init_coo
+ * @param n
+ * @param nnz
+ * @param rows
+ * @param cols
+ * @param values
+ */
+template <class Index, class Real>
+GraphC::GraphC(Index n, size_t nnz, const Index *rows, const Index *cols, const Real *values)
+{
+    this->init_coo(n,nnz,rows,cols,values);
+}
+
+/**
+ * @brief sparse_entry_triangle Validate the entry (i,j) of a n x n sparse adjacency matrix
+ * @param i
+ * @param j
+ * @param n
+ * @param w
+ * @return 1 for nonzero entries in the upper triangle, -1 in the lower triangle, 0 for explicit zeros
+ */
+template <class Index>
+static int sparse_entry_triangle(Index i, Index j, Index n, double w)
+{
+    // Casting to unsigned also rejects negative indices
+    if (static_cast<uint64_t>(i) >= static_cast<uint64_t>(n) || static_cast<uint64_t>(j) >= static_cast<uint64_t>(n))
+        throw std::logic_error("Index out of range in sparse adjacency matrix");
+    if (w==0)
+        return 0;
+    if (i==j)
+        throw std::logic_error("Adjacency matrix has self-loops, only simple graphs allowed");
+    if (w<0)
+        throw std::logic_error("Negative edge weight found. Only positive weights supported.");
+    return (i<j) ? 1 : -1;
+}
+
+/**
+ * @brief GraphC::init Build the graph from a sparse symmetric adjacency matrix. Only the upper triangle is
+ * read, a matrix storing only its lower triangle is accepted too. Compressed matrices are read in place.
+ * @param W
+ */
+void GraphC::init(const Eigen::SparseMatrix<double> &W)
+{
+    if (W.rows()!=W.cols())
+        throw std::logic_error("Non square adjacency matrix");
+    // The column major storage of W is the row major storage of its transpose, the same graph for symmetric W
+    if (W.isCompressed())
+    {
+        this->init_csr<int,double>(W.cols(),W.outerIndexPtr(),W.innerIndexPtr(),W.valuePtr());
+    }
+    else
+    {
+        Eigen::SparseMatrix<double> Wc(W);
+        Wc.makeCompressed();
+        this->init_csr<int,double>(Wc.cols(),Wc.outerIndexPtr(),Wc.innerIndexPtr(),Wc.valuePtr());
+    }
+}
+
+/**
+ * @brief GraphC::init_csr Build the graph from the compressed sparse rows representation of its n x n
+ * symmetric adjacency matrix, as given by scipy.sparse.csr_matrix. The nonzero entries (i,j) with i<j become
+ * edges in row major order, the same order as the dense init(W). If the upper triangle is empty the lower
+ * one is used instead. Indices and values are read in their own type, only the edges and weights arrays
+ * needed by igraph are allocated.
+ * @param n number of vertices
+ * @param indptr n+1 row pointers
+ * @param indices column indices
+ * @param values nonzero values, or NULL for an unweighted graph
+ */
+template <class Index, class Real>
+void GraphC::init_csr(Index n, const Index *indptr, const Index *indices, const Real *values)
+{
+    if (n<0 || static_cast<uint64_t>(n) > static_cast<uint64_t>(INT_MAX))
+        throw std::logic_error("Invalid number of vertices in sparse adjacency matrix");
+
+    // First pass: validate and count the edges in both triangles
+    size_t upper=0, lower=0;
+    for (Index i=0; i<n; ++i)
+    {
+        for (Index k=indptr[i]; k<indptr[i+1]; ++k)
+        {
+            int t = sparse_entry_triangle(i,indices[k],n,values ? static_cast<double>(values[k]) : 1.0);
+            upper += (t>0);
+            lower += (t<0);
+        }
+    }
+    const int triangle = (upper>0 || lower==0) ? 1 : -1;
+
+    // Second pass: fill the edges and weights arrays allocated with their final size
+    vector<igraph_real_t> edges;
+    edges.reserve(2*(triangle>0 ? upper : lower));
+    edge_weights_stl.clear();
+    edge_weights_stl.reserve(triangle>0 ? upper : lower);
+    bool uniform_weights = true;
+    for (Index i=0; i<n; ++i)
+    {
+        for (Index k=indptr[i]; k<indptr[i+1]; ++k)
+        {
+            Index j = indices[k];
+            double w = values ? static_cast<double>(values[k]) : 1.0;
+            if (w==0 || (triangle>0 ? i>=j : i<=j))
+                continue;
+            edges.push_back(std::min(i,j));
+            edges.push_back(std::max(i,j));
+            uniform_weights = uniform_weights && (edge_weights_stl.empty() || w==edge_weights_stl.front());
+            edge_weights_stl.push_back(w);
+        }
+    }
+    this->init_sparse(static_cast<igraph_integer_t>(n),edges,uniform_weights);
+}
+
+/**
+ * @brief GraphC::init_coo Build the graph from the coordinates representation of its n x n symmetric adjacency
+ * matrix, as given by scipy.sparse.coo_matrix or [i,j,w]=find(W) in Matlab with zero based indices.
+ * The nonzero entries (i,j) with i<j become edges in the input order, or the i>j ones if the upper triangle is empty.
+ * @param n number of vertices
+ * @param nnz number of entries
+ * @param rows row indices
+ * @param cols column indices
+ * @param values entry values, or NULL for an unweighted graph
+ */
+template <class Index, class Real>
+void GraphC::init_coo(Index n, size_t nnz, const Index *rows, const Index *cols, const Real *values)
+{
+    if (n<0 || static_cast<uint64_t>(n) > static_cast<uint64_t>(INT_MAX))
+        throw std::logic_error("Invalid number of vertices in sparse adjacency matrix");
+
+    size_t upper=0, lower=0;
+    for (size_t k=0; k<nnz; ++k)
+    {
+        int t = sparse_entry_triangle(rows[k],cols[k],n,values ? static_cast<double>(values[k]) : 1.0);
+        upper += (t>0);
+        lower += (t<0);
+    }
+    const int triangle = (upper>0 || lower==0) ? 1 : -1;
+
+    vector<igraph_real_t> edges;
+    edges.reserve(2*(triangle>0 ? upper : lower));
+    edge_weights_stl.clear();
+    edge_weights_stl.reserve(triangle>0 ? upper : lower);
+    bool uniform_weights = true;
+    for (size_t k=0; k<nnz; ++k)
+    {
+        Index i = rows[k], j = cols[k];
+        double w = values ? static_cast<double>(values[k]) : 1.0;
+        if (w==0 || (triangle>0 ? i>=j : i<=j))
+            continue;
+        edges.push_back(std::min(i,j));
+        edges.push_back(std::max(i,j));
+        uniform_weights = uniform_weights && (edge_weights_stl.empty() || w==edge_weights_stl.front());
+        edge_weights_stl.push_back(w);
+    }
+    this->init_sparse(static_cast<igraph_integer_t>(n),edges,uniform_weights);
+}
+
+/**
+ * @brief GraphC::init_sparse Create the undirected graph once edges and edge_weights_stl are filled by the sparse initializers
+ * @param n
+ * @param edges
+ * @param uniform_weights true if all the edges have the same weight, then the graph is considered unweighted as in init(W)
+ */
+void GraphC::init_sparse(igraph_integer_t n, std::vector<igraph_real_t> &edges, bool uniform_weights)
+{
+    _must_delete = true;
+    igraph_vector_t edges_view;
+    igraph_vector_view(&edges_view,edges.data(),edges.size());
+    IGRAPH_TRY(igraph_create(&this->ig,&edges_view,n,IGRAPH_UNDIRECTED));
+    view_edge_weights(edge_weights_stl.data(),edge_weights_stl.size());
+    _is_directed = false;
+    _has_selfloops = false;
+    _is_weighted = !uniform_weights;
+}
+
+// Explicit instantiations for the index and value types of scipy.sparse, Matlab (mwIndex) and Eigen
+template GraphC::GraphC(int32_t, const int32_t*, const int32_t*, const float*);
+template GraphC::GraphC(int32_t, const int32_t*, const int32_t*, const double*);
+template GraphC::GraphC(int64_t, const int64_t*, const int64_t*, const float*);
+template GraphC::GraphC(int64_t, const int64_t*, const int64_t*, const double*);
+template GraphC::GraphC(size_t, const size_t*, const size_t*, const double*);
+template GraphC::GraphC(int32_t, size_t, const int32_t*, const int32_t*, const float*);
+template GraphC::GraphC(int32_t, size_t, const int32_t*, const int32_t*, const double*);
+template GraphC::GraphC(int64_t, size_t, const int64_t*, const int64_t*, const float*);
+template GraphC::GraphC(int64_t, size_t, const int64_t*, const int64_t*, const double*);
+template void GraphC::init_csr(int32_t, const int32_t*, const int32_t*, const float*);
+template void GraphC::init_csr(int32_t, const int32_t*, const int32_t*, const double*);
+template void GraphC::init_csr(int64_t, const int64_t*, const int64_t*, const float*);
+template void GraphC::init_csr(int64_t, const int64_t*, const int64_t*, const double*);
+template void GraphC::init_csr(size_t, const size_t*, const size_t*, const double*);
+template void GraphC::init_edges(const int32_t*, size_t, bool);
+template void GraphC::init_edges(const int64_t*, size_t, bool);
+template void GraphC::init_edges(const float*, size_t, bool);
+template void GraphC::init_edges(const double*, size_t, bool);
+template void GraphC::init_coo(int32_t, size_t, const int32_t*, const int32_t*, const float*);
+template void GraphC::init_coo(int32_t, size_t, const int32_t*, const int32_t*, const double*);
+template void GraphC::init_coo(int64_t, size_t, const int64_t*, const int64_t*, const float*);
+template void GraphC::init_coo(int64_t, size_t, const int64_t*, const int64_t*, const double*);
+
 /**
  * @brief GraphC::get_edge_weights
  * @return
  */
 const igraph_vector_t* GraphC::get_edge_weights() const
 {
+    if (_is_weighted && _float32_weights)
+        throw std::logic_error("Edge weights are stored in single precision, use GraphC::get_weights()");
     if (_is_weighted)
         return &this->edge_weights;
     else
         return NULL;
 }
 
+/**
+ * @brief GraphC::get_weights
+ * @return a view over the edge weights in their storage precision, empty if the graph is unweighted
+ */
+EdgeWeights GraphC::get_weights() const
+{
+    if (!_is_weighted)
+        return EdgeWeights();
+    if (_float32_weights)
+        return EdgeWeights::single_precision(edge_weights32,number_of_edges());
+    return EdgeWeights(&this->edge_weights);
+}
+
+/**
+ * @brief GraphC::view_edge_weights Points the edge weights vector to double precision weights,
+ * releasing any single precision copy. The contexts built before view the released weights, so
+ * they are invalidated through the revision.
+ * @param w
+ * @param num_edges
+ */
+void GraphC::view_edge_weights(const igraph_real_t *w, size_t num_edges)
+{
+    igraph_vector_view(&edge_weights,w,num_edges);
+    vector<float>().swap(edge_weights_stl32);
+    edge_weights32 = NULL;
+    _float32_weights = false;
+    ++revision;
+}
+
+/**
+ * @brief GraphC::set_float32_weights Switches the storage of the edge weights between double and single
+ * precision, halving the memory and the bandwidth taken by the weights in the optimizers. The weights
+ * of a .pacobin file stored in single precision are viewed in place. Loading or setting the weights
+ * afterwards restores double precision storage. See EdgeWeights for the bound on the quality difference.
+ * @param float32
+ */
+void GraphC::set_float32_weights(bool float32)
+{
+    if (float32 == _float32_weights || !_is_weighted)
+        return;
+    size_t m = number_of_edges();
+    if (float32)
+    {
+        if (binary_graph && binary_graph->weights32())
+        {
+            edge_weights32 = binary_graph->weights32();
+        }
+        else
+        {
+            edge_weights_stl32.assign(edge_weights.stor_begin,edge_weights.stor_begin+igraph_vector_size(&edge_weights));
+            edge_weights32 = edge_weights_stl32.data();
+        }
+        vector<igraph_real_t>().swap(edge_weights_stl);
+        igraph_vector_view(&edge_weights,edge_weights_stl.data(),0);
+        _float32_weights = true;
+        ++revision; // the double precision weights viewed by the contexts are gone
+    }
+    else
+    {
+        edge_weights_stl.assign(edge_weights32,edge_weights32+(edge_weights32 ? m : 0));
+        view_edge_weights(edge_weights_stl.data(),edge_weights_stl.size());
+    }
+}
+
 /**
  * @brief GraphC::compute_vertex_degrees
  * @param loops
@@ -269,7 +596,16 @@ void GraphC::compute_vertex_strenghts(bool loops)
 {
     if (is_weighted())
     {
-        igraph_strength(&ig,&vertices_strenghts,igraph_vss_all(),IGRAPH_ALL,loops,&edge_weights);
+        if (_float32_weights)
+        {
+            igraph_vector_t w;
+            igraph_vector_init(&w,0);
+            get_weights().copy_to(&w);
+            igraph_strength(&ig,&vertices_strenghts,igraph_vss_all(),IGRAPH_ALL,loops,&w);
+            igraph_vector_destroy(&w);
+        }
+        else
+            igraph_strength(&ig,&vertices_strenghts,igraph_vss_all(),IGRAPH_ALL,loops,&edge_weights);
     }
     else
     {
@@ -336,48 +672,26 @@ const igraph_t* GraphC::get_igraph() const
 }
 
 /**
- * @brief GraphC::read_adj_matrix
+ * @brief GraphC::read_adj_matrix Read a dense adjacency matrix, one row per line.
+ * The file is memory mapped and the rows are parsed in parallel blocks, keeping only the nonzero
+ * upper triangular entries, so no dense copy of the matrix is ever built. See parse_adj_matrix.
  * @param filename
  * @return
  */
 bool GraphC::read_adj_matrix(const std::string &filename)
 {
-    IGRAPH_TRY(igraph_destroy(&this->ig));
-    Eigen::MatrixXd adj_mat;
-
-    ifstream file;
-    file.open(filename.c_str(),std::ios::in);
-
-    // Error file is not open
-    if(!file.is_open())
-    {
-        return false;
-    }
+    vector<igraph_real_t> edges;
+    igraph_integer_t n = 0;
+    bool weighted = false;
+    read_adj_matrix_file(filename,edges,this->edge_weights_stl,&n,&weighted);
 
-    vector<vector<double> > data;
-    string line;
-
-    while(!std::getline(file, line, '\n').eof())
-    {
-        std::istringstream reader(line);
-        vector<double> lineData;
-        while(!reader.eof())
-        {
-            double val;
-            reader >> val;
-            if(reader.fail())
-                break;
-            lineData.push_back(val);
-        }
-        data.push_back(lineData);
-    }
-    // Deep copy of data array to the adjacency matrix
-    adj_mat.setZero(data.size(),data.size());
-    for (unsigned int i=0; i<data.size(); ++i)
-        for (unsigned int j=0; j<data.size(); ++j)
-            adj_mat.coeffRef(i,j)=data[i][j];
-
-    this->init(adj_mat);
+    IGRAPH_TRY(igraph_destroy(&this->ig));
+    igraph_vector_t edges_view;
+    igraph_vector_view(&edges_view,edges.data(),edges.size());
+    IGRAPH_TRY(igraph_create(&this->ig,&edges_view,n,IGRAPH_UNDIRECTED));
+    view_edge_weights(edge_weights_stl.data(),edge_weights_stl.size());
+    this->_is_directed = false;
+    this->_is_weighted = weighted;
     return true;
 }
 
@@ -397,42 +711,114 @@ bool GraphC::read_pajek(const std::string &filename)
 }
 
 /**
- * @brief GraphC::read_edge_list
+ * @brief GraphC::read_edge_list Read an unweighted edges list, one "from to" pair per line.
+ * The file is memory mapped and parsed in parallel, see read_edge_list_file.
  * @param filename
- * @param nvertices
  * @return
  */
 bool GraphC::read_edge_list(const std::string &filename)
 {
+    vector<igraph_real_t> edges, unused_weights;
+    read_edge_list_file(filename,false,edges,unused_weights);
+
     IGRAPH_TRY(igraph_destroy(&this->ig));
-    FILE *f = fopen(filename.c_str(),"r");
-    IGRAPH_TRY(igraph_read_graph_edgelist(&this->ig,f,0,0));
-    fclose(f);
+    igraph_vector_t edges_view;
+    igraph_vector_view(&edges_view,edges.data(),edges.size());
+    IGRAPH_TRY(igraph_create(&this->ig,&edges_view,0,IGRAPH_UNDIRECTED));
     this->_is_weighted = false;
     return true;
 }
 
 /**
- * @brief GraphC::read_weighted_edge_list
+ * @brief GraphC::read_weighted_edge_list Read a weighted edges list, one "from to weight" triple per line.
+ * The file is memory mapped and parsed in parallel, weights are parsed directly in the edge weights storage.
  * @param filename
- * @param nvertices
- * @param edge_weights vector
  * @return
  */
 bool GraphC::read_weighted_edge_list(const std::string &filename)
 {
+    vector<igraph_real_t> edges;
+    read_edge_list_file(filename,true,edges,this->edge_weights_stl);
+
     IGRAPH_TRY(igraph_destroy(&this->ig));
-    FILE *f = fopen(filename.c_str(),"r");
-    IGRAPH_TRY(igraph_read_graph_weighted_edgelist(&this->ig,f,0,0,&this->edge_weights));
-    fclose(f);
+    igraph_vector_t edges_view;
+    igraph_vector_view(&edges_view,edges.data(),edges.size());
+    IGRAPH_TRY(igraph_create(&this->ig,&edges_view,0,IGRAPH_UNDIRECTED));
+    view_edge_weights(edge_weights_stl.data(),edge_weights_stl.size());
     this->_is_weighted = true;
-    int m = igraph_vector_size(&this->edge_weights);
-    this->edge_weights_stl.resize(m);
-    for (int i=0; i<m; ++i)
-        edge_weights_stl.at(i) = edge_weights.stor_begin[i];
     return true;
 }
 
+/**
+ * @brief GraphC::read_binary Read a graph in the native .pacobin format, see BinaryGraph.h.
+ * The file is memory mapped and double precision edge weights are viewed in place without copies.
+ * The mapping is kept alive as long as this graph or any of its copies exists.
+ * @param filename
+ * @return
+ */
+bool GraphC::read_binary(const std::string &filename)
+{
+    std::shared_ptr<const BinaryGraph> bin(new BinaryGraph(filename));
+    size_t m = bin->number_of_edges();
+
+    // igraph 0.7 only accepts edges as a vector of reals, this is the only conversion needed
+    vector<igraph_real_t> edges(bin->edges(),bin->edges()+2*m);
+    IGRAPH_TRY(igraph_destroy(&this->ig));
+    igraph_vector_t edges_view;
+    igraph_vector_view(&edges_view,edges.data(),edges.size());
+    IGRAPH_TRY(igraph_create(&this->ig,&edges_view,bin->number_of_nodes(),bin->is_directed()));
+
+    edge_weights_stl.clear();
+    if (bin->weights64())
+    {
+        view_edge_weights(bin->weights64(),m);
+    }
+    else
+    {
+        if (bin->weights32())
+            edge_weights_stl.assign(bin->weights32(),bin->weights32()+m);
+        view_edge_weights(edge_weights_stl.data(),edge_weights_stl.size());
+    }
+    this->binary_graph = bin;
+    this->_is_weighted = bin->is_weighted();
+    this->_is_directed = bin->is_directed();
+    return true;
+}
+
+/**
+ * @brief GraphC::write_binary Save the graph in the native .pacobin format
+ * @param filename
+ * @param float32_weights if true the edge weights are stored in single precision
+ */
+void GraphC::write_binary(const std::string &filename, bool float32_weights) const
+{
+    write_binary_graph(*this,filename,float32_weights);
+}
+
+/**
+ * @brief GraphC::read Read a graph choosing the format from the file extension:
+ * .net (pajek), .gml, .adj (adjacency matrix), .ncol or .edge (edges list), .wncol (weighted edges list), .pacobin (native binary)
+ * @param filename
+ * @return false if the format is not supported
+ */
+bool GraphC::read(const std::string &filename)
+{
+    PACO_TRACE_SCOPE("GraphC::read");
+    string ext = filename.substr(filename.find_last_of(".") + 1);
+    if (ext == "net")
+        return read_pajek(filename);
+    else if (ext == "adj")
+        return read_adj_matrix(filename);
+    else if (ext == "gml")
+        return read_gml(filename);
+    else if (ext == "ncol" || ext == "edge")
+        return read_edge_list(filename);
+    else if (ext == "wncol")
+        return read_weighted_edge_list(filename);
+    else if (ext == "pacobin")
+        return read_binary(filename);
+    return false;
+}
 
 /**
  * @brief GraphC::read_weights_from_file
@@ -468,7 +854,7 @@ bool GraphC::read_weights_from_file(const string &filename)
 
     size_t num_different_edge_weight_values = set<double>(edge_weights_stl.begin(),edge_weights_stl.end()).size();
     _is_weighted = num_different_edge_weight_values != 2; // set if the graph is weighted or just has two different weights
-    igraph_vector_view(&edge_weights,edge_weights_stl.data(),edge_weights_stl.size()); // copy to weights vector
+    view_edge_weights(edge_weights_stl.data(),edge_weights_stl.size()); // copy to weights vector
     return true;
 }
 
@@ -479,7 +865,8 @@ bool GraphC::read_weights_from_file(const string &filename)
 void GraphC::set_edge_weights(const vector<igraph_real_t> &w, bool override_is_weighted)
 {
     this->edge_weights_stl = w;
-    igraph_vector_view(&edge_weights,edge_weights_stl.data(),edge_weights_stl.size());
+    view_edge_weights(edge_weights_stl.data(),edge_weights_stl.size());
+    ++revision;
 
     size_t num_different_edge_weight_values = set<double>(edge_weights_stl.begin(),edge_weights_stl.end()).size();
     _is_weighted = num_different_edge_weight_values > 1;
@@ -529,6 +916,7 @@ bool GraphC::add_edge(size_t source, size_t target)
 {
     if (!is_edge(source,target)) // allow only simple undirected graphs
         igraph_add_edge(&this->ig,source,target);
+    ++revision;
     return true;
 }
 
@@ -547,6 +935,7 @@ bool GraphC::remove_edge(size_t source, size_t target)
         igraph_es_t es;
         IGRAPH_TRY(igraph_es_pairs_small(&es, IGRAPH_UNDIRECTED, source, target));
         IGRAPH_TRY(igraph_delete_edges(&this->ig,es));
+        ++revision;
         return true;
     }
 }
@@ -559,9 +948,135 @@ bool GraphC::remove_edge(size_t source, size_t target)
 bool GraphC::remove_edges(igraph_es_t &es)
 {
     IGRAPH_TRY(igraph_delete_edges(&this->ig,es));
+    ++revision;
     return true;
 }
 
+/**
+ * @brief GraphC::apply_edits Applies a batch of edge insertions, deletions and weight changes, keeping the
+ * edge weights aligned with the edges. Edits are applied in order: as in add_edge and remove_edge, inserting
+ * an existing edge or deleting a missing one does nothing, while reweighting a missing edge is an error.
+ * Unweighted graphs have unit weights and become weighted as soon as two weights differ.
+ * Remaining edges keep their relative order and inserted edges are appended.
+ * @param edits
+ * @return the net weight change of every edge touched by the batch, in order of first edit
+ */
+std::vector<EdgeChange> GraphC::apply_edits(const std::vector<EdgeEdit> &edits)
+{
+    const size_t n = number_of_nodes();
+    const size_t m = number_of_edges();
+
+    // Current weights, unit weights if the graph is unweighted
+    vector<igraph_real_t> w(m,1.0);
+    EdgeWeights cur = get_weights();
+    for (size_t e=0; cur && e<m; ++e)
+        w[e] = cur[e];
+
+    // State of every edited vertex pair before and after the batch
+    struct PairState
+    {
+        igraph_integer_t eid;
+        bool exists;
+        double weight;
+    };
+    std::map< std::pair<size_t,size_t>, size_t > index;
+    vector< std::pair<size_t,size_t> > pairs;
+    vector<PairState> before, after;
+    for (size_t i=0; i<edits.size(); ++i)
+    {
+        const EdgeEdit &edit = edits[i];
+        if (edit.source>=n || edit.target>=n)
+            throw std::logic_error("Edge endpoint out of range");
+        if (edit.type!=EdgeEdit::Delete && edit.weight<0)
+            throw std::logic_error("Negative weight in edge edit");
+        std::pair<size_t,size_t> key(std::min(edit.source,edit.target),std::max(edit.source,edit.target));
+        std::map< std::pair<size_t,size_t>, size_t >::iterator it = index.find(key);
+        if (it==index.end())
+        {
+            PairState st;
+            IGRAPH_TRY(igraph_get_eid(&this->ig,&st.eid,key.first,key.second,false,false));
+            st.exists = st.eid>=0;
+            st.weight = st.exists ? w[st.eid] : 0;
+            it = index.insert(std::make_pair(key,pairs.size())).first;
+            pairs.push_back(key);
+            before.push_back(st);
+            after.push_back(st);
+        }
+        PairState &st = after[it->second];
+        switch (edit.type)
+        {
+        case EdgeEdit::Insert:
+            if (!st.exists)
+            {
+                st.exists = true;
+                st.weight = edit.weight;
+            }
+            break;
+        case EdgeEdit::Delete:
+            st.exists = false;
+            st.weight = 0;
+            break;
+        case EdgeEdit::Reweight:
+            if (!st.exists)
+                throw std::logic_error("Reweighting a non existing edge");
+            st.weight = edit.weight;
+            break;
+        }
+    }
+
+    vector<EdgeChange> changes;
+    vector<char> deleted(m,0);
+    igraph_vector_t deleted_eids, added_edges;
+    IGRAPH_TRY(igraph_vector_init(&deleted_eids,0));
+    IGRAPH_TRY(igraph_vector_init(&added_edges,0));
+    vector<igraph_real_t> added_weights;
+    for (size_t i=0; i<pairs.size(); ++i)
+    {
+        const PairState &b = before[i], &a = after[i];
+        if (b.exists && a.exists)
+            w[b.eid] = a.weight;
+        else if (b.exists)
+        {
+            deleted[b.eid] = 1;
+            IGRAPH_TRY(igraph_vector_push_back(&deleted_eids,b.eid));
+        }
+        else if (a.exists)
+        {
+            IGRAPH_TRY(igraph_vector_push_back(&added_edges,pairs[i].first));
+            IGRAPH_TRY(igraph_vector_push_back(&added_edges,pairs[i].second));
+            added_weights.push_back(a.weight);
+            _has_selfloops = _has_selfloops || pairs[i].first==pairs[i].second;
+        }
+        if (a.exists!=b.exists || a.weight!=b.weight)
+        {
+            EdgeChange c = { pairs[i].first, pairs[i].second, a.weight - b.weight };
+            changes.push_back(c);
+        }
+    }
+    const size_t ndeleted = igraph_vector_size(&deleted_eids);
+    if (ndeleted>0)
+        IGRAPH_TRY(igraph_delete_edges(&this->ig,igraph_ess_vector(&deleted_eids)));
+    if (igraph_vector_size(&added_edges)>0)
+        IGRAPH_TRY(igraph_add_edges(&this->ig,&added_edges,0));
+    igraph_vector_destroy(&deleted_eids);
+    igraph_vector_destroy(&added_edges);
+
+    // Weights of the remaining edges in their order, then those of the inserted edges
+    vector<igraph_real_t> new_weights;
+    new_weights.reserve(m - ndeleted + added_weights.size());
+    for (size_t e=0; e<m; ++e)
+        if (!deleted[e])
+            new_weights.push_back(w[e]);
+    new_weights.insert(new_weights.end(),added_weights.begin(),added_weights.end());
+
+    // The graph doesn't match a binary file anymore
+    bool float32 = _float32_weights;
+    binary_graph.reset();
+    this->set_edge_weights(new_weights);
+    this->set_float32_weights(float32);
+    return changes;
+}
+
 /**
  * @brief GraphC::line_graph Create a line graph from the current graph.
  * The line graph L(G) of a G undirected graph is defined as follows. L(G) has one vertex
@@ -620,6 +1135,7 @@ pair<igraph_integer_t,igraph_integer_t> GraphC::get_edge(size_t edge_id) const
 bool GraphC::add_vertices(size_t nvertices)
 {
     IGRAPH_TRY(igraph_add_vertices(&this->ig,nvertices,0));
+    ++revision;
     return true;
 }
 
@@ -44,14 +44,21 @@
 #include <string>
 #include <stdexcept>
 #include <exception>
+#include <memory>
+#include <stdint.h>
 
 #include <Eigen/Core>
+#include <Eigen/SparseCore>
 
 #include <igraph.h>
 #include "Common.h"
 #include "igraph_utils.h"
+#include "EdgeWeights.h"
+#include "GraphEdits.h"
 #include "FileLogger.h"
 
+class BinaryGraph;
+
 
 class GraphC
 {
@@ -63,12 +70,24 @@ public:
     GraphC(double *W, int n, int m);
     GraphC(const double *edges, const double *edge_weights, int nedges);
     GraphC(igraph_t *g);
+    GraphC(const Eigen::SparseMatrix<double> &W);
+    template <class Index, class Real>
+    GraphC(Index n, const Index *indptr, const Index *indices, const Real *values);
+    template <class Index, class Real>
+    GraphC(Index n, size_t nnz, const Index *rows, const Index *cols, const Real *values);
     ~GraphC();
 
     void init(const Eigen::MatrixXd &W);
     void init(const double* ewlist, int weighted, int num_edges);
     void init(const double *elist, const double *weights, int num_edges);
     void init(const std::vector<double> &edges_list, const std::vector<double> &weights);
+    void init(const Eigen::SparseMatrix<double> &W);
+    template <class Index, class Real>
+    void init_csr(Index n, const Index *indptr, const Index *indices, const Real *values);
+    template <class T>
+    void init_edges(const T *ewlist, size_t num_edges, bool weighted);
+    template <class Index, class Real>
+    void init_coo(Index n, size_t nnz, const Index *rows, const Index *cols, const Real *values);
 
     const igraph_t *get_igraph() const; // allows only const copies of the pointer.
     bool read_adj_matrix(const std::string &filename);
@@ -77,7 +96,20 @@ public:
     bool read_edge_list(const std::string &filename);
     bool read_gml(const std::string &filename);
     bool read_weights_from_file(const string &filename);
+    bool read_binary(const std::string &filename);
+    bool read(const std::string &filename);
+    void write_binary(const std::string &filename, bool float32_weights=false) const;
     void set_edge_weights(const std::vector<igraph_real_t> &w, bool override_is_weighted=false);
+    void set_float32_weights(bool float32=true);
+    bool has_float32_weights() const
+    {
+        return _float32_weights;
+    }
+    // Incremented by every change of the edges or of their weights
+    uint64_t get_revision() const
+    {
+        return revision;
+    }
 
     void compute_vertex_strenghts(bool loops=false);
     void compute_vertex_degrees(bool loops=false);
@@ -96,11 +128,13 @@ public:
     bool add_edge(size_t source, size_t target);
     bool remove_edge(size_t source, size_t target);
     bool remove_edges(igraph_es_t &es);
+    std::vector<EdgeChange> apply_edits(const std::vector<EdgeEdit> &edits);
 
     GraphC* line_graph();
 
     std::pair<igraph_integer_t,igraph_integer_t> get_edge(size_t edgeid) const;
     const igraph_vector_t* get_edge_weights() const;
+    EdgeWeights get_weights() const;
 
     bool is_edge(size_t source, size_t target) const;
     bool is_directed() const;
@@ -114,11 +148,17 @@ public:
     void info();
 
 protected:
+    void init_sparse(igraph_integer_t n, std::vector<igraph_real_t> &edges, bool uniform_weights);
+    void view_edge_weights(const igraph_real_t *w, size_t num_edges);
+
     igraph_t ig;
 
     // Weights storage
     vector<igraph_real_t> edge_weights_stl;
     igraph_vector_t edge_weights;
+    // Single precision weights storage, used in place of the two above after set_float32_weights
+    vector<float> edge_weights_stl32;
+    const float *edge_weights32 = NULL;
 
     vector<igraph_real_t> vertices_strenghts_stl;
     igraph_vector_t vertices_strenghts;
@@ -129,6 +169,11 @@ protected:
     bool _is_weighted;
     bool _is_directed;
     bool _has_selfloops;
+    bool _float32_weights = false;
+    uint64_t revision = 0;
+
+    // Memory mapped .pacobin file, owner of the edge weights memory when they are viewed in place
+    std::shared_ptr<const BinaryGraph> binary_graph;
   private:
     bool _must_delete;
 };
@@ -0,0 +1,150 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+#include <ios>
+#include <stdexcept>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "GraphCache.h"
+
+/**
+ * @brief file_version Modification time and size of a file
+ * @param filename
+ * @param mtime
+ * @param file_size
+ */
+static void file_version(const std::string &filename, int64_t *mtime, int64_t *file_size)
+{
+    struct stat st;
+    if (stat(filename.c_str(),&st)!=0)
+        throw std::ios_base::failure("Error, file " + filename + " doesn't exist");
+#if defined(__linux__)
+    *mtime = static_cast<int64_t>(st.st_mtim.tv_sec)*1000000000LL + st.st_mtim.tv_nsec;
+#else
+    *mtime = static_cast<int64_t>(st.st_mtime)*1000000000LL;
+#endif
+    *file_size = static_cast<int64_t>(st.st_size);
+}
+
+/**
+ * @brief GraphCache::GraphCache
+ * @param capacity maximum number of graphs kept, at least one
+ */
+GraphCache::GraphCache(size_t capacity) : max_entries(capacity>0 ? capacity : 1), num_hits(0), num_misses(0)
+{
+}
+
+/**
+ * @brief GraphCache::get Returns the graph read from filename, reading it if it is not cached or if the file
+ * changed since it was read. The graph is read without holding the lock, so other threads are not blocked
+ * by the reading of a large file.
+ * @param filename
+ * @return
+ */
+std::shared_ptr<const CachedGraph> GraphCache::get(const std::string &filename)
+{
+    int64_t mtime, file_size;
+    file_version(filename,&mtime,&file_size);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::map<std::string, EntryList::iterator>::iterator it = index.find(filename);
+        if (it!=index.end())
+        {
+            if ((*it->second)->mtime==mtime && (*it->second)->file_size==file_size)
+            {
+                entries.splice(entries.begin(),entries,it->second);
+                ++num_hits;
+                return entries.front();
+            }
+            entries.erase(it->second); // stale
+            index.erase(it);
+        }
+        ++num_misses;
+    }
+
+    std::shared_ptr<CachedGraph> loaded = std::make_shared<CachedGraph>();
+    loaded->filename = filename;
+    loaded->mtime = mtime;
+    loaded->file_size = file_size;
+    loaded->graph.reset(new GraphC);
+    if (!loaded->graph->read(filename))
+        throw std::invalid_argument("Non supported graph format " + filename);
+    loaded->context = std::make_shared<const GraphContext>(*loaded->graph);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    // Another thread may have read the same file in the meantime, the last read wins
+    std::map<std::string, EntryList::iterator>::iterator it = index.find(filename);
+    if (it!=index.end())
+    {
+        entries.erase(it->second);
+        index.erase(it);
+    }
+    entries.push_front(loaded);
+    index[filename] = entries.begin();
+    while (entries.size()>max_entries)
+    {
+        index.erase(entries.back()->filename);
+        entries.pop_back();
+    }
+    return loaded;
+}
+
+/**
+ * @brief GraphCache::clear Drops all the graphs
+ */
+void GraphCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+}
+
+size_t GraphCache::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+size_t GraphCache::hits() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return num_hits;
+}
+
+size_t GraphCache::misses() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return num_misses;
+}
@@ -0,0 +1,94 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+#ifndef _GRAPH_CACHE_H_
+#define _GRAPH_CACHE_H_
+
+#include <string>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include "Graph.h"
+#include "GraphContext.h"
+
+/**
+ * A graph read from file together with its read-only context, shared by all the optimizations
+ * that use it. The graph and the context are never modified after loading.
+ */
+struct CachedGraph
+{
+    std::string filename;
+    int64_t mtime;      // modification time of the file when it was read
+    int64_t file_size;
+    std::unique_ptr<GraphC> graph;
+    std::shared_ptr<const GraphContext> context;
+};
+
+/**
+ * Least recently used cache of graphs read from file, keyed by file name and validated against the
+ * modification time and size of the file: a file changed since it was read is read again.
+ * It is safe to use from many threads. Entries are handed out as shared pointers, so an entry evicted
+ * while an optimization uses it lives until that optimization ends.
+ */
+class GraphCache
+{
+public:
+    GraphCache(size_t capacity=8);
+
+    std::shared_ptr<const CachedGraph> get(const std::string &filename);
+    void clear();
+
+    size_t size() const;
+    size_t capacity() const
+    {
+        return max_entries;
+    }
+    size_t hits() const;
+    size_t misses() const;
+
+private:
+    typedef std::list< std::shared_ptr<const CachedGraph> > EntryList; // most recently used first
+
+    size_t max_entries;
+    size_t num_hits;
+    size_t num_misses;
+    EntryList entries;
+    std::map<std::string, EntryList::iterator> index;
+    mutable std::mutex mutex;
+};
+
+#endif // _GRAPH_CACHE_H_
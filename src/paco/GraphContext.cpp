@@ -0,0 +1,133 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+
+#include <stdexcept>
+#include <algorithm>
+#include "GraphContext.h"
+#include "Graph.h"
+#include "Common.h"
+#include "Trace.h"
+
+/**
+ * @brief GraphContext::GraphContext Computes the CSR adjacency, degrees, strengths and totals of g
+ * @param g
+ */
+GraphContext::GraphContext(const GraphC &g) : ig(g.get_igraph()), weights(g.get_weights()), graph_revision(g.get_revision())
+{
+    PACO_TRACE_SCOPE("GraphContext");
+    num_vertices = g.number_of_nodes();
+    num_edges = g.number_of_edges();
+    const size_t n = num_vertices, m = num_edges;
+
+    if (weights && weights.size() != m)
+        throw std::logic_error("Weights vector != number of edges");
+
+    // Edge endpoints in edge id order and CSR adjacency built with a counting sort
+    edge_endpoints.resize(2*m);
+    csr_offsets.assign(n+1,0);
+    for (size_t e=0; e<m; ++e)
+    {
+        igraph_integer_t from, to;
+        igraph_edge(ig,e,&from,&to);
+        if (weights && weights[e] < 0)
+            throw std::logic_error("Negative weight in weight vector");
+        edge_endpoints[2*e] = from;
+        edge_endpoints[2*e+1] = to;
+        ++csr_offsets[from+1];
+        if (from!=to)
+            ++csr_offsets[to+1];
+    }
+    for (size_t v=0; v<n; ++v)
+        csr_offsets[v+1] += csr_offsets[v];
+
+    csr_neighbors.resize(csr_offsets[n]);
+    csr_adj_edges.resize(csr_offsets[n]);
+    std::vector<uint64_t> fill(csr_offsets.begin(),csr_offsets.end()-1);
+    for (size_t e=0; e<m; ++e)
+    {
+        uint32_t a = edge_endpoints[2*e], b = edge_endpoints[2*e+1];
+        csr_neighbors[fill[a]] = b;
+        csr_adj_edges[fill[a]++] = e;
+        if (a!=b)
+        {
+            csr_neighbors[fill[b]] = a;
+            csr_adj_edges[fill[b]++] = e;
+        }
+    }
+    // Sort every row by neighbor id keeping the edge ids aligned, as igraph_incident does
+    std::vector< std::pair<uint32_t,uint32_t> > row;
+    for (size_t v=0; v<n; ++v)
+    {
+        row.clear();
+        for (uint64_t k=csr_offsets[v]; k<csr_offsets[v+1]; ++k)
+            row.push_back(std::make_pair(csr_neighbors[k],csr_adj_edges[k]));
+        std::sort(row.begin(),row.end());
+        for (uint64_t k=csr_offsets[v]; k<csr_offsets[v+1]; ++k)
+        {
+            csr_neighbors[k] = row[k-csr_offsets[v]].first;
+            csr_adj_edges[k] = row[k-csr_offsets[v]].second;
+        }
+    }
+
+    // Degrees and strengths without self loops, accumulated in double precision
+    IGRAPH_TRY(igraph_vector_init(&degrees,n));
+    IGRAPH_TRY(igraph_vector_init(&strenghts,n));
+    for (size_t v=0; v<n; ++v)
+    {
+        double d = 0, s = 0;
+        for (uint64_t k=csr_offsets[v]; k<csr_offsets[v+1]; ++k)
+        {
+            if (csr_neighbors[k]==v)
+                continue;
+            d += 1;
+            s += weights ? weights[csr_adj_edges[k]] : 1.0;
+        }
+        VECTOR(degrees)[v] = d;
+        VECTOR(strenghts)[v] = s;
+    }
+
+    total_weight = weights ? weights.sum() : static_cast<double>(m);
+    total_pairs = num_pairs(n);
+}
+
+/**
+ * @brief GraphContext::~GraphContext
+ */
+GraphContext::~GraphContext()
+{
+    igraph_vector_destroy(&degrees);
+    igraph_vector_destroy(&strenghts);
+}
@@ -0,0 +1,161 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+
+#ifndef _GRAPH_CONTEXT_H_
+#define _GRAPH_CONTEXT_H_
+
+#include <vector>
+#include <memory>
+#include <stdint.h>
+#include <igraph.h>
+#include "EdgeWeights.h"
+
+class GraphC;
+
+/**
+ * Read-only data derived from a graph that every optimization needs and that doesn't depend on the
+ * partition: CSR adjacency, edge endpoints, vertex degrees and strengths and the graph totals.
+ * It is built once and shared through a std::shared_ptr<const GraphContext> by any number of
+ * PartitionHelper instances, optimizers and threads, so that the per-worker state is only made of
+ * the partition itself. All the methods are const and the object is never modified after construction.
+ * The context views the igraph_t and the edge weights of the GraphC it is built from, which must outlive it.
+ */
+class GraphContext
+{
+public:
+    GraphContext(const GraphC &g);
+    ~GraphContext();
+
+    const igraph_t *get_igraph() const
+    {
+        return ig;
+    }
+
+    const EdgeWeights &get_weights() const
+    {
+        return weights;
+    }
+
+    igraph_integer_t number_of_nodes() const
+    {
+        return num_vertices;
+    }
+
+    igraph_integer_t number_of_edges() const
+    {
+        return num_edges;
+    }
+
+    /**
+     * @brief CSR row of vertex v: neighbors are neighbors()[k] and incident edges adj_edges()[k]
+     * for k in [offsets()[v], offsets()[v+1]), sorted by neighbor id. Self loops are listed once.
+     */
+    const uint64_t *offsets() const
+    {
+        return csr_offsets.data();
+    }
+
+    const uint32_t *neighbors() const
+    {
+        return csr_neighbors.data();
+    }
+
+    const uint32_t *adj_edges() const
+    {
+        return csr_adj_edges.data();
+    }
+
+    /**
+     * @brief Endpoints of edge e are edges()[2*e] and edges()[2*e+1]
+     */
+    const uint32_t *edges() const
+    {
+        return edge_endpoints.data();
+    }
+
+    /**
+     * @brief Vertex degrees and strengths, self loops excluded, as computed by PartitionHelper::init
+     */
+    const igraph_vector_t *get_degrees() const
+    {
+        return &degrees;
+    }
+
+    const igraph_vector_t *get_strenghts() const
+    {
+        return &strenghts;
+    }
+
+    double get_total_weight() const
+    {
+        return total_weight;
+    }
+
+    double get_total_pairs() const
+    {
+        return total_pairs;
+    }
+
+    /**
+     * @brief Revision of the GraphC when the context was built, see GraphC::get_revision
+     */
+    uint64_t get_graph_revision() const
+    {
+        return graph_revision;
+    }
+
+private:
+    GraphContext(const GraphContext &);
+    GraphContext& operator=(const GraphContext &);
+
+    const igraph_t *ig;
+    EdgeWeights weights;
+    igraph_integer_t num_vertices;
+    igraph_integer_t num_edges;
+
+    std::vector<uint64_t> csr_offsets;
+    std::vector<uint32_t> csr_neighbors;
+    std::vector<uint32_t> csr_adj_edges;
+    std::vector<uint32_t> edge_endpoints;
+
+    igraph_vector_t degrees;
+    igraph_vector_t strenghts;
+    double total_weight; // sum of the edge weights, number of edges if unweighted
+    double total_pairs;  // n*(n-1)/2
+    uint64_t graph_revision;
+};
+
+#endif // _GRAPH_CONTEXT_H_
@@ -0,0 +1,71 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+#ifndef _GRAPH_EDITS_H_
+#define _GRAPH_EDITS_H_
+
+#include <cstddef>
+
+/**
+ * @brief Edit of an undirected edge, applied in batches by GraphC::apply_edits
+ */
+struct EdgeEdit
+{
+    enum Type
+    {
+        Insert = 0,
+        Delete = 1,
+        Reweight = 2
+    };
+    Type type;
+    size_t source;
+    size_t target;
+    double weight; // weight of inserted or reweighted edges, not used by deletions
+
+    EdgeEdit(Type type, size_t source, size_t target, double weight=1.0) : type(type), source(source), target(target), weight(weight) {}
+};
+
+/**
+ * @brief Net change of the weight of an edge after a batch of edits, the new weight minus the old one with
+ * missing edges having zero weight
+ */
+struct EdgeChange
+{
+    size_t source;
+    size_t target;
+    double delta;
+};
+
+#endif // _GRAPH_EDITS_H_
@@ -0,0 +1,194 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+#include <algorithm>
+#include <cmath>
+#include "LocalMoveOptimizer.h"
+
+LocalMoveOptimizer::~LocalMoveOptimizer()
+{
+}
+
+/**
+ * @brief LocalMoveOptimizer::diff_move Moves vert to dest_comm if it improves the quality
+ * @param g
+ * @param fun
+ * @param memb
+ * @param vert
+ * @param dest_comm
+ * @param weights
+ * @return the quality difference of the move
+ */
+double LocalMoveOptimizer::diff_move(const igraph_t *g, const QualityFunction &fun, Membership *memb, int vert, size_t dest_comm, const EdgeWeights &weights)
+{
+    double pre = current_quality(fun);
+    size_t orig_comm = (*memb)[vert];
+    ++counters.moves_attempted;
+    if (!par->move_vertex(g,memb,vert,dest_comm,weights))
+        return 0;
+    double post = evaluate(fun);
+    if (post<pre)
+    {
+        par->move_vertex(g,memb,vert,orig_comm,weights); // restore previous status
+        set_current_quality(pre);
+        ++counters.moves_reverted;
+    }
+    else
+        ++counters.moves_accepted;
+    return post-pre;
+}
+
+/**
+ * @brief LocalMoveOptimizer::optimize Local moves starting from all the vertices
+ * @param g
+ * @param fun
+ * @param memb
+ * @param weights
+ * @return
+ */
+double LocalMoveOptimizer::optimize(const igraph_t *g, const QualityFunction &fun, Membership *memb, const EdgeWeights &weights)
+{
+    init_partition_helper(g,memb,weights);
+    std::vector<size_t> active(igraph_vcount(g));
+    for (size_t v=0; v<active.size(); ++v)
+        active[v] = v;
+    return optimize_active(fun,memb,active);
+}
+
+/**
+ * @brief LocalMoveOptimizer::update_graph Brings the partition helper to the context of the edited graph.
+ * The first time the helper is initialized from memb, afterwards only the aggregates touched by the
+ * changes are updated, so memb must not be modified by others between the calls.
+ * @param ctx context of the graph after the edits
+ * @param changes as returned by GraphC::apply_edits
+ * @param memb
+ */
+void LocalMoveOptimizer::update_graph(const std::shared_ptr<const GraphContext> &ctx, const std::vector<EdgeChange> &changes, Membership *memb)
+{
+    if (par->get_graph_context())
+        par->update_graph(ctx,changes);
+    else
+        par->init(ctx,memb,ctx->get_weights());
+    this->set_graph_context(ctx);
+}
+
+/**
+ * @brief LocalMoveOptimizer::optimize_active Moves the active vertices, and then the neighbors of the moved ones,
+ * to the neighbor community with the largest quality gain, until no move improves the quality.
+ * The partition helper must be initialized on the graph context with memb.
+ * @param fun
+ * @param memb
+ * @param active
+ * @return the quality of the final partition, computed from the community aggregates
+ */
+double LocalMoveOptimizer::optimize_active(const QualityFunction &fun, Membership *memb, const std::vector<size_t> &active)
+{
+    PACO_TRACE_SCOPE("LocalMoveOptimizer::optimize_active");
+    if (!context || par->get_graph_context()!=context)
+        throw std::logic_error("LocalMoveOptimizer needs the partition helper on the graph context");
+
+    const igraph_t *g = context->get_igraph();
+    const EdgeWeights &weights = context->get_weights();
+    const size_t n = context->number_of_nodes();
+    const uint64_t *offsets = context->offsets();
+    const uint32_t *neighbors = context->neighbors();
+
+    queued.assign(n,0);
+    queue.clear();
+    for (size_t i=0; i<active.size(); ++i)
+    {
+        if (active[i]<n && !queued[active[i]])
+        {
+            queued[active[i]] = 1;
+            queue.push_back(active[i]);
+        }
+    }
+
+    double quality = evaluate(fun);
+    while (!queue.empty())
+    {
+        if (interrupted())
+            break;
+        size_t v = queue.front();
+        queue.pop_front();
+        queued[v] = 0;
+
+        size_t orig_comm = (*memb)[v];
+        candidates.clear();
+        for (uint64_t k=offsets[v]; k<offsets[v+1]; ++k)
+        {
+            size_t c = (*memb)[neighbors[k]];
+            if (c!=orig_comm)
+                candidates.push_back(c);
+        }
+        std::sort(candidates.begin(),candidates.end());
+        candidates.erase(std::unique(candidates.begin(),candidates.end()),candidates.end());
+
+        // Try every neighbor community, moving from one to the next, and keep the best one
+        size_t best_comm = orig_comm;
+        double best_quality = quality;
+        for (size_t i=0; i<candidates.size(); ++i)
+        {
+            ++counters.moves_attempted;
+            par->move_vertex(g,memb,v,candidates[i],weights);
+            double q = evaluate(fun);
+            // Relative tolerance, so that rounding in the aggregates doesn't make moves cycle
+            if (q > best_quality + 1E-12*std::fabs(best_quality))
+            {
+                best_quality = q;
+                best_comm = candidates[i];
+            }
+        }
+        if ((*memb)[v]!=best_comm)
+            par->move_vertex(g,memb,v,best_comm,weights);
+        // Every candidate but the best one has been undone
+        counters.moves_reverted += candidates.size() - (best_comm!=orig_comm);
+        if (best_comm==orig_comm)
+            continue;
+        ++counters.moves_accepted;
+        quality = best_quality;
+
+        for (uint64_t k=offsets[v]; k<offsets[v+1]; ++k)
+        {
+            size_t u = neighbors[k];
+            if (!queued[u])
+            {
+                queued[u] = 1;
+                queue.push_back(u);
+            }
+        }
+    }
+    return final_quality(fun);
+}
@@ -0,0 +1,172 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+
+#include <ios>
+#include <stdexcept>
+#include "MemoryMappedFile.h"
+
+#if !(defined(WIN32) || defined(_WIN32) || defined(__WIN32__))
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief MemoryMappedFile::MemoryMappedFile
+ */
+MemoryMappedFile::MemoryMappedFile() : _data(NULL), _size(0), _is_open(false)
+{
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+    _file = INVALID_HANDLE_VALUE;
+    _mapping = NULL;
+#else
+    _fd = -1;
+#endif
+}
+
+/**
+ * @brief MemoryMappedFile::MemoryMappedFile
+ * @param filename
+ */
+MemoryMappedFile::MemoryMappedFile(const std::string &filename) : _data(NULL), _size(0), _is_open(false)
+{
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+    _file = INVALID_HANDLE_VALUE;
+    _mapping = NULL;
+#else
+    _fd = -1;
+#endif
+    if (!this->open(filename))
+        throw std::ios_base::failure("Error, file " + filename + " doesn't exist or cannot be mapped");
+}
+
+/**
+ * @brief MemoryMappedFile::~MemoryMappedFile
+ */
+MemoryMappedFile::~MemoryMappedFile()
+{
+    this->close();
+}
+
+/**
+ * @brief MemoryMappedFile::open Map the whole file in read-only mode. Empty files are
+ * valid and give a NULL data pointer with zero size.
+ * @param filename
+ * @return true if the file has been mapped
+ */
+bool MemoryMappedFile::open(const std::string &filename)
+{
+    this->close();
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+    _file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (_file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER fsize;
+    if (!GetFileSizeEx(_file, &fsize))
+    {
+        this->close();
+        return false;
+    }
+    _size = static_cast<size_t>(fsize.QuadPart);
+    if (_size > 0)
+    {
+        _mapping = CreateFileMappingA(_file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (_mapping == NULL)
+        {
+            this->close();
+            return false;
+        }
+        _data = static_cast<const char*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+        if (_data == NULL)
+        {
+            this->close();
+            return false;
+        }
+    }
+#else
+    _fd = ::open(filename.c_str(), O_RDONLY);
+    if (_fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(_fd, &st) != 0)
+    {
+        this->close();
+        return false;
+    }
+    _size = static_cast<size_t>(st.st_size);
+    if (_size > 0)
+    {
+        void *addr = mmap(NULL, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+        if (addr == MAP_FAILED)
+        {
+            this->close();
+            return false;
+        }
+        _data = static_cast<const char*>(addr);
+        // Files are always scanned front to back, let the kernel read ahead aggressively
+        madvise(addr, _size, MADV_SEQUENTIAL);
+    }
+#endif
+    _is_open = true;
+    return true;
+}
+
+/**
+ * @brief MemoryMappedFile::close Unmap the file and release the handles
+ */
+void MemoryMappedFile::close()
+{
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+    if (_data)
+        UnmapViewOfFile(_data);
+    if (_mapping)
+        CloseHandle(_mapping);
+    if (_file != INVALID_HANDLE_VALUE)
+        CloseHandle(_file);
+    _mapping = NULL;
+    _file = INVALID_HANDLE_VALUE;
+#else
+    if (_data)
+        munmap(const_cast<char*>(_data), _size);
+    if (_fd >= 0)
+        ::close(_fd);
+    _fd = -1;
+#endif
+    _data = NULL;
+    _size = 0;
+    _is_open = false;
+}
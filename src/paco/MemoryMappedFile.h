@@ -0,0 +1,96 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+
+#ifndef _MEMORY_MAPPED_FILE_H_
+#define _MEMORY_MAPPED_FILE_H_
+
+#include <string>
+#include <cstddef>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+/**
+ * @brief The MemoryMappedFile class maps a whole file read-only in the process address space.
+ * The mapping is released when the object is destroyed, hence pointers returned by data()
+ * are valid only for the lifetime of the object.
+ */
+class MemoryMappedFile
+{
+public:
+    MemoryMappedFile();
+    MemoryMappedFile(const std::string &filename);
+    ~MemoryMappedFile();
+
+    bool open(const std::string &filename);
+    void close();
+
+    const char *data() const
+    {
+        return _data;
+    }
+
+    size_t size() const
+    {
+        return _size;
+    }
+
+    bool is_open() const
+    {
+        return _is_open;
+    }
+
+private:
+    // Non copyable, the mapping is owned by a single object
+    MemoryMappedFile(const MemoryMappedFile &);
+    MemoryMappedFile& operator=(const MemoryMappedFile &);
+
+    const char *_data;
+    size_t _size;
+    bool _is_open;
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+    HANDLE _file;
+    HANDLE _mapping;
+#else
+    int _fd;
+#endif
+};
+
+#endif
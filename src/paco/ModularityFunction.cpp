@@ -45,9 +45,9 @@ void ModularityFunction::eval(const PartitionHelper *par) const
 
     if (m > 0)
     {
-        for (CommMapCIter iter=par->get_communities().begin(); iter!=par->get_communities().end(); ++iter)
+        for (CommListCIter iter=par->get_communities().begin(); iter!=par->get_communities().end(); ++iter)
         {
-            size_t c = iter->first;
+            size_t c = *iter;
             igraph_real_t a = par->get_incomm_weight().at(c)/m;
             igraph_real_t e = par->get_incomm_deg().at(c)/(2*m);
             quality += (a - e*e);
@@ -0,0 +1,82 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+#include <sstream>
+#include "OptimizerCounters.h"
+
+/**
+ * @brief OptimizerCounters::operator += Sums the counters and the times of other
+ * @param other
+ * @return
+ */
+OptimizerCounters &OptimizerCounters::operator+=(const OptimizerCounters &other)
+{
+    moves_attempted += other.moves_attempted;
+    moves_accepted += other.moves_accepted;
+    moves_reverted += other.moves_reverted;
+    quality_evaluations += other.quality_evaluations;
+    surprise_terms += other.surprise_terms;
+    cache_hits += other.cache_hits;
+    init_time += other.init_time;
+    sort_time += other.sort_time;
+    optimize_time += other.optimize_time;
+    evaluation_time += other.evaluation_time;
+    return *this;
+}
+
+/**
+ * @brief OptimizerCounters::to_json
+ * @return the counters as a JSON object, the times are in seconds
+ */
+std::string OptimizerCounters::to_json() const
+{
+    std::stringstream ss;
+    ss.precision(9);
+    ss << "{\n"
+       << "  \"moves_attempted\": " << moves_attempted << ",\n"
+       << "  \"moves_accepted\": " << moves_accepted << ",\n"
+       << "  \"moves_reverted\": " << moves_reverted << ",\n"
+       << "  \"quality_evaluations\": " << quality_evaluations << ",\n"
+       << "  \"surprise_terms\": " << surprise_terms << ",\n"
+       << "  \"cache_hits\": " << cache_hits << ",\n"
+       << "  \"time\": {\n"
+       << "    \"init\": " << init_time << ",\n"
+       << "    \"sort\": " << sort_time << ",\n"
+       << "    \"optimize\": " << optimize_time << ",\n"
+       << "    \"evaluation\": " << evaluation_time << "\n"
+       << "  }\n"
+       << "}";
+    return ss.str();
+}
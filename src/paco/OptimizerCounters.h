@@ -0,0 +1,67 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+#ifndef _OPTIMIZER_COUNTERS_H_
+#define _OPTIMIZER_COUNTERS_H_
+
+#include <string>
+#include <stdint.h>
+
+/**
+ * Counters and phase timings of an optimization, accumulated over its repetitions. They are plain
+ * increments on the hot paths, always enabled. Times are in seconds.
+ */
+struct OptimizerCounters
+{
+    uint64_t moves_attempted=0;     // vertex moves tried by the optimizers
+    uint64_t moves_accepted=0;      // moves kept because they didn't decrease the quality
+    uint64_t moves_reverted=0;      // moves undone because they decreased the quality
+    uint64_t quality_evaluations=0; // evaluations of the quality function, from the aggregates or from scratch
+    uint64_t surprise_terms=0;      // hypergeometric terms summed in the tails of Surprise
+    uint64_t cache_hits=0;          // evaluations avoided because the partition didn't change since the last one
+    double init_time=0;             // quality function, optimizer and partition aggregates
+    double sort_time=0;             // order of the edges of the agglomerative optimizer
+    double optimize_time=0;         // the moves, excluding the final evaluations
+    double evaluation_time=0;       // final quality of every repetition
+
+    void clear()
+    {
+        *this = OptimizerCounters();
+    }
+    OptimizerCounters &operator+=(const OptimizerCounters &other);
+    std::string to_json() const;
+};
+
+#endif // _OPTIMIZER_COUNTERS_H_
@@ -0,0 +1,61 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+#ifndef _OPTIMIZER_PROGRESS_H_
+#define _OPTIMIZER_PROGRESS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * State of an optimization passed to the progress callback. The quality of the partition being optimized
+ * is the last one computed by the optimizer, NaN if none has been computed yet.
+ */
+struct OptimizerProgress
+{
+    uint64_t steps=0;            // iterations of the optimizers since the start of optimize
+    size_t repetition=0;         // repetition in progress, from 0
+    size_t repetitions=0;        // repetitions requested
+    double quality=0;            // of the partition being optimized
+    double best_quality=0;       // best of the repetitions completed, NaN before the first one
+};
+
+/**
+ * Called by the optimizers every few thousands of steps, in the thread running the optimization.
+ * Returning false cancels the optimization, which returns the best partition found so far.
+ */
+typedef bool (*ProgressCallback)(const OptimizerProgress &progress, void *data);
+
+#endif // _OPTIMIZER_PROGRESS_H_
@@ -0,0 +1,286 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+#include <sstream>
+#include <vector>
+#include <thread>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+#include "PacoServer.h"
+#include "igraph_utils.h"
+
+#if !(defined(WIN32) || defined(_WIN32) || defined(__WIN32__))
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+/**
+ * @brief PacoServer::PacoServer
+ * @param cache_capacity maximum number of graphs kept in memory
+ */
+PacoServer::PacoServer(size_t cache_capacity) : cache(cache_capacity), running(false), num_connections(0)
+{
+}
+
+/**
+ * @brief PacoServer::optimize Optimizes the cached graph of filename
+ * @param budget time budget of the optimization in milliseconds, no limit if zero
+ * @return the response line
+ */
+std::string PacoServer::optimize(const std::string &filename, QualityType qual, OptimizerType method, int nrep, int seed, int budget)
+{
+    // Declared first, the graph of entry is released while it is still held
+    std::unique_lock<std::mutex> serial(igraph_mutex,std::defer_lock);
+    if (!igraph_is_thread_safe())
+        serial.lock();
+    std::shared_ptr<const CachedGraph> entry = cache.get(filename);
+    CommunityStructure comm(entry->graph.get());
+    comm.set_graph_context(entry->context);
+    comm.set_random_seed(seed);
+    comm.set_time_budget(budget);
+    double quality = comm.optimize(qual,method,nrep);
+    comm.reindex_membership();
+
+    std::stringstream ss;
+    ss.precision(15);
+    ss << "ok " << quality;
+    for (size_t v=0; v<entry->graph->number_of_nodes(); ++v)
+        ss << " " << comm.get_membership(v);
+    ss << "\n";
+    return ss.str();
+}
+
+/**
+ * @brief PacoServer::handle_request Answers a single request line
+ * @param request
+ * @return the response line, terminated by a newline
+ */
+std::string PacoServer::handle_request(const std::string &request)
+{
+    std::stringstream ss(request);
+    std::vector<std::string> args;
+    std::string token;
+    while (ss >> token)
+        args.push_back(token);
+
+    try
+    {
+        if (args.empty())
+            throw std::invalid_argument("Empty request");
+        if (args[0]=="stats" && args.size()==1)
+        {
+            std::stringstream out;
+            out << "ok " << cache.size() << " " << cache.hits() << " " << cache.misses() << "\n";
+            return out.str();
+        }
+        if (args[0]=="shutdown" && args.size()==1)
+        {
+            stop();
+            return "ok\n";
+        }
+        if (args[0]!="optimize" || args.size()<2)
+            throw std::invalid_argument("Unknown request " + args[0]);
+
+        int qual = QualitySurprise, method = MethodAgglomerative, nrep = 1, seed = -1, budget = 0;
+        for (size_t i=2; i<args.size(); ++i)
+        {
+            size_t eq = args[i].find('=');
+            if (eq==std::string::npos)
+                throw std::invalid_argument("Non valid argument " + args[i]);
+            std::string key = args[i].substr(0,eq);
+            int value = atoi(args[i].c_str()+eq+1);
+            if (key=="quality")
+                qual = value;
+            else if (key=="method")
+                method = value;
+            else if (key=="nrep")
+                nrep = value;
+            else if (key=="seed")
+                seed = value;
+            else if (key=="budget")
+                budget = value;
+            else
+                throw std::invalid_argument("Unknown argument " + key);
+        }
+        if (qual<QualitySurprise || qual>QualityInfoMap)
+            throw std::invalid_argument("Non valid quality");
+        if (method<MethodAgglomerative || method>MethodAnneal)
+            throw std::invalid_argument("Non valid method");
+        if (nrep<1)
+            throw std::invalid_argument("Non valid number of repetitions");
+        if (budget<0)
+            throw std::invalid_argument("Non valid time budget");
+        return optimize(args[1],static_cast<QualityType>(qual),static_cast<OptimizerType>(method),nrep,seed,budget);
+    }
+    catch (std::exception &e)
+    {
+        // Keep the response on a single line
+        std::string msg(e.what());
+        for (size_t i=0; i<msg.size(); ++i)
+            if (msg[i]=='\n' || msg[i]=='\r')
+                msg[i]=' ';
+        return "error " + msg + "\n";
+    }
+}
+
+/**
+ * @brief PacoServer::stop Makes serve return, after the connections being served are closed
+ */
+void PacoServer::stop()
+{
+    running = false;
+}
+
+#if !(defined(WIN32) || defined(_WIN32) || defined(__WIN32__))
+
+/**
+ * @brief PacoServer::handle_connection Answers the requests of a client until it disconnects or the server stops
+ * @param fd
+ */
+void PacoServer::handle_connection(int fd)
+{
+    std::string buffer;
+    char chunk[4096];
+    bool connected = true;
+    while (connected && running)
+    {
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        if (poll(&pfd,1,200)<=0)
+            continue;
+        ssize_t nread = read(fd,chunk,sizeof(chunk));
+        if (nread<=0)
+            break;
+        buffer.append(chunk,nread);
+        size_t eol;
+        while (connected && (eol = buffer.find('\n'))!=std::string::npos)
+        {
+            std::string response = handle_request(buffer.substr(0,eol));
+            buffer.erase(0,eol+1);
+            for (size_t sent=0; connected && sent<response.size(); )
+            {
+                ssize_t n = send(fd,response.data()+sent,response.size()-sent,MSG_NOSIGNAL);
+                connected = n>0; // else the client went away
+                sent += connected ? n : 0;
+            }
+        }
+        // What is left is an incomplete line, which can't grow without limit
+        if (connected && buffer.size()>max_request_length)
+        {
+            const std::string response("error Request too long\n");
+            send(fd,response.data(),response.size(),MSG_NOSIGNAL);
+            connected = false;
+        }
+    }
+    close(fd);
+    std::lock_guard<std::mutex> lock(connections_mutex);
+    --num_connections;
+    connections_closed.notify_all();
+}
+
+/**
+ * @brief PacoServer::serve Listens on the Unix domain socket socket_path until a shutdown request or stop.
+ * A stale socket file left by a previous server is replaced.
+ * @param socket_path
+ */
+void PacoServer::serve(const std::string &socket_path)
+{
+    struct sockaddr_un addr;
+    memset(&addr,0,sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size()>=sizeof(addr.sun_path))
+        throw std::invalid_argument("Socket path too long: " + socket_path);
+    strncpy(addr.sun_path,socket_path.c_str(),sizeof(addr.sun_path)-1);
+
+    struct stat st;
+    if (stat(socket_path.c_str(),&st)==0)
+    {
+        if (!S_ISSOCK(st.st_mode))
+            throw std::runtime_error("Error, " + socket_path + " exists and is not a socket");
+        unlink(socket_path.c_str());
+    }
+
+    int fd = socket(AF_UNIX,SOCK_STREAM,0);
+    if (fd<0)
+        throw std::runtime_error("Error, can't create socket");
+    // Only the user running the server may connect, before any connection is accepted
+    if (bind(fd,(struct sockaddr*)&addr,sizeof(addr))!=0 || chmod(socket_path.c_str(),S_IRUSR|S_IWUSR)!=0 || listen(fd,64)!=0)
+    {
+        close(fd);
+        throw std::runtime_error("Error, can't listen on " + socket_path);
+    }
+
+    running = true;
+    while (running)
+    {
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        if (poll(&pfd,1,200)<=0)
+            continue;
+        int client = accept(fd,NULL,NULL);
+        if (client>=0)
+        {
+            std::lock_guard<std::mutex> lock(connections_mutex);
+            ++num_connections;
+            std::thread(&PacoServer::handle_connection,this,client).detach();
+        }
+    }
+    close(fd);
+    unlink(socket_path.c_str());
+    std::unique_lock<std::mutex> lock(connections_mutex);
+    connections_closed.wait(lock,[this]() { return num_connections==0; });
+}
+
+#else
+
+void PacoServer::handle_connection(int fd)
+{
+}
+
+void PacoServer::serve(const std::string &socket_path)
+{
+    throw std::runtime_error("PACO server requires Unix domain sockets");
+}
+
+#endif
@@ -0,0 +1,92 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+#ifndef _PACO_SERVER_H_
+#define _PACO_SERVER_H_
+
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include "GraphCache.h"
+#include "Community.h"
+
+/**
+ * Local PACO service: optimizes graph files on request, keeping the graphs read in a GraphCache so that
+ * repeated requests on the same file skip parsing and the construction of the graph context.
+ * Requests and responses are single text lines:
+ *
+ *   optimize graph_file [quality=Q] [method=M] [nrep=R] [seed=S] [budget=milliseconds]
+ *      -> ok quality membership_0 ... membership_n-1
+ *      with budget, the best partition found when the time budget of the optimization expires
+ *   stats
+ *      -> ok cached_graphs hits misses
+ *   shutdown
+ *      -> ok, then the server stops accepting connections
+ *
+ * Any failure is answered with "error message". Requests are served concurrently, every connection
+ * by its own thread, and a connection may send any number of requests. Without a thread safe igraph the
+ * optimize requests take turns. A line longer than max_request_length is answered with an error and
+ * its connection is closed. The socket is accessible only by the user running the server.
+ */
+class PacoServer
+{
+public:
+    PacoServer(size_t cache_capacity=8);
+
+    std::string handle_request(const std::string &request);
+    void serve(const std::string &socket_path);
+    void stop();
+
+    const GraphCache &get_cache() const
+    {
+        return cache;
+    }
+
+private:
+    std::string optimize(const std::string &filename, QualityType qual, OptimizerType method, int nrep, int seed, int budget=0);
+    void handle_connection(int fd);
+
+    static const size_t max_request_length = 65536;
+
+    GraphCache cache;
+    std::atomic<bool> running;
+    size_t num_connections; // connections being served, by detached threads
+    std::mutex connections_mutex;
+    std::condition_variable connections_closed;
+    std::mutex igraph_mutex; // held by optimize if igraph isn't thread safe
+};
+
+#endif // _PACO_SERVER_H_
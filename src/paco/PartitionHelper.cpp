@@ -55,6 +55,9 @@ PartitionHelper::PartitionHelper()
     num_comms = 0;
 
     curmemb = NULL;
+    ig = NULL;
+    degrees = &all_degrees;
+    strenghts = &all_strenght;
 }
 
 /**
@@ -66,77 +69,178 @@ PartitionHelper::~PartitionHelper()
     igraph_vector_destroy(&all_strenght);
 }
 
+/**
+ * @brief PartitionHelper::init Initializes the helper from a real-valued igraph membership,
+ * which is converted to an internally owned compact copy.
+ * @param graph
+ * @param memb
+ * @param weights
+ */
+void PartitionHelper::init(const igraph_t*graph, const igraph_vector_t *memb, const EdgeWeights &weights)
+{
+    membership_from_igraph(memb,owned_memb);
+    this->init(graph,&owned_memb,weights);
+}
+
 /**
  * @brief PartitionHelper::init
  * @param graph
  * @param reind_memb
  * @param weights
  */
-void PartitionHelper::init(const igraph_t*graph, const igraph_vector_t *memb, const igraph_vector_t *weights)
+void PartitionHelper::init(const igraph_t*graph, const Membership *memb, const EdgeWeights &weights)
 {
     this->ig = graph;
-    this->communities.clear();
-    this->incomm_deg.clear();
-    this->incomm_nvert.clear();
-    this->incomm_pairs.clear();
-    this->incomm_weight.clear();
-    this->graph_total_pairs = 0;
-    this->graph_total_weight = 0;
-    this->num_comms = 0;
-    this->total_incomm_pairs = 0;
-    this->total_incomm_weight = 0;
-
-    this->curmemb = memb;
-
+    this->context.reset();
     this->num_edges = igraph_ecount(graph);
-    igraph_real_t m=num_edges;
-
     this->num_vertices = igraph_vcount(graph);
-    this->graph_total_pairs = num_vertices*(num_vertices-1)/2;
-    this->graph_total_weight = m;
 
-    if ( igraph_vector_size(memb) < num_vertices )
+    if ( memb->size() < static_cast<size_t>(num_vertices) )
     {
         throw std::logic_error("Cannot calculate modularity, inconsistent membership vector length");
     }
 
     igraph_vector_resize(&all_degrees,num_vertices);
     igraph_degree(graph,&all_degrees,igraph_vss_all(),IGRAPH_TOTAL,false);
-    // Compute the vector strenghts
+    // Compute the vector strenghts, single precision weights are accumulated in the edges loop of init_partition
     igraph_vector_resize(&all_strenght,num_vertices);
-    igraph_strength(graph,&all_strenght,igraph_vss_all(),IGRAPH_TOTAL,false,weights);
+    if (weights.is_single_precision())
+        igraph_vector_null(&all_strenght);
+    else
+        igraph_strength(graph,&all_strenght,igraph_vss_all(),IGRAPH_TOTAL,false,weights.igraph_vector());
+    this->degrees = &all_degrees;
+    this->strenghts = &all_strenght;
 
-    this->fill_communities(memb);
+    this->init_partition(memb,weights,weights.is_single_precision());
+}
 
-    // Initialize STL map containers with zeros except for sincomm_nvertices,sincomm_pairs with number of vertices/pairs
-    for (CommMapCIter it = communities.begin(); it!=communities.end(); ++it)
+/**
+ * @brief PartitionHelper::init Initializes the helper on a shared graph context, whose degrees,
+ * strengths and CSR adjacency are used instead of being recomputed. Only the partition dependent
+ * state is owned by the helper.
+ * @param ctx
+ * @param memb
+ * @param weights the weights of the context, or empty to consider the graph unweighted
+ */
+void PartitionHelper::init(const std::shared_ptr<const GraphContext> &ctx, const Membership *memb, const EdgeWeights &weights)
+{
+    this->context = ctx;
+    this->ig = ctx->get_igraph();
+    this->num_edges = ctx->number_of_edges();
+    this->num_vertices = ctx->number_of_nodes();
+
+    if ( memb->size() < static_cast<size_t>(num_vertices) )
+    {
+        throw std::logic_error("Cannot calculate modularity, inconsistent membership vector length");
+    }
+
+    this->degrees = ctx->get_degrees();
+    this->strenghts = ctx->get_strenghts();
+
+    this->init_partition(memb,weights,false);
+}
+
+/**
+ * @brief PartitionHelper::reset Resets the partition to memb on the graph of the last call to init,
+ * keeping its degrees and strenghts. The community buffers of the previous partitions are reused, so
+ * that no heap allocation happens as long as the community ids fit the ones seen before.
+ * @param memb
+ * @param weights the same weights passed to init
+ */
+void PartitionHelper::reset(const Membership *memb, const EdgeWeights &weights)
+{
+    if (ig==NULL)
+        throw std::logic_error("PartitionHelper::reset called before PartitionHelper::init");
+    if ( memb->size() < static_cast<size_t>(num_vertices) )
     {
-        size_t c = it->first;
-        incomm_weight[c]=0;
-        incomm_deg[c]=0;
-        incomm_nvert[c]=it->second.size();
-        incomm_pairs[c]=num_pairs(it->second.size());
+        throw std::logic_error("Cannot calculate modularity, inconsistent membership vector length");
+    }
+    this->init_partition(memb,weights,false);
+}
+
+/**
+ * @brief PartitionHelper::update_graph Moves the helper to the context of the edited graph, updating the
+ * community aggregates of the current membership in O(changes) instead of recomputing them.
+ * The membership must be the one of the helper, the graph must have the same vertices and the helper must be
+ * initialized on a context. Sums updated by differences may differ from recomputed ones by rounding.
+ * @param ctx context of the graph after the edits
+ * @param changes weight changes of the edited edges, as returned by GraphC::apply_edits
+ */
+void PartitionHelper::update_graph(const std::shared_ptr<const GraphContext> &ctx, const std::vector<EdgeChange> &changes)
+{
+    if (!context || curmemb==NULL)
+        throw std::logic_error("PartitionHelper::update_graph needs an helper initialized on a graph context");
+    if (ctx->number_of_nodes()!=num_vertices)
+        throw std::logic_error("Edited graph has a different number of vertices");
+
+    this->context = ctx;
+    this->ig = ctx->get_igraph();
+    this->num_edges = ctx->number_of_edges();
+    this->degrees = ctx->get_degrees();
+    this->strenghts = ctx->get_strenghts();
+    this->graph_total_weight = ctx->get_total_weight();
+
+    for (size_t i=0; i<changes.size(); ++i)
+    {
+        size_t c1 = (*curmemb)[changes[i].source];
+        size_t c2 = (*curmemb)[changes[i].target];
+        double dw = changes[i].delta;
+        if (c1==c2)
+        {
+            incomm_weight[c1] += dw;
+            total_incomm_weight += dw;
+        }
+        incomm_deg[c1] += dw;
+        incomm_deg[c2] += dw;
     }
+}
+
+/**
+ * @brief PartitionHelper::init_partition Fills the communities and their aggregates
+ * @param memb
+ * @param weights
+ * @param sum_strenghts whether to accumulate the vertex strenghts in all_strenght
+ */
+void PartitionHelper::init_partition(const Membership *memb, const EdgeWeights &weights, bool sum_strenghts)
+{
+    this->num_comms = 0;
+    this->total_incomm_pairs = 0;
+    this->total_incomm_weight = 0;
+
+    this->curmemb = memb;
+
+    igraph_real_t m=num_edges;
+    this->graph_total_pairs = num_pairs(num_vertices);
+    this->graph_total_weight = m;
+
+    // Fills incomm_nvert and incomm_pairs with number of vertices/pairs, the other aggregates with zeros
+    this->fill_communities(memb);
 
     // Fill sincomm_weight and sincomm_degree
     igraph_integer_t from=0;
     igraph_integer_t to=0;
     size_t c1=0;
     size_t c2=0;
+    const uint32_t *endpoints = context ? context->edges() : NULL;
 
     if (weights)
     {
-        if (igraph_vector_size(weights) != m)
+        if (weights.size() != m)
             throw std::logic_error("Weights vector != number of edges");
-        graph_total_weight = igraph_vector_sum(weights);
+        graph_total_weight = weights.sum();
         for (size_t ei=0; ei<m; ei++)
         {
-            igraph_real_t w = weights->stor_begin[ei];
+            igraph_real_t w = weights[ei];
             if (w < 0)
                 throw std::logic_error("Negative weight in weight vector");
-            igraph_edge(graph, (igraph_integer_t) ei, &from, &to);
-            c1=(size_t) memb->stor_begin[from];
-            c2=(size_t) memb->stor_begin[to];
+            edge_endpoints(endpoints, ei, &from, &to);
+            if (sum_strenghts && from!=to) // as igraph_strength without loops
+            {
+                VECTOR(all_strenght)[from] += w;
+                VECTOR(all_strenght)[to] += w;
+            }
+            c1=(*memb)[from];
+            c2=(*memb)[to];
             if (c1==c2)
             {
                 incomm_weight[c1]+=w;
@@ -150,9 +254,9 @@ void PartitionHelper::init(const igraph_t*graph, const igraph_vector_t *memb, co
     {
         for (size_t ei=0; ei<m; ei++)
         {
-            igraph_edge(graph, (igraph_integer_t) ei, &from, &to);
-            c1=(size_t) memb->stor_begin[from];
-            c2=(size_t) memb->stor_begin[to];
+            edge_endpoints(endpoints, ei, &from, &to);
+            c1=(*memb)[from];
+            c2=(*memb)[to];
             if (c1==c2)
             {
                 incomm_weight[c1]+=1.0;
@@ -164,7 +268,8 @@ void PartitionHelper::init(const igraph_t*graph, const igraph_vector_t *memb, co
     }
 
     // Sum total intracluster pairs
-    total_incomm_pairs = mapvalue_sum<size_t>(incomm_pairs);
+    for (CommListCIter it = communities.begin(); it!=communities.end(); ++it)
+        total_incomm_pairs += incomm_pairs[*it];
     //total_incomm_weight = mapvalue_sum<double>(incomm_weight); //already computed
 }
 
@@ -173,25 +278,72 @@ void PartitionHelper::init(const igraph_t*graph, const igraph_vector_t *memb, co
  * @param memb
  * @return
  */
-void PartitionHelper::fill_communities(const igraph_vector_t *memb)
+void PartitionHelper::fill_communities(const Membership *memb)
 {
-    size_t mlen = igraph_vector_size(memb);
-    for (size_t c=0; c < mlen; c++)
-        communities[memb->stor_begin[c]].insert(c); // insert node c into community memb[c]
+    size_t mlen = memb->size();
+    // Community ids are expected to be smaller than the number of vertices, as in a reindexed membership
+    size_t nslots = mlen;
+    for (size_t v=0; v < mlen; v++)
+        nslots = std::max<size_t>(nslots,(*memb)[v]+1);
+
+    // assign keeps the capacity of the buffers, so they are only reallocated when nslots grows
+    incomm_nvert.assign(nslots,0);
+    incomm_pairs.assign(nslots,0);
+    incomm_weight.assign(nslots,0);
+    incomm_deg.assign(nslots,0);
+    comm_exists.assign(nslots,0);
+    communities.clear();
+    communities.reserve(nslots);
+
+    for (size_t v=0; v < mlen; v++)
+        incomm_nvert[(*memb)[v]]++; // count node v in community memb[v]
+
+    for (size_t c=0; c < nslots; c++)
+    {
+        if (incomm_nvert[c]>0)
+        {
+            comm_exists[c] = 1;
+            communities.push_back(c);
+            incomm_pairs[c] = num_pairs(incomm_nvert[c]);
+        }
+    }
 
     this->num_comms = (igraph_integer_t)communities.size();
 }
 
+/**
+ * @brief PartitionHelper::add_community Creates the empty community comm, keeping the ids in communities sorted
+ * @param comm
+ */
+void PartitionHelper::add_community(size_t comm)
+{
+    if (comm >= comm_exists.size())
+    {
+        incomm_nvert.resize(comm+1,0);
+        incomm_pairs.resize(comm+1,0);
+        incomm_weight.resize(comm+1,0);
+        incomm_deg.resize(comm+1,0);
+        comm_exists.resize(comm+1,0);
+    }
+    comm_exists[comm] = 1;
+    communities.insert(std::lower_bound(communities.begin(),communities.end(),comm),comm);
+    this->num_comms = (igraph_integer_t)communities.size();
+}
+
 /**
  * @brief PartitionHelper::reindex
  * @param memb
  */
-void PartitionHelper::reindex(const igraph_vector_t *memb)
+void PartitionHelper::reindex(Membership *memb)
 {
-    IGRAPH_TRY(igraph_reindex_membership(const_cast<igraph_vector_t *>(memb),NULL));
-    int minC = igraph_vector_min(memb)-1; // so to start from 1 to |C| included
-    for (long int i=0; i<igraph_vector_size(memb); ++i)
-        memb->stor_begin[i] -= minC;
+    igraph_vector_t m;
+    IGRAPH_TRY(igraph_vector_init(&m,0));
+    membership_to_igraph(*memb,&m);
+    IGRAPH_TRY(igraph_reindex_membership(&m,NULL));
+    int minC = igraph_vector_min(&m)-1; // so to start from 1 to |C| included
+    for (long int i=0; i<igraph_vector_size(&m); ++i)
+        (*memb)[i] = VECTOR(m)[i] - minC;
+    igraph_vector_destroy(&m);
 }
 
 /**
@@ -200,11 +352,11 @@ void PartitionHelper::reindex(const igraph_vector_t *memb)
  * @param vert
  * @return
  */
-inline size_t PartitionHelper::get_membership(const igraph_vector_t *memb, int vert) const
+inline size_t PartitionHelper::get_membership(const Membership *memb, int vert) const
 {
     if (vert >= num_vertices)
         throw std::range_error("Error indexing vertex");
-    return memb->stor_begin[vert];
+    return (*memb)[vert];
 }
 
 /**
@@ -214,10 +366,7 @@ inline size_t PartitionHelper::get_membership(const igraph_vector_t *memb, int v
  */
 inline bool PartitionHelper::check_comm(int dest_comm)
 {
-    if (communities.count(dest_comm) == 0)
-        return false;
-    else
-        return true;
+    return dest_comm >= 0 && static_cast<size_t>(dest_comm) < comm_exists.size() && comm_exists[dest_comm];
 }
 
 /**
@@ -229,32 +378,19 @@ inline bool PartitionHelper::check_comm(int dest_comm)
  * @param weights
  * @return
  */
-bool PartitionHelper::move_vertex(const igraph_t *g, const igraph_vector_t * memb, int source, size_t dest_comm, const igraph_vector_t *weights)
+bool PartitionHelper::move_vertex(const igraph_t *g, Membership *memb, int source, size_t dest_comm, const EdgeWeights &weights)
 {
     size_t source_comm = get_membership(memb,source);
     if (source_comm==dest_comm)
         return false; // do nothing because same community
 
+    // if dest_comm does not exist, then create an empty dest_comm
     if (!check_comm(dest_comm))
-    {
-        // if dest_comm does not exist, then create an empty dest_comm
-        communities[dest_comm] = std::set<size_t>();
-        incomm_deg[dest_comm] = 0;
-        incomm_nvert[dest_comm] = 0;
-        incomm_weight[dest_comm] = 0;
-        incomm_pairs[dest_comm] = 0;
-    }
+        add_community(dest_comm);
 
-    // Update community vector, remove vertex "source" from its original community
-    if (communities.at(source_comm).find(source) != communities.at(source_comm).end())
-        communities.at(source_comm).erase(source);
-    else // if it's not in its original community then throw error
+    // The vertex must belong to a community known to the helper, i.e. memb is the initialized membership
+    if (!check_comm(source_comm) || incomm_nvert[source_comm]==0)
         throw std::logic_error("Vertex not found in source community");
-    // and then add it to the destination community if it is not
-    if (communities.at(dest_comm).find(source) == communities.at(dest_comm).end() )
-        communities.at(dest_comm).insert(source);
-    else // if it's already in the destination community, then throw error
-        throw std::logic_error("Vertex already in destination community");
 
     // Compute the number of neighbors that vertex source has in its original community
     double w_in = weight_to_from_community(g,memb,source,source_comm,IGRAPH_ALL,weights);
@@ -267,8 +403,8 @@ bool PartitionHelper::move_vertex(const igraph_t *g, const igraph_vector_t * mem
     // Update community num_vertices after movement of vertex source to dest_comm
     size_t old_n_source = incomm_nvert.at(source_comm);
     size_t old_n_dest = incomm_nvert.at(dest_comm);
-    int old_p_source = num_pairs(old_n_source);
-    int old_p_dest = num_pairs(old_n_dest); // important to use int otherwise values are casted and -1 in pairs doesn't work
+    int64_t old_p_source = num_pairs(old_n_source);
+    int64_t old_p_dest = num_pairs(old_n_dest); // important to use a signed type otherwise values are casted and -1 in pairs doesn't work
 
     incomm_nvert.at(source_comm) -= 1;//communities.at(source_comm).size(); // this is faster that set.size()
     incomm_nvert.at(dest_comm) +=1;// communities.at(dest_comm).size();
@@ -281,11 +417,11 @@ bool PartitionHelper::move_vertex(const igraph_t *g, const igraph_vector_t * mem
     this->total_incomm_weight += w_to - w_in;
 
     // Update total intracluster pairs, by computing delta_num_pairs for move_vertex
-    int deltap = ( incomm_pairs.at(dest_comm)-old_p_source) + (incomm_pairs.at(source_comm)-old_p_dest);
+    int64_t deltap = ( incomm_pairs.at(dest_comm)-old_p_source) + (incomm_pairs.at(source_comm)-old_p_dest);
     total_incomm_pairs += deltap;
 
     // Finally do the movement!
-    memb->stor_begin[source] = dest_comm;
+    (*memb)[source] = dest_comm;
     // Assign current membership pointer
     this->curmemb = memb;
     return true;
@@ -300,7 +436,7 @@ bool PartitionHelper::move_vertex(const igraph_t *g, const igraph_vector_t * mem
  * @param weights
  * @return
  */
-bool PartitionHelper::merge_communities(const igraph_t *g, const igraph_vector_t *memb, size_t source_comm, size_t dest_comm, const igraph_vector_t *weights)
+bool PartitionHelper::merge_communities(const igraph_t *g, Membership *memb, size_t source_comm, size_t dest_comm, const EdgeWeights &weights)
 {
     if (source_comm==dest_comm)
         return false; // do nothing because same community
@@ -308,11 +444,10 @@ bool PartitionHelper::merge_communities(const igraph_t *g, const igraph_vector_t
     if (!check_comm(dest_comm))
         throw std::runtime_error("Non existing destination community");
 
-    set<size_t>::const_iterator it = communities.at(source_comm).begin();
-    while (it!=communities.at(source_comm).end())
+    for (size_t v=0; v<memb->size(); ++v)
     {
-        size_t v = *(it++);
-        move_vertex(g,memb,v,dest_comm,weights);
+        if ((*memb)[v]==source_comm)
+            move_vertex(g,memb,v,dest_comm,weights);
     }
     return true;
 }
@@ -325,7 +460,7 @@ bool PartitionHelper::merge_communities(const igraph_t *g, const igraph_vector_t
  * @param weights
  * @return
  */
-bool PartitionHelper::split_community(const igraph_t *g, const igraph_vector_t *memb, size_t comm, const igraph_vector_t *weights)
+bool PartitionHelper::split_community(const igraph_t *g, Membership *memb, size_t comm, const EdgeWeights &weights)
 {
     return false;
 }
@@ -340,16 +475,35 @@ bool PartitionHelper::split_community(const igraph_t *g, const igraph_vector_t *
  * @param weights
  * @return
  */
-const double PartitionHelper::weight_to_from_community(const igraph_t *g, const igraph_vector_t *memb, size_t v, size_t comm, igraph_neimode_t mode, const igraph_vector_t *weights)
+const double PartitionHelper::weight_to_from_community(const igraph_t *g, const Membership *memb, size_t v, size_t comm, igraph_neimode_t mode, const EdgeWeights &weights)
 {
     if (weights)
     {
-        if (igraph_vector_size(weights) != igraph_ecount(g))
+        if (weights.size() != static_cast<size_t>(igraph_ecount(g)))
             throw std::logic_error("Weights vector != number of edges");
     }
 
     double total_w = 0.0;
-    size_t degree = all_degrees.stor_begin[v];
+    if (context)
+    {
+        // Scan the CSR row of v in the shared context, without any allocation
+        const uint64_t *offsets = context->offsets();
+        const uint32_t *neighbors = context->neighbors();
+        const uint32_t *adj_edges = context->adj_edges();
+        for (uint64_t k = offsets[v]; k < offsets[v+1]; ++k)
+        {
+            if ( (*memb)[neighbors[k]] == comm)
+            {
+                if (weights)
+                    total_w += weights[adj_edges[k]];
+                else
+                    total_w += 1;
+            }
+        }
+        return total_w;
+    }
+
+    size_t degree = VECTOR(*degrees)[v];
     igraph_vector_t incident_edges;
     igraph_vector_t neighbours;
     igraph_vector_init(&incident_edges, degree);
@@ -365,7 +519,7 @@ const double PartitionHelper::weight_to_from_community(const igraph_t *g, const
         {
             size_t e = VECTOR(incident_edges)[i];
             if (weights)
-                total_w += weights->stor_begin[e];
+                total_w += weights[e];
             else
                 total_w += 1;
         }
@@ -386,21 +540,23 @@ void PartitionHelper::print() const
 
     printf(ANSI_COLOR_BLUE);
     printf("Membership:\n");
-    igraph_vector_print(curmemb);
+    for (size_t i=0; i<curmemb->size(); ++i)
+        printf(i+1<curmemb->size() ? "%u " : "%u\n",(*curmemb)[i]);
 
     printf(ANSI_COLOR_YELLOW);
     printf("________________________________________________\n");
     printf("c\twc\tnc\tpc\t{vi...}\n________________________________________________\n");
-    for (CommMapCIter it = communities.begin(); it!=communities.end(); ++it)
+    for (CommListCIter it = communities.begin(); it!=communities.end(); ++it)
     {
-        size_t c = it->first;
-        if (it->second.empty())
+        size_t c = *it;
+        if (incomm_nvert.at(c)==0)
             continue;
 
         printf("%zu\t%.2f\t%zu\t%zu\t{",c,incomm_weight.at(c),incomm_nvert.at(c),incomm_pairs.at(c));
-        for ( std::set<size_t>::const_iterator it2 = communities.at(c).begin(); it2!=communities.at(c).end(); ++it2)
+        for (size_t v=0; v<curmemb->size(); ++v)
         {
-            printf("%zu,",*it2);
+            if ((*curmemb)[v]==c)
+                printf("%zu,",v);
         }
         printf("}\n");
     }
@@ -413,15 +569,20 @@ void PartitionHelper::print() const
  */
 void PartitionHelper::print_membership(std::ostream &out)
 {
-    igraph_vector_t *newmemb = order_membership(curmemb);
+    // Communities are numbered in order of first appearance
+    std::map<uint32_t,uint32_t> group_map;
     out << "[";
     for (igraph_integer_t i=0; i<num_vertices; ++i)
     {
-        out << newmemb->stor_begin[i];
+        uint32_t c = (*curmemb)[i];
+        if (group_map.count(c)==0)
+        {
+            uint32_t next = group_map.size();
+            group_map[c] = next;
+        }
+        out << group_map[c];
         if (i<num_vertices-1)
             out << ", ";
     }
     out << "]" << endl;
-    igraph_vector_destroy(newmemb);
-    delete newmemb;
 }
@@ -40,12 +40,13 @@
 #include <algorithm> // for std::count
 #include <igraph.h>
 #include "Common.h"
+#include "EdgeWeights.h"
+#include "GraphContext.h"
+#include "GraphEdits.h"
 
-typedef map<size_t,size_t> SizeTMap;
-typedef map<size_t,double> DoubleMap;
-typedef map<size_t, set<size_t> > CommMap;
-typedef map<size_t, set<size_t> >::iterator CommMapIter;
-typedef map<size_t, set<size_t> >::const_iterator CommMapCIter;
+// Ids of the existing communities, in increasing order
+typedef std::vector<size_t> CommList;
+typedef CommList::const_iterator CommListCIter;
 
 
 class PartitionHelper
@@ -54,17 +55,22 @@ public:
     PartitionHelper();
     ~PartitionHelper();
 
-    void init(const igraph_t*g, const igraph_vector_t *memb, const igraph_vector_t *weights=NULL);
-    bool move_vertex(const igraph_t *g, const igraph_vector_t *memb, int vert, size_t dest_comm, const igraph_vector_t *weights=NULL);
-    bool merge_communities(const igraph_t *g, const igraph_vector_t *memb, size_t source_comm, size_t dest_comm, const igraph_vector_t *weights=NULL);
-    bool split_community(const igraph_t *g, const igraph_vector_t *memb, size_t comm, const igraph_vector_t *weights=NULL);
-    inline size_t get_membership(const igraph_vector_t *memb, int vert) const;
-    void reindex(const igraph_vector_t *memb);
+    void init(const igraph_t*g, const Membership *memb, const EdgeWeights &weights=EdgeWeights());
+    void init(const igraph_t*g, const igraph_vector_t *memb, const EdgeWeights &weights=EdgeWeights());
+    void init(const std::shared_ptr<const GraphContext> &ctx, const Membership *memb, const EdgeWeights &weights=EdgeWeights());
+    void reset(const Membership *memb, const EdgeWeights &weights=EdgeWeights());
+    void update_graph(const std::shared_ptr<const GraphContext> &ctx, const std::vector<EdgeChange> &changes);
+    bool move_vertex(const igraph_t *g, Membership *memb, int vert, size_t dest_comm, const EdgeWeights &weights=EdgeWeights());
+    bool merge_communities(const igraph_t *g, Membership *memb, size_t source_comm, size_t dest_comm, const EdgeWeights &weights=EdgeWeights());
+    bool split_community(const igraph_t *g, Membership *memb, size_t comm, const EdgeWeights &weights=EdgeWeights());
+    inline size_t get_membership(const Membership *memb, int vert) const;
+    const double weight_to_from_community(const igraph_t *g, const Membership *memb, size_t v, size_t comm, igraph_neimode_t mode, const EdgeWeights &weights=EdgeWeights());
+    void reindex(Membership *memb);
     void print() const;
     void print_membership(std::ostream &out);
 
 
-    const double& get_graph_total_pairs() const
+    int64_t get_graph_total_pairs() const
     {
         return graph_total_pairs;
     }
@@ -74,7 +80,7 @@ public:
         return graph_total_weight;
     }
 
-    const double& get_total_incomm_pairs() const
+    int64_t get_total_incomm_pairs() const
     {
         return total_incomm_pairs;
     }
@@ -96,7 +102,12 @@ public:
 
     const igraph_vector_t* get_all_degrees() const
     {
-        return &all_degrees;
+        return degrees;
+    }
+
+    const igraph_vector_t* get_all_strenghts() const
+    {
+        return strenghts;
     }
 
     size_t get_num_comms() const
@@ -104,58 +115,81 @@ public:
         return num_comms;
     }
 
-    const SizeTMap &get_incomm_nvert() const
+    const std::vector<size_t> &get_incomm_nvert() const
     {
         return incomm_nvert;
     }
 
-    const DoubleMap &get_incomm_weight() const
+    const std::vector<double> &get_incomm_weight() const
     {
         return incomm_weight;
     }
 
-    const SizeTMap &get_incomm_pairs() const
+    const std::vector<int64_t> &get_incomm_pairs() const
     {
         return incomm_pairs;
     }
 
-    const DoubleMap &get_incomm_deg() const
+    const std::vector<double> &get_incomm_deg() const
     {
         return incomm_deg;
     }
 
-    const CommMap& get_communities() const
+    const CommList& get_communities() const
     {
         return communities;
     }
 
+    const std::shared_ptr<const GraphContext> &get_graph_context() const
+    {
+        return context;
+    }
+
 
 protected:
     igraph_vector_t all_degrees;
     igraph_vector_t all_strenght;
-
-    SizeTMap incomm_nvert;
-    SizeTMap incomm_pairs;
-    DoubleMap incomm_weight;
-    DoubleMap incomm_deg;
-
-    const igraph_vector_t *curmemb;
-
-    CommMap communities;
+    // Degrees and strenghts in use, either the two vectors above or those of the shared context
+    const igraph_vector_t *degrees;
+    const igraph_vector_t *strenghts;
+    std::shared_ptr<const GraphContext> context;
+
+    // Community aggregates indexed by community id, their buffers are kept from one init to the next
+    std::vector<size_t> incomm_nvert;
+    std::vector<int64_t> incomm_pairs;
+    std::vector<double> incomm_weight;
+    std::vector<double> incomm_deg;
+    std::vector<char> comm_exists;
+
+    const Membership *curmemb;
+    Membership owned_memb; // compact copy of an igraph membership passed to init
+
+    CommList communities;
     igraph_integer_t num_comms;
     igraph_integer_t num_vertices;    // number of vertices
     igraph_integer_t num_edges; // number of edges
     double total_incomm_weight; // sum of all edge weights inside communities
-    double total_incomm_pairs;  // sum of all vertex pairs inside communities
+    int64_t total_incomm_pairs;  // sum of all vertex pairs inside communities
 
     double graph_total_weight; // number of edges
-    double graph_total_pairs; // // n*(n-1)/2, number of total graph vertex pairs
+    int64_t graph_total_pairs; // n*(n-1)/2, number of total graph vertex pairs
 
 private:
     const igraph_t *ig;
     inline bool check_comm(int dest_comm);
-    void fill_communities(const igraph_vector_t *memb);
-    const double weight_to_from_community(const igraph_t *g, const igraph_vector_t* memb, size_t v, size_t comm, igraph_neimode_t mode, const igraph_vector_t *weights=NULL);
+    void init_partition(const Membership *memb, const EdgeWeights &weights, bool sum_strenghts);
+    inline void edge_endpoints(const uint32_t *endpoints, size_t e, igraph_integer_t *from, igraph_integer_t *to) const
+    {
+        if (endpoints)
+        {
+            *from = endpoints[2*e];
+            *to = endpoints[2*e+1];
+        }
+        else
+            igraph_edge(ig, (igraph_integer_t) e, from, to);
+    }
+    void fill_communities(const Membership *memb);
+    void add_community(size_t comm);
 };
 
 
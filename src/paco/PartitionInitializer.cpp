@@ -0,0 +1,299 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <thread>
+#include <limits>
+#include <cmath>
+#include "PartitionInitializer.h"
+#include "igraph_utils.h"
+#include "Trace.h"
+
+/**
+ * @brief SingletonInitializer::initialize
+ * @param ctx
+ * @param memb
+ * @param rng
+ */
+void SingletonInitializer::initialize(const GraphContext &ctx, Membership *memb, igraph_rng_t *rng) const
+{
+    const size_t n = ctx.number_of_nodes();
+    memb->resize(n);
+    for (size_t v=0; v<n; ++v)
+        (*memb)[v] = v;
+}
+
+/**
+ * @brief RandomInitializer::initialize
+ * @param ctx
+ * @param memb
+ * @param rng
+ */
+void RandomInitializer::initialize(const GraphContext &ctx, Membership *memb, igraph_rng_t *rng) const
+{
+    const size_t n = ctx.number_of_nodes();
+    if (k==0)
+        throw std::logic_error("Number of random initial communities must be positive");
+    const size_t ncomms = std::min(k,n);
+    memb->resize(n);
+    for (size_t v=0; v<n; ++v)
+        (*memb)[v] = igraph_rng_get_integer(rng,0,ncomms-1);
+}
+
+/**
+ * @brief FileInitializer::initialize
+ * @param ctx
+ * @param memb
+ * @param rng
+ */
+void FileInitializer::initialize(const GraphContext &ctx, Membership *memb, igraph_rng_t *rng) const
+{
+    std::ifstream membership_file(filename.c_str());
+    if (!membership_file.good())
+        throw std::runtime_error(std::string("File not found"));
+
+    std::string line;
+    std::vector<igraph_real_t> vmemb;
+    while ( getline(membership_file,line) )
+    {
+        if (line.size() == 0)
+            continue;
+        std::stringstream str(line);
+        igraph_real_t c;
+        if (!(str >> c) || c<0 || c!=std::floor(c) || c>std::numeric_limits<uint32_t>::max())
+            throw std::runtime_error("Error loading membership file. Community ids must be non negative integers.");
+        vmemb.push_back(c);
+    }
+    if (vmemb.size() != static_cast<size_t>(ctx.number_of_nodes()))
+        throw std::runtime_error("Error loading membership file. Vertex number not consistent with current graph.");
+
+    igraph_vector_t view;
+    igraph_vector_view(&view,vmemb.data(),vmemb.size());
+    membership_from_igraph(&view,*memb);
+    // The ids of the file may be anything, the optimizers need them smaller than the number of vertices
+    renumber_first_appearance(memb);
+}
+
+/**
+ * @brief MembershipInitializer::initialize
+ * @param ctx
+ * @param memb
+ * @param rng
+ */
+void MembershipInitializer::initialize(const GraphContext &ctx, Membership *memb, igraph_rng_t *rng) const
+{
+    const size_t n = ctx.number_of_nodes();
+    if (membership.size()!=n)
+        throw std::logic_error("Membership size not consistent with current graph");
+    for (size_t v=0; v<n; ++v)
+    {
+        if (membership[v]>=n)
+            throw std::logic_error("Community ids must be smaller than the number of vertices");
+    }
+    *memb = membership;
+}
+
+/**
+ * Scores of the labels around a single vertex, in an open addressing table with room for twice its degree,
+ * so that every thread of a sweep needs memory for its largest degree rather than for all the labels.
+ */
+struct LabelScores
+{
+    static const uint32_t empty = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> labels; // of the slots, empty if free
+    std::vector<double> scores;
+    std::vector<size_t> used;     // slots in order of first insertion
+    size_t mask;
+
+    LabelScores() : mask(0) {}
+
+    /**
+     * @brief reserve Makes room for the labels of a vertex with degree neighbors, the table must be clear
+     */
+    void reserve(size_t degree)
+    {
+        size_t size = 16;
+        while (size<2*degree)
+            size *= 2;
+        if (size>labels.size())
+        {
+            labels.assign(size,empty);
+            scores.assign(size,0);
+        }
+        mask = labels.size()-1;
+    }
+
+    void add(uint32_t label, double w)
+    {
+        size_t i = mix64(label) & mask;
+        while (labels[i]!=empty && labels[i]!=label)
+            i = (i+1) & mask;
+        if (labels[i]==empty)
+        {
+            labels[i] = label;
+            scores[i] = 0;
+            used.push_back(i);
+        }
+        scores[i] += w;
+    }
+
+    double get(uint32_t label) const
+    {
+        for (size_t i = mix64(label) & mask; labels[i]!=empty; i = (i+1) & mask)
+            if (labels[i]==label)
+                return scores[i];
+        return 0;
+    }
+
+    void clear()
+    {
+        for (size_t k=0; k<used.size(); ++k)
+            labels[used[k]] = empty;
+        used.clear();
+    }
+};
+
+const uint32_t LabelScores::empty;
+
+/**
+ * @brief label_propagation_sweep Computes the new labels of the vertices in [begin,end) from the labels cur
+ * @param ctx
+ * @param cur labels of the previous sweep
+ * @param next new labels
+ * @param score scratch table of the thread, clear, left clear
+ * @param seed
+ * @param iter
+ * @param begin
+ * @param end
+ * @return the number of vertices whose label is not yet the best one
+ */
+static size_t label_propagation_sweep(const GraphContext &ctx, const Membership &cur, Membership &next, LabelScores &score, uint64_t seed, size_t iter, size_t begin, size_t end)
+{
+    const uint64_t *offsets = ctx.offsets();
+    const uint32_t *neighbors = ctx.neighbors();
+    const uint32_t *adj_edges = ctx.adj_edges();
+    const EdgeWeights &weights = ctx.get_weights();
+    size_t nunstable = 0;
+    for (size_t v=begin; v<end; ++v)
+    {
+        next[v] = cur[v];
+        score.reserve(offsets[v+1]-offsets[v]);
+        for (uint64_t k=offsets[v]; k<offsets[v+1]; ++k)
+        {
+            uint32_t u = neighbors[k];
+            if (u==v)
+                continue;
+            score.add(cur[u],weights ? weights[adj_edges[k]] : 1.0);
+        }
+        if (score.used.empty())
+            continue;
+
+        // The current label wins the ties, the others are broken by the hash of the label
+        uint32_t best = cur[v];
+        double best_score = score.get(best);
+        uint64_t best_hash = mix64(seed ^ best);
+        for (size_t i=0; i<score.used.size(); ++i)
+        {
+            uint32_t l = score.labels[score.used[i]];
+            double s = score.scores[score.used[i]];
+            uint64_t h = mix64(seed ^ l);
+            if (s > best_score || (s==best_score && best!=cur[v] && h<best_hash))
+            {
+                best = l;
+                best_score = s;
+                best_hash = h;
+            }
+        }
+        score.clear();
+
+        if (best != cur[v])
+        {
+            ++nunstable;
+            if (mix64(seed + iter*0x632BE59BD9B4E019ULL + v) & 1) // update only half of the vertices
+                next[v] = best;
+        }
+    }
+    return nunstable;
+}
+
+/**
+ * @brief LabelPropagationInitializer::initialize
+ * @param ctx
+ * @param memb
+ * @param rng
+ */
+void LabelPropagationInitializer::initialize(const GraphContext &ctx, Membership *memb, igraph_rng_t *rng) const
+{
+    const size_t n = ctx.number_of_nodes();
+    size_t nth = nthreads ? nthreads : std::thread::hardware_concurrency();
+    nth = std::max<size_t>(1,std::min(nth,n));
+
+    Membership cur(n), next(n);
+    for (size_t v=0; v<n; ++v)
+        cur[v] = v;
+    const uint64_t seed = mix64(igraph_rng_get_integer(rng,0,std::numeric_limits<int>::max()));
+
+    std::vector<LabelScores> score(nth);
+    std::vector<size_t> nunstable(nth);
+    for (size_t iter=0; iter<max_iter; ++iter)
+    {
+        if (nth==1)
+        {
+            PACO_TRACE_SCOPE("label propagation sweep");
+            nunstable[0] = label_propagation_sweep(ctx,cur,next,score[0],seed,iter,0,n);
+        }
+        else
+        {
+            std::vector<std::thread> workers;
+            for (size_t t=0; t<nth; ++t)
+                workers.push_back(std::thread([&,t]() {
+                    PACO_TRACE_SCOPE("label propagation sweep");
+                    nunstable[t] = label_propagation_sweep(ctx,cur,next,score[t],seed,iter,n*t/nth,n*(t+1)/nth);
+                }));
+            for (size_t t=0; t<nth; ++t)
+                workers[t].join();
+        }
+        cur.swap(next);
+        size_t total = 0;
+        for (size_t t=0; t<nth; ++t)
+            total += nunstable[t];
+        if (total==0)
+            break;
+    }
+    memb->swap(cur);
+}
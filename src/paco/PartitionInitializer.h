@@ -0,0 +1,123 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+#ifndef _PARTITION_INITIALIZER_H_
+#define _PARTITION_INITIALIZER_H_
+
+#include <string>
+#include <igraph.h>
+#include "Common.h"
+#include "GraphContext.h"
+
+/**
+ * Initializer stage, builds the partition the optimizers start from.
+ * Implementations fill memb with one community id per vertex. Except for memberships read from file, ids are
+ * smaller than the number of vertices.
+ */
+class PartitionInitializer
+{
+public:
+    virtual ~PartitionInitializer() {}
+    virtual void initialize(const GraphContext &ctx, Membership *memb, igraph_rng_t *rng) const = 0;
+};
+
+/**
+ * @brief Every vertex in its own community, the default starting point of the optimizers
+ */
+class SingletonInitializer : public PartitionInitializer
+{
+public:
+    void initialize(const GraphContext &ctx, Membership *memb, igraph_rng_t *rng) const;
+};
+
+/**
+ * @brief Every vertex in one of k communities chosen uniformly at random
+ */
+class RandomInitializer : public PartitionInitializer
+{
+public:
+    RandomInitializer(size_t k) : k(k) {}
+    void initialize(const GraphContext &ctx, Membership *memb, igraph_rng_t *rng) const;
+
+private:
+    size_t k;
+};
+
+/**
+ * @brief Membership read from a text file with one community id per line, as written by paco_optimizer.
+ * The ids are renumbered in order of first appearance.
+ */
+class FileInitializer : public PartitionInitializer
+{
+public:
+    FileInitializer(const std::string &filename) : filename(filename) {}
+    void initialize(const GraphContext &ctx, Membership *memb, igraph_rng_t *rng) const;
+
+private:
+    std::string filename;
+};
+
+/**
+ * @brief A given membership, as the partition found on another graph with the same vertices
+ */
+class MembershipInitializer : public PartitionInitializer
+{
+public:
+    MembershipInitializer(const Membership &membership) : membership(membership) {}
+    void initialize(const GraphContext &ctx, Membership *memb, igraph_rng_t *rng) const;
+
+private:
+    Membership membership;
+};
+
+/**
+ * @brief Label propagation: every vertex takes the label with the largest total edge weight among its
+ * neighbors, until no label changes or max_iter sweeps are done, in O(m) per sweep.
+ * Every sweep updates synchronously a random half of the vertices, which avoids the oscillations of
+ * fully synchronous updates. The vertices are split in blocks over nthreads threads, and since labels
+ * are double buffered and ties broken by hashing, the result doesn't depend on the number of threads.
+ */
+class LabelPropagationInitializer : public PartitionInitializer
+{
+public:
+    LabelPropagationInitializer(size_t max_iter=20, unsigned int nthreads=0) : max_iter(max_iter), nthreads(nthreads) {}
+    void initialize(const GraphContext &ctx, Membership *memb, igraph_rng_t *rng) const;
+
+private:
+    size_t max_iter;
+    unsigned int nthreads; // 0 for std::thread::hardware_concurrency
+};
+
+#endif // _PARTITION_INITIALIZER_H_
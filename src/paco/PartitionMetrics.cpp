@@ -0,0 +1,193 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+#include <cmath>
+#include <algorithm>
+#include <unordered_map>
+#include <stdexcept>
+#include <atomic>
+#include <thread>
+#include <exception>
+#include <stdint.h>
+#include "PartitionMetrics.h"
+
+/**
+ * @brief entropy Entropy of the distribution of counts summing to n
+ */
+template <class Map>
+static double entropy(const Map &counts, double n)
+{
+    double h = 0;
+    for (typename Map::const_iterator it=counts.begin(); it!=counts.end(); ++it)
+    {
+        double p = it->second/n;
+        h -= p*std::log(p);
+    }
+    return h;
+}
+
+/**
+ * @brief pairs Number of pairs of vertices in the same cell, summed over the cells of counts
+ */
+template <class Map>
+static double pairs(const Map &counts)
+{
+    uint64_t p = 0;
+    for (typename Map::const_iterator it=counts.begin(); it!=counts.end(); ++it)
+        p += static_cast<uint64_t>(it->second)*(it->second-1)/2;
+    return static_cast<double>(p);
+}
+
+/**
+ * @brief The Marginal struct Community sizes of one partition, reduced to what the measures need
+ */
+struct Marginal
+{
+    double entropy;
+    double pairs;
+};
+
+static Marginal marginal(const Membership &m)
+{
+    std::unordered_map<uint32_t,size_t> counts;
+    counts.reserve(64);
+    for (size_t v=0; v<m.size(); ++v)
+        ++counts[m[v]];
+    Marginal marg = { entropy(counts,m.size()), pairs(counts) };
+    return marg;
+}
+
+/**
+ * @brief compare Fills the comparison of a and b from the nonzero cells of their contingency table, the marginals
+ * are passed in so that a reference partition is counted only once
+ */
+static PartitionComparison compare(const Membership &a, const Marginal &ma, const Membership &b, const Marginal &mb)
+{
+    PartitionComparison c;
+    // No pair of vertices to tell partitions of less than two vertices apart
+    if (a.size()<2)
+    {
+        c.nmi = c.ari = c.jaccard = 1;
+        c.vi = 0;
+        return c;
+    }
+    std::unordered_map<uint64_t,size_t> joint;
+    joint.reserve(64);
+    for (size_t v=0; v<a.size(); ++v)
+        ++joint[(static_cast<uint64_t>(a[v])<<32) | b[v]];
+    const double n = a.size();
+    const double h_joint = entropy(joint,n);
+    // I(A;B) = H(A) + H(B) - H(A,B)
+    const double mutual = ma.entropy + mb.entropy - h_joint;
+    c.nmi = ma.entropy+mb.entropy==0 ? 1 : std::max(0.0,std::min(1.0,2*mutual/(ma.entropy+mb.entropy)));
+    c.vi = std::max(0.0,2*h_joint - ma.entropy - mb.entropy);
+
+    const double both = pairs(joint), either = ma.pairs + mb.pairs - both;
+    const double expected = ma.pairs*mb.pairs/(n*(n-1)/2);
+    const double span = (ma.pairs+mb.pairs)/2 - expected;
+    // Both partitions are all singletons or a single community, then they are identical
+    c.ari = span==0 ? 1 : (both-expected)/span;
+    c.jaccard = either==0 ? 1 : both/either;
+    return c;
+}
+
+double normalized_mutual_information(const Membership &a, const Membership &b)
+{
+    return compare_partitions(a,b).nmi;
+}
+
+double variation_of_information(const Membership &a, const Membership &b)
+{
+    return compare_partitions(a,b).vi;
+}
+
+double adjusted_rand_index(const Membership &a, const Membership &b)
+{
+    return compare_partitions(a,b).ari;
+}
+
+double jaccard_index(const Membership &a, const Membership &b)
+{
+    return compare_partitions(a,b).jaccard;
+}
+
+PartitionComparison compare_partitions(const Membership &a, const Membership &b)
+{
+    if (a.size()!=b.size())
+        throw std::logic_error("Partitions of different sizes");
+    return compare(a,marginal(a),b,marginal(b));
+}
+
+std::vector<PartitionComparison> compare_partitions(const std::vector<Membership> &partitions,
+                                                    const Membership &reference, unsigned int nthreads)
+{
+    for (size_t i=0; i<partitions.size(); ++i)
+    {
+        if (partitions[i].size()!=reference.size())
+            throw std::logic_error("Partitions of different sizes");
+    }
+    std::vector<PartitionComparison> result(partitions.size());
+    const Marginal mref = marginal(reference);
+
+    std::atomic<size_t> next(0);
+    std::exception_ptr error;
+    std::atomic<bool> failed(false);
+    auto work = [&]()
+    {
+        try
+        {
+            for (size_t i=next++; i<partitions.size() && !failed; i=next++)
+                result[i] = compare(partitions[i],marginal(partitions[i]),reference,mref);
+        }
+        catch (...)
+        {
+            // Only the first thread that fails writes the error
+            if (!failed.exchange(true))
+                error = std::current_exception();
+        }
+    };
+
+    unsigned int n = nthreads ? nthreads : std::max(1U,std::thread::hardware_concurrency());
+    n = static_cast<unsigned int>(std::min<size_t>(n,partitions.size()));
+    std::vector<std::thread> threads;
+    for (unsigned int t=1; t<n; ++t)
+        threads.push_back(std::thread(work));
+    work();
+    for (size_t t=0; t<threads.size(); ++t)
+        threads[t].join();
+    if (error)
+        std::rethrow_exception(error);
+    return result;
+}
@@ -0,0 +1,111 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+#ifndef _PARTITION_METRICS_H_
+#define _PARTITION_METRICS_H_
+
+#include "Common.h"
+
+/**
+ * @brief normalized_mutual_information Mutual information of two partitions of the same vertices normalized by the
+ * mean of their entropies, as in Danon et al. J. Stat. Mech. P09008 (2005). It is 1 for identical partitions up to
+ * a relabeling of the communities, and 1 when both partitions have a single community.
+ * @param a
+ * @param b
+ * @return the normalized mutual information in [0,1]
+ */
+double normalized_mutual_information(const Membership &a, const Membership &b);
+
+/**
+ * @brief variation_of_information Meila's distance between two partitions of the same vertices, H(A|B)+H(B|A),
+ * in nats. It is 0 for identical partitions up to a relabeling of the communities and at most log(n).
+ * @param a
+ * @param b
+ * @return the variation of information
+ */
+double variation_of_information(const Membership &a, const Membership &b);
+
+/**
+ * @brief adjusted_rand_index Fraction of vertex pairs on which two partitions agree, corrected for chance as in
+ * Hubert and Arabie, J. Classif. 2 (1985). It is 1 for identical partitions and close to 0 for independent ones.
+ * @param a
+ * @param b
+ * @return the adjusted Rand index in [-1,1]
+ */
+double adjusted_rand_index(const Membership &a, const Membership &b);
+
+/**
+ * @brief jaccard_index Number of vertex pairs in the same community in both partitions over the number of pairs in
+ * the same community in at least one of them. It is 1 when both partitions are made of singletons.
+ * @param a
+ * @param b
+ * @return the Jaccard index in [0,1]
+ */
+double jaccard_index(const Membership &a, const Membership &b);
+
+/**
+ * @brief The PartitionComparison struct All the agreement measures of two partitions, computed from a single
+ * sparse contingency table of their communities
+ */
+struct PartitionComparison
+{
+    double nmi;     /// normalized mutual information
+    double vi;      /// variation of information in nats
+    double ari;     /// adjusted Rand index
+    double jaccard; /// Jaccard index of the pairs of vertices in the same community
+};
+
+/**
+ * @brief compare_partitions Computes all the agreement measures of two partitions of the same vertices. The
+ * contingency table is built with a single hashing pass over the vertices, whatever the community labels.
+ * @param a
+ * @param b
+ * @return the normalized mutual information, variation of information, adjusted Rand and Jaccard indices
+ */
+PartitionComparison compare_partitions(const Membership &a, const Membership &b);
+
+/**
+ * @brief compare_partitions Compares many partitions, like the repetitions of a stability analysis, with the same
+ * reference partition. The community sizes of the reference are counted once, the partitions are split among
+ * the threads.
+ * @param partitions
+ * @param reference
+ * @param nthreads number of threads, 0 to use the hardware concurrency
+ * @return one comparison per partition, in the same order
+ */
+std::vector<PartitionComparison> compare_partitions(const std::vector<Membership> &partitions,
+                                                    const Membership &reference, unsigned int nthreads=0);
+
+#endif // _PARTITION_METRICS_H_
@@ -67,6 +67,29 @@ public:
         return quality;
     }
 
+    /**
+     * @brief Evaluates the quality of a compact membership by converting it to a temporary igraph vector.
+     * Single precision weights are widened to a temporary double vector as well.
+     */
+    double &operator()(const igraph_t *g, const Membership &memb, const EdgeWeights &weights=EdgeWeights()) const
+    {
+        igraph_vector_t m;
+        igraph_vector_init(&m,0);
+        membership_to_igraph(memb,&m);
+        if (weights.is_single_precision())
+        {
+            igraph_vector_t w;
+            igraph_vector_init(&w,0);
+            weights.copy_to(&w);
+            eval(g,&m,&w);
+            igraph_vector_destroy(&w);
+        }
+        else
+            eval(g,&m,weights.igraph_vector());
+        igraph_vector_destroy(&m);
+        return quality;
+    }
+
     double &operator()(const PartitionHelper *par) const
     {
         eval(par);
@@ -39,28 +39,79 @@
 
 #include "QualityFunction.h"
 #include "PartitionHelper.h"
+#include "OptimizerCounters.h"
+#include "OptimizerProgress.h"
+#include "Timer.h"
+#include "Trace.h"
 #include <set>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include <cstdlib>
 
 class QualityOptimizer
 {
 public:
     inline QualityOptimizer();
-    inline QualityOptimizer(const igraph_t *g, const QualityFunction &fun, const igraph_vector_t *memb, const igraph_vector_t *weights=NULL);
+    inline QualityOptimizer(const igraph_t *g, const QualityFunction &fun, Membership *memb, const EdgeWeights &weights=EdgeWeights());
     inline virtual ~QualityOptimizer();
-    virtual double optimize(const igraph_t *g, const QualityFunction &fun, const igraph_vector_t *memb, const igraph_vector_t *weights=NULL) = 0;
+    virtual double optimize(const igraph_t *g, const QualityFunction &fun, Membership *memb, const EdgeWeights &weights=EdgeWeights()) = 0;
     const PartitionHelper* get_partition_helper() const;
+    inline void set_graph_context(const std::shared_ptr<const GraphContext> &ctx);
+    inline void set_rng(igraph_rng_t *rng);
+    inline const OptimizerCounters &get_counters() const;
+    inline void clear_counters();
+    // Interruption of optimize, that returns the partition reached so far
+    inline void set_deadline(const std::chrono::steady_clock::time_point &deadline);
+    inline void clear_deadline();
+    inline void set_cancel_flag(const std::atomic<bool> *cancel);
+    inline void set_progress_callback(ProgressCallback callback, void *data, unsigned int interval);
+    inline void reset_interruption();
+    inline bool deadline_expired() const;
+    inline bool cancelled() const;
+    inline OptimizerProgress get_progress() const;
 
 protected:
-    virtual double diff_move(const igraph_t *g, const QualityFunction &fun, const igraph_vector_t *memb, int vert, size_t dest_comm, const igraph_vector_t *weights) = 0;
+    virtual double diff_move(const igraph_t *g, const QualityFunction &fun, Membership *memb, int vert, size_t dest_comm, const EdgeWeights &weights) = 0;
+    inline void init_partition_helper(const igraph_t *g, const Membership *memb, const EdgeWeights &weights=EdgeWeights());
+    inline size_t random_integer(size_t n) const;
+    inline double evaluate(const QualityFunction &fun);
+    inline double current_quality(const QualityFunction &fun);
+    inline void set_current_quality(double q);
+    inline double final_quality(const QualityFunction &fun);
+    inline double final_quality(const igraph_t *g, const QualityFunction &fun, const Membership &memb, const EdgeWeights &weights);
+    inline bool interrupted();
+    inline bool poll_interruption();
     PartitionHelper *par;
+    std::shared_ptr<const GraphContext> context; // shared read-only graph data, if set
+    igraph_rng_t *rng; // random stream of the caller, std::rand if NULL
+    OptimizerCounters counters; // of all the calls of optimize
+    double quality_value; // quality of the partition in par, if quality_valid
+    bool quality_valid;
+
+    // Interruption, checked every check_interval steps
+    static const unsigned int check_interval = 64;
+    unsigned int check_countdown = check_interval; // calls of interrupted before the next check
+    unsigned int check_start = check_interval; // value of check_countdown after the last check
+    uint64_t steps = 0; // steps done until the last check
+    bool has_deadline = false;
+    bool expired = false;
+    bool was_cancelled = false;
+    std::chrono::steady_clock::time_point deadline;
+    const std::atomic<bool> *cancel_flag = NULL;
+    ProgressCallback progress_callback = NULL;
+    void *progress_data = NULL;
+    unsigned int progress_interval = 8192;
+    uint64_t next_progress = 8192;
 };
 
-inline QualityOptimizer::QualityOptimizer() : par(NULL)
+inline QualityOptimizer::QualityOptimizer() : par(NULL), rng(NULL), quality_value(0), quality_valid(false)
 {
     par = new PartitionHelper();
 }
 
-inline QualityOptimizer::QualityOptimizer(const igraph_t *g, const QualityFunction &fun, const igraph_vector_t *memb, const igraph_vector_t *weights) : par(NULL)
+inline QualityOptimizer::QualityOptimizer(const igraph_t *g, const QualityFunction &fun, Membership *memb, const EdgeWeights &weights) : par(NULL), rng(NULL), quality_value(0), quality_valid(false)
 {
     par = new PartitionHelper();
 }
@@ -76,5 +127,280 @@ inline const PartitionHelper* QualityOptimizer::get_partition_helper() const
     return par;
 }
 
+/**
+ * @brief QualityOptimizer::set_graph_context Sets the context of the graph to optimize, so that
+ * degrees, strengths and adjacency are not recomputed at every call of optimize
+ * @param ctx
+ */
+inline void QualityOptimizer::set_graph_context(const std::shared_ptr<const GraphContext> &ctx)
+{
+    context = ctx;
+}
+
+/**
+ * @brief QualityOptimizer::set_rng Sets the random stream the optimizer draws from, so that optimizers
+ * running in different threads are reproducible and independent from each other
+ * @param rng not owned, NULL for the process-wide std::rand
+ */
+inline void QualityOptimizer::set_rng(igraph_rng_t *rng)
+{
+    this->rng = rng;
+}
+
+/**
+ * @brief QualityOptimizer::get_counters
+ * @return the counters of all the calls of optimize. The Surprise terms and the times of sorting and of
+ * the moves are filled by CommunityStructure::optimize
+ */
+inline const OptimizerCounters &QualityOptimizer::get_counters() const
+{
+    return counters;
+}
+
+/**
+ * @brief QualityOptimizer::clear_counters
+ */
+inline void QualityOptimizer::clear_counters()
+{
+    counters.clear();
+}
+
+/**
+ * @brief QualityOptimizer::set_deadline Sets the time when optimize stops moving vertices, returning the partition
+ * reached so far, which is as valid as a complete one
+ * @param deadline
+ */
+inline void QualityOptimizer::set_deadline(const std::chrono::steady_clock::time_point &deadline)
+{
+    this->deadline = deadline;
+    has_deadline = true;
+}
+
+/**
+ * @brief QualityOptimizer::clear_deadline
+ */
+inline void QualityOptimizer::clear_deadline()
+{
+    has_deadline = false;
+}
+
+/**
+ * @brief QualityOptimizer::set_cancel_flag Sets a flag that other threads raise to stop optimize as the deadline does
+ * @param cancel not owned, NULL for none
+ */
+inline void QualityOptimizer::set_cancel_flag(const std::atomic<bool> *cancel)
+{
+    cancel_flag = cancel;
+}
+
+/**
+ * @brief QualityOptimizer::set_progress_callback Sets the function called during optimize, that stops it returning false
+ * @param callback NULL for none
+ * @param data passed to callback
+ * @param interval number of steps between two calls, rounded up to a multiple of the interval of the checks
+ */
+inline void QualityOptimizer::set_progress_callback(ProgressCallback callback, void *data, unsigned int interval)
+{
+    progress_callback = callback;
+    progress_data = data;
+    progress_interval = std::max(interval,1U);
+    next_progress = steps + progress_interval;
+}
+
+/**
+ * @brief QualityOptimizer::reset_interruption Lets optimize run again after it has been stopped, and restarts the count of steps
+ */
+inline void QualityOptimizer::reset_interruption()
+{
+    expired = false;
+    was_cancelled = false;
+    check_countdown = check_start = check_interval;
+    steps = 0;
+    next_progress = progress_interval;
+}
+
+/**
+ * @brief QualityOptimizer::deadline_expired
+ * @return true if optimize has been stopped by the deadline
+ */
+inline bool QualityOptimizer::deadline_expired() const
+{
+    return expired;
+}
+
+/**
+ * @brief QualityOptimizer::cancelled
+ * @return true if optimize has been stopped by the cancel flag or by the progress callback
+ */
+inline bool QualityOptimizer::cancelled() const
+{
+    return was_cancelled;
+}
+
+/**
+ * @brief QualityOptimizer::get_progress
+ * @return the steps done and the last quality computed, the fields about the repetitions are left to the caller
+ */
+inline OptimizerProgress QualityOptimizer::get_progress() const
+{
+    OptimizerProgress progress;
+    progress.steps = steps + (check_start - check_countdown);
+    progress.quality = quality_valid ? quality_value : std::numeric_limits<double>::quiet_NaN();
+    return progress;
+}
+
+/**
+ * @brief QualityOptimizer::interrupted Called at every step of the optimizers, that stop when it returns true.
+ * It only decrements a counter, the deadline, the cancel flag and the progress callback are checked every check_interval calls
+ * @return true once optimize has been stopped
+ */
+inline bool QualityOptimizer::interrupted()
+{
+    if (--check_countdown)
+        return false;
+    return poll_interruption();
+}
+
+/**
+ * @brief QualityOptimizer::poll_interruption Checks the reasons to stop, after check_interval steps
+ * @return true if optimize has been stopped
+ */
+inline bool QualityOptimizer::poll_interruption()
+{
+    if (expired || was_cancelled)
+    {
+        check_countdown = check_start = 1; // stays stopped, the calls after the stop are not steps
+        return true;
+    }
+    steps += check_start;
+    check_countdown = check_start = check_interval;
+    if (cancel_flag && cancel_flag->load(std::memory_order_relaxed))
+        was_cancelled = true;
+    else if (has_deadline && std::chrono::steady_clock::now() >= deadline)
+        expired = true;
+    else if (progress_callback && steps>=next_progress)
+    {
+        next_progress = steps + progress_interval;
+        was_cancelled = !progress_callback(get_progress(),progress_data);
+    }
+    if (expired || was_cancelled)
+    {
+        --steps; // the step of this call doesn't run
+        check_countdown = check_start = 1;
+    }
+    return expired || was_cancelled;
+}
+
+/**
+ * @brief QualityOptimizer::random_integer
+ * @param n
+ * @return a random integer in [0,n-1]
+ */
+inline size_t QualityOptimizer::random_integer(size_t n) const
+{
+    if (rng)
+        return static_cast<size_t>(igraph_rng_get_integer(rng,0,static_cast<long>(n)-1));
+    return static_cast<size_t>(std::rand())%n;
+}
+
+/**
+ * @brief QualityOptimizer::init_partition_helper Initializes the partition helper, on the graph context if it has been set for g.
+ * When the helper is already on that context, as in repeated calls of optimize, it is only reset to memb reusing its buffers.
+ * @param g
+ * @param memb
+ * @param weights
+ */
+inline void QualityOptimizer::init_partition_helper(const igraph_t *g, const Membership *memb, const EdgeWeights &weights)
+{
+    PACO_TRACE_SCOPE("PartitionHelper init");
+    Timer timer;
+    timer.start();
+    if (context && context->get_igraph()==g)
+    {
+        if (par->get_graph_context()==context)
+            par->reset(memb,weights);
+        else
+            par->init(context,memb,weights);
+    }
+    else
+        par->init(g,memb,weights);
+    quality_valid = false;
+    timer.stop();
+    counters.init_time += timer.getElapsedTimeInSec();
+}
+
+/**
+ * @brief QualityOptimizer::evaluate Evaluates fun on the partition aggregates and remembers the value
+ * as the quality of the current partition
+ * @param fun
+ * @return
+ */
+inline double QualityOptimizer::evaluate(const QualityFunction &fun)
+{
+    ++counters.quality_evaluations;
+    quality_value = fun(par);
+    quality_valid = true;
+    return quality_value;
+}
+
+/**
+ * @brief QualityOptimizer::current_quality Quality of the current partition, evaluated only if the partition
+ * has been changed since the last evaluation. Every move of the vertices outside diff_move must be followed
+ * by evaluate or set_current_quality.
+ * @param fun the same function of the last evaluation
+ * @return
+ */
+inline double QualityOptimizer::current_quality(const QualityFunction &fun)
+{
+    if (!quality_valid)
+        return evaluate(fun);
+    ++counters.cache_hits;
+    return quality_value;
+}
+
+/**
+ * @brief QualityOptimizer::set_current_quality Sets the quality of the partition after a move has been undone
+ * @param q
+ */
+inline void QualityOptimizer::set_current_quality(double q)
+{
+    quality_value = q;
+    quality_valid = true;
+}
+
+/**
+ * @brief QualityOptimizer::final_quality Timed evaluation of the quality returned by optimize, from the aggregates
+ * @param fun
+ * @return
+ */
+inline double QualityOptimizer::final_quality(const QualityFunction &fun)
+{
+    Timer timer;
+    timer.start();
+    double q = evaluate(fun);
+    timer.stop();
+    counters.evaluation_time += timer.getElapsedTimeInSec();
+    return q;
+}
+
+/**
+ * @brief QualityOptimizer::final_quality Timed evaluation of the quality returned by optimize, from scratch
+ * @param g
+ * @param fun
+ * @param memb
+ * @param weights
+ * @return
+ */
+inline double QualityOptimizer::final_quality(const igraph_t *g, const QualityFunction &fun, const Membership &memb, const EdgeWeights &weights)
+{
+    Timer timer;
+    timer.start();
+    ++counters.quality_evaluations;
+    double q = fun(g,memb,weights);
+    timer.stop();
+    counters.evaluation_time += timer.getElapsedTimeInSec();
+    return q;
+}
+
 #endif // _QUALITYOPTIMIZER_H
 
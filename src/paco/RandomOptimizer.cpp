@@ -37,11 +37,7 @@
 #include "RandomOptimizer.h"
 #include <iostream>
 
-#ifdef MATLAB_SUPPORT
-#include "mexInterrupt.h"
-#endif
-
-RandomOptimizer::RandomOptimizer(const igraph_t *g, const QualityFunction &fun, const igraph_vector_t *memb, const igraph_vector_t *weights) : QualityOptimizer(g, fun, memb)
+RandomOptimizer::RandomOptimizer(const igraph_t *g, const QualityFunction &fun, Membership *memb, const EdgeWeights &weights) : QualityOptimizer(g, fun, memb)
 {
     this->optimize(g,fun,memb,weights);
 }
@@ -50,44 +46,50 @@ RandomOptimizer::~RandomOptimizer()
 {
 }
 
-double RandomOptimizer::diff_move(const igraph_t *g, const QualityFunction &fun, const igraph_vector_t *memb, int vert, size_t dest_comm, const igraph_vector_t *weights)
+double RandomOptimizer::diff_move(const igraph_t *g, const QualityFunction &fun, Membership *memb, int vert, size_t dest_comm, const EdgeWeights &weights)
 {
     // try to join the vertices
-    double pre = fun(par);
-    int orig_comm = memb->stor_begin[vert]; // save old original community of vert
-    bool vertex_moved = par->move_vertex(g, memb,vert,dest_comm);
+    double pre = current_quality(fun);
+    int orig_comm = (*memb)[vert]; // save old original community of vert
+    ++counters.moves_attempted;
+    bool vertex_moved = par->move_vertex(g, memb,vert,dest_comm,weights);
     if (vertex_moved)
     {
-        double post = fun(par);
+        double post = evaluate(fun);
         if (post<pre)
         {
             par->move_vertex(g, memb,vert,orig_comm,weights); // restore previous status
+            set_current_quality(pre);
+            ++counters.moves_reverted;
             return post-pre;
         }
         else
+        {
+            ++counters.moves_accepted;
             return post-pre;
+        }
     }
     else
         return 0;
 }
 
-double RandomOptimizer::optimize(const igraph_t *g, const QualityFunction &fun, const igraph_vector_t *memb, const igraph_vector_t *weights)
+double RandomOptimizer::optimize(const igraph_t *g, const QualityFunction &fun, Membership *memb, const EdgeWeights &weights)
 {
-    par->init(g,memb,weights);
+    PACO_TRACE_SCOPE("RandomOptimizer::optimize");
+    init_partition_helper(g,memb,weights);
 #ifdef _DEBUG
     printf(ANSI_COLOR_RED "RANDOM Initial Qual=%g\n" ANSI_COLOR_RESET,fun(par));
 #endif
     for (int i=0; i<igraph_ecount(g); i++)
     {
-        #ifdef MATLAB_SUPPORT
-        ctrlcCheckPoint(__FILE__, __LINE__);
-        #endif
-        int e = rand()%igraph_ecount(g);
+        if (interrupted())
+            break;
+        int e = random_integer(igraph_ecount(g));
         int vert1;
         int vert2;
         igraph_edge(g,e,&vert1,&vert2);
 
-        size_t dest_comm = memb->stor_begin[vert2];
+        size_t dest_comm = (*memb)[vert2];
 
         diff_move(g,fun,memb,vert1,dest_comm,weights);
     }
@@ -96,5 +98,5 @@ double RandomOptimizer::optimize(const igraph_t *g, const QualityFunction &fun,
     par->print();
     printf(ANSI_COLOR_RED "RANDOM Final Qual=%g\n" ANSI_COLOR_RESET,fun(par));
 #endif
-    return fun(g,memb,weights);
+    return final_quality(g,fun,*memb,weights);
 }
@@ -43,12 +43,12 @@ class RandomOptimizer : public QualityOptimizer
 {
 public:
     RandomOptimizer() {}
-    RandomOptimizer(const igraph_t *g, const QualityFunction &fun, const  igraph_vector_t *memb, const igraph_vector_t *weights=NULL);
+    RandomOptimizer(const igraph_t *g, const QualityFunction &fun, Membership *memb, const EdgeWeights &weights=EdgeWeights());
     virtual ~RandomOptimizer();
-    double optimize(const igraph_t *g, const QualityFunction &fun,const  igraph_vector_t *memb, const igraph_vector_t *weights=NULL);
+    double optimize(const igraph_t *g, const QualityFunction &fun,Membership *memb, const EdgeWeights &weights=EdgeWeights());
 
 protected:
-    double diff_move(const igraph_t *g, const QualityFunction &fun, const igraph_vector_t *memb, int vert, size_t dest_comm, const igraph_vector_t *weights);
+    double diff_move(const igraph_t *g, const QualityFunction &fun, Membership *memb, int vert, size_t dest_comm, const EdgeWeights &weights);
 
 };
 
@@ -0,0 +1,253 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include "RepetitionRace.h"
+#include "PartitionInitializer.h"
+#include "Trace.h"
+#include "igraph_utils.h"
+
+/**
+ * State shared by the threads of a race
+ */
+struct RaceState
+{
+    std::mutex mutex;
+    std::vector<double> checkpoint_best; // best quality reached at every checkpoint
+    double margin;
+    unsigned int interval;
+    std::atomic<size_t> next_repetition;
+    RaceResult result;
+    size_t best_repetition;
+};
+
+/**
+ * @brief race_checkpoint Progress callback of the repetitions, that compares them at the same checkpoint
+ * @param progress
+ * @param data the RaceState
+ * @return false if the repetition trails the best one by more than the margin
+ */
+static bool race_checkpoint(const OptimizerProgress &progress, void *data)
+{
+    RaceState *race = static_cast<RaceState*>(data);
+    // The reports at the end of the passes fall between the checkpoints
+    if (std::isnan(progress.quality) || progress.steps%race->interval)
+        return true;
+    size_t k = progress.steps/race->interval;
+    std::lock_guard<std::mutex> lock(race->mutex);
+    if (k>=race->checkpoint_best.size())
+        race->checkpoint_best.resize(k+1,-std::numeric_limits<double>::infinity());
+    double &best = race->checkpoint_best[k];
+    if (progress.quality < best - race->margin*std::fabs(best))
+        return false;
+    best = std::max(best,progress.quality);
+    return true;
+}
+
+/**
+ * @brief RepetitionRace::RepetitionRace Builds the graph context shared by all the repetitions
+ * @param g
+ * @param nthreads 0 for all the cores, or one if igraph isn't thread safe. More than one throws std::logic_error
+ * without a thread safe igraph.
+ */
+RepetitionRace::RepetitionRace(const GraphC &g, unsigned int nthreads) : graph(g), nthreads(nthreads), margin(0.05), checkpoint_interval(0), time_budget(0), passes(1), repetition_callback(NULL), repetition_data(NULL)
+{
+    igraph_threads(nthreads);
+    context = std::make_shared<const GraphContext>(g);
+}
+
+/**
+ * @brief RepetitionRace::set_margin
+ * @param margin fraction of the best quality at a checkpoint that a repetition may trail by, default 0.05.
+ * Negative for no racing, every repetition is run to the end.
+ */
+void RepetitionRace::set_margin(double margin)
+{
+    this->margin = margin;
+}
+
+/**
+ * @brief RepetitionRace::set_checkpoint_interval
+ * @param steps optimizer steps between two checkpoints, rounded up to a multiple of 64. Default 0 for
+ * a tenth of the number of edges, that is about ten checkpoints per agglomerative pass.
+ */
+void RepetitionRace::set_checkpoint_interval(unsigned int steps)
+{
+    this->checkpoint_interval = steps;
+}
+
+/**
+ * @brief RepetitionRace::set_time_budget Limits the time of the whole race, after which it returns the best repetition so far
+ * @param milliseconds no limit if not positive
+ */
+void RepetitionRace::set_time_budget(double milliseconds)
+{
+    this->time_budget = milliseconds;
+}
+
+/**
+ * @brief RepetitionRace::set_passes Sets the number of passes of the optimizer in a repetition, chained as the
+ * repetitions of CommunityStructure::optimize, so that every repetition refines its own partition. The
+ * checkpoints count the steps of all the passes.
+ * @param passes default 1
+ */
+void RepetitionRace::set_passes(size_t passes)
+{
+    this->passes = std::max<size_t>(passes,1);
+}
+
+/**
+ * @brief RepetitionRace::set_repetition_callback Sets the function called with the partition of every completed repetition,
+ * to look at all of them rather than only at the best one
+ * @param callback NULL for none
+ * @param data passed to callback
+ */
+void RepetitionRace::set_repetition_callback(RepetitionCallback callback, void *data)
+{
+    this->repetition_callback = callback;
+    this->repetition_data = data;
+}
+
+/**
+ * @brief RepetitionRace::number_of_threads
+ * @param nrep
+ * @return the number of threads that run nrep repetitions
+ */
+unsigned int RepetitionRace::number_of_threads(size_t nrep) const
+{
+    unsigned int n = igraph_threads(nthreads);
+    return static_cast<unsigned int>(std::min<size_t>(n,nrep));
+}
+
+/**
+ * @brief RepetitionRace::run Runs nrep repetitions over the threads, every one from singletons
+ * @param qual any quality but Infomap
+ * @param method
+ * @param nrep number of repetitions started, including the abandoned ones
+ * @param seed of the race, the r-th repetition draws from a seed hashed from it and r. Negative for a seed based on time
+ * @return the best repetition
+ */
+RaceResult RepetitionRace::run(QualityType qual, OptimizerType method, size_t nrep, int seed) const
+{
+    if (qual==QualityInfoMap)
+        throw std::logic_error("Infomap repetitions can't be raced");
+    if (nrep<1)
+        throw std::invalid_argument("Non valid number of repetitions");
+    if (seed<0)
+        seed = static_cast<int>(std::chrono::system_clock::now().time_since_epoch().count() & 0x7FFFFFFF);
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    RaceState race;
+    race.margin = margin;
+    unsigned int interval = checkpoint_interval ? checkpoint_interval : static_cast<unsigned int>(graph.number_of_edges()/10);
+    race.interval = std::max(64U,(interval+63)/64*64);
+    race.next_repetition = 0;
+    race.result.quality = -std::numeric_limits<double>::infinity();
+    race.result.completed = 0;
+    race.result.abandoned = 0;
+    race.best_repetition = nrep;
+
+    std::exception_ptr error;
+    auto work = [&](unsigned int thread)
+    {
+        PACO_TRACE_SCOPE("race worker");
+        try
+        {
+            CommunityStructure comm(&graph);
+            comm.set_graph_context(context);
+            if (margin>=0)
+                comm.set_progress_callback(race_checkpoint,&race,race.interval);
+            for (size_t r=race.next_repetition++; r<nrep; r=race.next_repetition++)
+            {
+                if (time_budget>0)
+                {
+                    double elapsed = std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-start).count();
+                    if (elapsed>=time_budget)
+                        break;
+                    comm.set_time_budget(time_budget-elapsed);
+                }
+                comm.set_random_seed(derived_seed(seed,r));
+                comm.initialize(SingletonInitializer());
+                double q = comm.optimize(qual,method,passes);
+                if (repetition_callback && !comm.cancelled())
+                    repetition_callback(comm,q,thread,repetition_data);
+                std::lock_guard<std::mutex> lock(race.mutex);
+                if (comm.cancelled())
+                {
+                    ++race.result.abandoned;
+                    continue;
+                }
+                ++race.result.completed;
+                // Ties go to the first repetition, so that without racing the result doesn't depend on the threads
+                if (q>race.result.quality || (q==race.result.quality && r<race.best_repetition))
+                {
+                    comm.reindex_membership();
+                    std::vector<int> memb = comm.get_membership_vector();
+                    race.result.quality = q;
+                    race.result.membership.assign(memb.begin(),memb.end());
+                    race.best_repetition = r;
+                }
+                if (comm.time_budget_expired())
+                    break;
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(race.mutex);
+            error = std::current_exception();
+            race.next_repetition = nrep; // the other threads stop at their next repetition
+        }
+    };
+
+    const unsigned int n = number_of_threads(nrep);
+    std::vector<std::thread> threads;
+    for (unsigned int t=1; t<n; ++t)
+        threads.push_back(std::thread(work,t));
+    work(0);
+    for (size_t t=0; t<threads.size(); ++t)
+        threads[t].join();
+    if (error)
+        std::rethrow_exception(error);
+    if (race.result.completed==0)
+        throw std::runtime_error("No repetition completed within the time budget");
+    return race.result;
+}
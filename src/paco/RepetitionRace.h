@@ -0,0 +1,95 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+#ifndef _REPETITION_RACE_H_
+#define _REPETITION_RACE_H_
+
+#include <memory>
+#include "Graph.h"
+#include "Community.h"
+
+/**
+ * @brief Outcome of a RepetitionRace
+ */
+struct RaceResult
+{
+    double quality;        // of the best repetition
+    Membership membership; // of the best repetition, communities numbered from 0
+    size_t completed;      // repetitions run to the end
+    size_t abandoned;      // repetitions stopped because they trailed the best ones
+};
+
+/**
+ * Called by the threads of a race after every completed repetition, with the index of the thread, from 0,
+ * and the CommunityStructure holding the partition of the repetition. Calls from different threads are concurrent.
+ */
+typedef void (*RepetitionCallback)(const CommunityStructure &comm, double quality, unsigned int thread, void *data);
+
+/**
+ * Repetitions of optimize run in parallel, each one from singletons with its own seed, racing against
+ * each other. Every checkpoint_interval steps a repetition compares its quality with the best one reached
+ * at the same checkpoint by any repetition so far, and it is abandoned if it trails by more than margin,
+ * relative to the best. Its thread then starts the next repetition, so that the time of the runs that
+ * can't win is spent on new starting points. The repetitions of the optimizers that don't track their
+ * quality during a run, as SimulatedAnnealing, are never abandoned.
+ * With a negative margin nothing is abandoned and the result doesn't depend on the number of threads.
+ * The workers set up and run their CommunityStructure concurrently, the number of threads is checked by
+ * igraph_threads.
+ */
+class RepetitionRace
+{
+public:
+    RepetitionRace(const GraphC &g, unsigned int nthreads=0);
+    void set_margin(double margin);
+    void set_checkpoint_interval(unsigned int steps);
+    void set_time_budget(double milliseconds);
+    void set_passes(size_t passes);
+    void set_repetition_callback(RepetitionCallback callback, void *data=NULL);
+    unsigned int number_of_threads(size_t nrep) const;
+    RaceResult run(QualityType qual, OptimizerType method, size_t nrep, int seed=-1) const;
+
+private:
+    const GraphC &graph;
+    std::shared_ptr<const GraphContext> context;
+    unsigned int nthreads;        // 0 for all the cores, see igraph_threads
+    double margin;
+    unsigned int checkpoint_interval; // 0 for a tenth of the number of edges
+    double time_budget;           // milliseconds of the whole race, no limit if not positive
+    size_t passes;                // optimizer passes of a repetition, each one from the partition of the previous one
+    RepetitionCallback repetition_callback;
+    void *repetition_data;
+};
+
+#endif // _REPETITION_RACE_H_
@@ -79,7 +79,7 @@ void SignificanceFunction::eval(const igraph_t *g, const igraph_vector_t *memb,
     for (igraph_integer_t c=0; c<nComms; c++)
     {
         size_t n_vertex_c = std::count(memb->stor_begin, memb->stor_end, c);
-        double pairs_c = n_vertex_c *(n_vertex_c -1)/2;
+        double pairs_c = num_pairs(n_vertex_c);
         double density_c = VECTOR(observed)[c]/(pairs_c);
         quality += 2*pairs_c*KL(density_c,density);
     }
@@ -92,9 +92,9 @@ void SignificanceFunction::eval(const PartitionHelper *par) const
     quality = 0;
     double density = par->get_graph_total_weight()/par->get_graph_total_pairs();
     //for (igraph_integer_t c=0; c<nComms; c++)
-    for (CommMap::const_iterator it = par->get_communities().begin(); it!=par->get_communities().end(); ++it)
+    for (CommListCIter it = par->get_communities().begin(); it!=par->get_communities().end(); ++it)
     {
-        size_t c = it->first;
+        size_t c = *it;
         double pairs_c = par->get_incomm_pairs().at(c);
         double m_c =  par->get_incomm_weight().at(c);
         quality += 2*KL(m_c/pairs_c,density);
@@ -63,6 +63,8 @@ PLoS ONE 6(9): e24195
 #include <stdexcept>
 #include <cmath>
 #include <limits>
+#include <string>
+#include <vector>
 
 #include "AsymptoticSurprise.h"
 #include "KLDivergence.h"
@@ -77,7 +79,32 @@ PLoS ONE 6(9): e24195
 using std::cerr;
 using std::endl;
 
-bool checkArguments(const long p, const long pi, const long m, const long mi)
+// Terms summed by computeSurprise, per thread so that concurrent optimizations don't share a counter
+static thread_local uint64_t tail_terms = 0;
+
+/**
+ * @brief checkedCount
+ * @param x
+ * @param name
+ * @return
+ */
+int64_t checkedCount(const double x, const char *name)
+{
+    // 2^63 is exactly representable, every smaller double fits in an int64_t
+    if (!(x>=0) || !(x<9223372036854775808.0))
+        throw std::logic_error(std::string("Error computing Surprise: Integer overflow: ") + name + " too big or negative");
+    return static_cast<int64_t>(x);
+}
+
+/**
+ * @brief checkArguments
+ * @param p
+ * @param pi
+ * @param m
+ * @param mi
+ * @return
+ */
+bool checkArguments(const int64_t p, const int64_t pi, const int64_t m, const int64_t mi)
 {
     if ( mi<0 )
     {
@@ -91,7 +118,7 @@ bool checkArguments(const long p, const long pi, const long m, const long mi)
 
     if ( pi<0 )
     {
-        throw std::logic_error("Error computing Surprise: Integer overflow: m too big");
+        throw std::logic_error("Error computing Surprise: Integer overflow: pi too big");
     }
 
     if ( p<0 )
@@ -109,16 +136,13 @@ bool checkArguments(const long p, const long pi, const long m, const long mi)
         throw std::logic_error("Error computing Surprise: m<mi");
     }
 
+    // pi<=p and mi<=m were checked above, with all the counts non negative, so both differences are
+    // non negative and can't overflow. The second pi>p check that used to follow was unreachable.
     if ((m-mi) > (p-pi) )
     {
         throw std::logic_error("Error computing Surprise: p-pi<m-mi");
     }
 
-    if (pi>p)
-    {
-        throw std::logic_error("Error computing Surprise: pi>p");
-    }
-
     if (mi > pi)
         throw std::logic_error("Error computing Surprise: mi>pi");
 
@@ -142,8 +166,8 @@ bool checkArguments(const long p, const long pi, const long m, const long mi)
  * @param mi
  * @return
  */
-long double computeSurprise(const long p, const long pi,
-                            const long m, const long mi)
+long double computeSurprise(const int64_t p, const int64_t pi,
+                            const int64_t m, const int64_t mi)
 {
     try
     {
@@ -168,11 +192,21 @@ long double computeSurprise(const long p, const long pi,
         long double nextLogP = logHyperProbability(p, pi, m, j);
         isEnough = sumLogProbabilities(nextLogP, logP);
     }
+    tail_terms += static_cast<uint64_t>(j-mi)+1;
     if(logP == 0)
         logP *= -1;
     return -logP;
 }
 
+/**
+ * @brief surpriseTailTerms
+ * @return
+ */
+uint64_t surpriseTailTerms()
+{
+    return tail_terms;
+}
+
 /**
  * @brief computeAsymptoticSurprise
  * @param p
@@ -181,7 +215,7 @@ long double computeSurprise(const long p, const long pi,
  * @param mi
  * @return
  */
-long double computeAsymptoticSurprise(const long p, const long pi, const long m, const long mi)
+long double computeAsymptoticSurprise(const int64_t p, const int64_t pi, const int64_t m, const int64_t mi)
 {
     try
     {
@@ -201,7 +235,7 @@ long double computeAsymptoticSurprise(const long p, const long pi, const long m,
  * @param n
  * @return Stirling approximation given by Ramanujan ( http://en.wikipedia.org/wiki/Stirling%27s_approximation )
  */
-long double logStirFac(long n)
+long double logStirFac(int64_t n)
 {
     if (n<=1)
         return 1.0;
@@ -217,7 +251,7 @@ long double logStirFac(long n)
  * @param k
  * @return
  */
-long double logBin(long n, long k)
+long double logBin(int64_t n, int64_t k)
 {
     return logStirFac(n) - logStirFac(k) - logStirFac(n - k);
 }
@@ -231,8 +265,8 @@ long double logBin(long n, long k)
  * @param mi
  * @return
  */
-long double logHyperProbability(const long& p, const long& pi,
-                                const long& m, const long& mi)
+long double logHyperProbability(const int64_t& p, const int64_t& pi,
+                                const int64_t& m, const int64_t& mi)
 {
     long double logH = logC(pi, mi) + logC(p - pi, m - mi) - logC(p, m);
     return logH / log(10.0);
@@ -247,8 +281,8 @@ long double logHyperProbability(const long& p, const long& pi,
  * @return
  */
 /*
-long double logVarianceHyperProbability(const long& p, const long& pi,
-                                const long& m, const long& mi)
+long double logVarianceHyperProbability(const int64_t& p, const int64_t& pi,
+                                const int64_t& m, const int64_t& mi)
 {
     return logH / log(10.0);
 }
@@ -260,7 +294,7 @@ long double logVarianceHyperProbability(const long& p, const long& pi,
  * @param k
  * @return
  */
-long double logC(const long &n, const long &k)
+long double logC(const int64_t &n, const int64_t &k)
 {
     if(k == n || !k)
         return 0;
@@ -285,7 +319,7 @@ long double logC(const long &n, const long &k)
  * @param max
  * @return
  */
-long double sumRange(const long& min, const long& max)
+long double sumRange(const int64_t& min, const int64_t& max)
 {
     long double sum = 0.0;
     for(long double i = min; i <= max; ++i)
@@ -294,23 +328,48 @@ long double sumRange(const long& min, const long& max)
 }
 
 
+/**
+ * @brief logFactorialTable The exact sums of log(i) used by sumFactorial, summed in the same order so that
+ * the results are unchanged. The table doesn't depend on the graph, it is built once and shared by all threads.
+ * @return table[n] = log(2) + ... + log(n) for n <= 1000
+ */
+static const std::vector<long double>& logFactorialTable()
+{
+    struct Table
+    {
+        std::vector<long double> values;
+        Table() : values(1001, 0.0)
+        {
+            long double sum = 0.0;
+            for(int i = 2; i <= 1000; ++i)
+            {
+                sum += log(i);
+                values[i] = sum;
+            }
+        }
+    };
+    static const Table table; // thread safe initialization since C++11
+    return table.values;
+}
+
 /**
  * @brief sumFactorial
  * @param n
  * @return
  */
-long double sumFactorial(const long& n)
+long double sumFactorial(const int64_t& n)
 {
     if(n > 1000)
     {
         return n * log(n) - n;
     }
+    else if (n < 2)
+    {
+        return 0;
+    }
     else
     {
-        long double sum = 0.0;
-        for(int i = 2; i <= n; ++i)
-            sum += log(i);
-        return sum;
+        return logFactorialTable()[n];
     }
 }
 
@@ -343,8 +402,8 @@ bool sumLogProbabilities(const long double& nextLogP, long double& logP)
     return false;
 }
 
-long double computeConditionedSurprise(const long p, const long pi,
-                            const long m, const long mi, const long ni)
+long double computeConditionedSurprise(const int64_t p, const int64_t pi,
+                            const int64_t m, const int64_t mi, const int64_t ni)
 {
     try
     {
@@ -372,7 +431,7 @@ long double computeConditionedSurprise(const long p, const long pi,
  * @param drawnWhiteBalls
  * @return
  */
-long double cumulativeHyperGeometricDistribution(const long totalBallsInUrn, const long whiteBallsInUrn, const long drawnBalls, const long drawnWhiteBalls)
+long double cumulativeHyperGeometricDistribution(const int64_t totalBallsInUrn, const int64_t whiteBallsInUrn, const int64_t drawnBalls, const int64_t drawnWhiteBalls)
 {
     try
     {
@@ -63,8 +63,27 @@ PLoS ONE 6(9): e24195
 #ifndef SURPRISE_H
 #define SURPRISE_H
 
-bool checkArguments(const long p, const long pi,
-                    const long m, const long mi);
+#include <stdint.h>
+
+/**
+ * @brief checkedCount Convert an edge count accumulated in a double, as done by PartitionHelper, to a 64 bit integer
+ * @param x
+ * @param name name of the count, used in the error message
+ * @return x as an integer. Throws std::logic_error if x is negative, not finite or too big for 64 bits
+ */
+int64_t checkedCount(const double x, const char *name);
+
+/**
+ * @brief checkArguments Check the consistency of the hypergeometric parameters, all counts are 64 bit so that the
+ * number of vertex pairs of graphs with more than 46341 vertices doesn't overflow
+ * @param p
+ * @param pi
+ * @param m
+ * @param mi
+ * @return false if Surprise is trivially zero
+ */
+bool checkArguments(const int64_t p, const int64_t pi,
+                    const int64_t m, const int64_t mi);
 
 /**
  * @brief computeSurprise Receives the four parameters p, pi, m and mi and returns the value of Surprise
@@ -74,8 +93,14 @@ bool checkArguments(const long p, const long pi,
  * @param mi
  * @return
  */
-long double computeSurprise(const long p, const long pi,
-                            const long m, const long mi);
+long double computeSurprise(const int64_t p, const int64_t pi,
+                            const int64_t m, const int64_t mi);
+
+/**
+ * @brief surpriseTailTerms
+ * @return the number of hypergeometric terms summed by computeSurprise in the calling thread since it started
+ */
+uint64_t surpriseTailTerms();
 
 /**
  * @brief computeAsymptoticSurprise
@@ -85,7 +110,7 @@ long double computeSurprise(const long p, const long pi,
  * @param mi
  * @return
  */
-long double computeAsymptoticSurprise(const long p, const long pi, const long m, const long mi);
+long double computeAsymptoticSurprise(const int64_t p, const int64_t pi, const int64_t m, const int64_t mi);
 
 /**
  * @brief logHyperProbability Computes one term of the summation, (a single hypergeometric probability)
@@ -95,7 +120,7 @@ long double computeAsymptoticSurprise(const long p, const long pi, const long m,
  * @param j
  * @return
  */
-long double logHyperProbability(const long& F, const long& M, const long& n, const long& j);
+long double logHyperProbability(const int64_t& F, const int64_t& M, const int64_t& n, const int64_t& j);
 
 /**
  * @brief logC Computes log(n k)-logarithm of a binomial coefficient
@@ -103,7 +128,7 @@ long double logHyperProbability(const long& F, const long& M, const long& n, con
  * @param k
  * @return
  */
-long double logC(const long& n, const long& k);
+long double logC(const int64_t& n, const int64_t& k);
 
 /**
  * @brief sumRange Function needed to simplify the division of factorials
@@ -111,14 +136,14 @@ long double logC(const long& n, const long& k);
  * @param max
  * @return
  */
-long double sumRange(const long& min, const long& max);
+long double sumRange(const int64_t& min, const int64_t& max);
 
 /**
  * @brief sumFactorial Computes log(n!)
  * @param n
  * @return
  */
-long double sumFactorial(const long& n);
+long double sumFactorial(const int64_t& n);
 
 /**
  * @brief sumLogProbabilities Computes the sum of the past and current terms of the cumulative summation
@@ -137,8 +162,8 @@ bool sumLogProbabilities(const long double& nextLogP, long double& logP);
  * @param ni
  * @return
  */
-long double computeConditionedSurprise(const long p, const long pi,
-                            const long m, const long mi, const long ni);
+long double computeConditionedSurprise(const int64_t p, const int64_t pi,
+                            const int64_t m, const int64_t mi, const int64_t ni);
 
 /**
  * @brief cumulativeHyperGeometricDistribution
@@ -148,5 +173,5 @@ long double computeConditionedSurprise(const long p, const long pi,
  * @param drawnWhiteBalls
  * @return
  */
-long double cumulativeHyperGeometricDistribution(const long totalBallsInUrn, const long whiteBallsInUrn, const long drawnBalls, const long drawnWhiteBalls);
+long double cumulativeHyperGeometricDistribution(const int64_t totalBallsInUrn, const int64_t whiteBallsInUrn, const int64_t drawnBalls, const int64_t drawnWhiteBalls);
 #endif
@@ -0,0 +1,124 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include "ThresholdSweep.h"
+#include "Trace.h"
+
+/**
+ * @brief ThresholdSweep::ThresholdSweep Sorts the edges of g by decreasing weight, ties in edge order
+ * @param g
+ */
+ThresholdSweep::ThresholdSweep(const GraphC &g) : num_vertices(g.number_of_nodes())
+{
+    const size_t m = g.number_of_edges();
+    const EdgeWeights weights = g.get_weights();
+    sorted_edges.reserve(m);
+    for (size_t e=0; e<m; ++e)
+    {
+        std::pair<igraph_integer_t,igraph_integer_t> ends = g.get_edge(e);
+        sorted_edges.push_back(EdgeEdit(EdgeEdit::Insert,ends.first,ends.second,weights ? weights[e] : 1.0));
+    }
+    std::stable_sort(sorted_edges.begin(),sorted_edges.end(),
+                     [](const EdgeEdit &a, const EdgeEdit &b) { return a.weight > b.weight; });
+}
+
+/**
+ * @brief ThresholdSweep::run Optimizes the graph thresholded at every density
+ * @param densities fractions of the vertex pairs to keep as edges, in (0,1]. Every density keeps at most all the edges.
+ * @param qual
+ * @param method optimization method of the sparsest threshold
+ * @param nrep repetitions of the optimization of the sparsest threshold
+ * @param seed
+ * @return one step per density, in increasing density order
+ */
+std::vector<ThresholdStep> ThresholdSweep::run(const std::vector<double> &densities, QualityType qual, OptimizerType method, int nrep, int seed) const
+{
+    std::vector<double> sorted_densities(densities);
+    std::sort(sorted_densities.begin(),sorted_densities.end());
+    for (size_t i=0; i<sorted_densities.size(); ++i)
+    {
+        if (!(sorted_densities[i]>0 && sorted_densities[i]<=1))
+            throw std::logic_error("Threshold densities must be in (0,1]");
+    }
+
+    const double npairs = num_pairs(num_vertices);
+    GraphC work(num_vertices);
+    std::unique_ptr<CommunityStructure> comm;
+    std::vector<ThresholdStep> steps;
+    size_t num_edges = 0;
+    for (size_t i=0; i<sorted_densities.size(); ++i)
+    {
+        PACO_TRACE_SCOPE("threshold step");
+        size_t k = std::min(sorted_edges.size(),static_cast<size_t>(std::floor(sorted_densities[i]*npairs+0.5)));
+        ThresholdStep step;
+        step.density = sorted_densities[i];
+        step.num_edges = k;
+        step.min_weight = k>0 ? sorted_edges[k-1].weight : 0;
+        step.quality = 0;
+
+        std::vector<EdgeEdit> batch(sorted_edges.begin()+num_edges,sorted_edges.begin()+std::max(k,num_edges));
+        num_edges = std::max(k,num_edges);
+        std::vector<EdgeChange> changes = work.apply_edits(batch);
+        if (num_edges==0)
+        {
+            // No edges yet, every vertex in its own community
+            step.membership.resize(num_vertices);
+            for (size_t v=0; v<num_vertices; ++v)
+                step.membership[v] = v;
+            steps.push_back(step);
+            continue;
+        }
+
+        if (!comm)
+        {
+            comm.reset(new CommunityStructure(&work));
+            comm->set_random_seed(seed);
+            step.quality = comm->optimize(qual,method,nrep);
+        }
+        else
+            step.quality = comm->reoptimize(changes,qual);
+
+        step.membership.resize(num_vertices);
+        for (size_t v=0; v<num_vertices; ++v)
+            step.membership[v] = comm->get_membership(v);
+        renumber_first_appearance(&step.membership);
+        steps.push_back(step);
+    }
+    return steps;
+}
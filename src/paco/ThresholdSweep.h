@@ -0,0 +1,73 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+#ifndef _THRESHOLD_SWEEP_H_
+#define _THRESHOLD_SWEEP_H_
+
+#include <vector>
+#include "Graph.h"
+#include "Community.h"
+
+/**
+ * @brief Partition of the graph thresholded at one density of a ThresholdSweep
+ */
+struct ThresholdStep
+{
+    double density;        // fraction of the vertex pairs kept as edges
+    size_t num_edges;      // number of edges kept, the heaviest ones
+    double min_weight;     // weight of the lightest edge kept
+    double quality;
+    Membership membership; // communities numbered in order of first appearance
+};
+
+/**
+ * Proportional threshold sweep of a weighted graph. The edges are sorted by decreasing weight once,
+ * then a working graph is grown by inserting the edges of every threshold in batches. The partition
+ * of the sparsest threshold is optimized from singletons, every following one is re-optimized from
+ * the partition of the previous threshold with CommunityStructure::reoptimize, updating the partition
+ * aggregates only for the inserted edges.
+ */
+class ThresholdSweep
+{
+public:
+    ThresholdSweep(const GraphC &g);
+    std::vector<ThresholdStep> run(const std::vector<double> &densities, QualityType qual, OptimizerType method, int nrep=1, int seed=-1) const;
+
+private:
+    size_t num_vertices;
+    std::vector<EdgeEdit> sorted_edges; // insertions of all the edges by decreasing weight
+};
+
+#endif // _THRESHOLD_SWEEP_H_
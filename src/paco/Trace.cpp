@@ -0,0 +1,201 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include "Trace.h"
+
+// Events kept per thread, the older ones are overwritten
+static const size_t trace_capacity = 1<<16;
+
+/**
+ * @brief TraceBuffer::TraceBuffer
+ * @param tid thread id of the events in the exported trace
+ * @param capacity rounded up to a power of two
+ */
+TraceBuffer::TraceBuffer(uint32_t tid, size_t capacity) : head(0), tid(tid)
+{
+    size_t c = 1;
+    while (c<capacity)
+        c <<= 1;
+    events.resize(c);
+    mask = c-1;
+}
+
+/**
+ * @brief TraceBuffer::snapshot Appends the events in the ring, oldest first. Events recorded meanwhile by the
+ * owner thread may be torn, so it's meant to be called once the traced work is done.
+ * @param out
+ */
+void TraceBuffer::snapshot(std::vector<TraceEvent> &out) const
+{
+    const uint64_t h = head.load(std::memory_order_acquire);
+    const uint64_t first = h>events.size() ? h-events.size() : 0;
+    for (uint64_t i=first; i<h; ++i)
+        out.push_back(events[i & mask]);
+}
+
+/**
+ * @brief TraceBuffer::clear
+ */
+void TraceBuffer::clear()
+{
+    head.store(0,std::memory_order_release);
+}
+
+/**
+ * The buffers of all the threads, kept after the threads exit so that their events can be exported.
+ * A buffer released by an exited thread is reused by the next new thread, so that serving threads
+ * started per request don't grow the memory.
+ */
+struct TraceRegistry
+{
+    std::mutex mutex;
+    std::vector< std::unique_ptr<TraceBuffer> > buffers;
+    std::vector<TraceBuffer*> released;
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+};
+
+static TraceRegistry &trace_registry()
+{
+    static TraceRegistry registry;
+    return registry;
+}
+
+/**
+ * Owner of the buffer of a thread, releases it when the thread exits
+ */
+struct TraceBufferHolder
+{
+    TraceBuffer *buffer = NULL;
+    ~TraceBufferHolder()
+    {
+        if (buffer)
+        {
+            TraceRegistry &registry = trace_registry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.released.push_back(buffer);
+        }
+    }
+};
+
+/**
+ * @brief trace_now
+ * @return nanoseconds of the steady clock since the start of the trace
+ */
+int64_t trace_now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-trace_registry().epoch).count();
+}
+
+/**
+ * @brief trace_buffer Buffer of the calling thread, the lock is taken only at the first event of the thread
+ * @return
+ */
+TraceBuffer &trace_buffer()
+{
+    static thread_local TraceBufferHolder holder;
+    if (!holder.buffer)
+    {
+        TraceRegistry &registry = trace_registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        if (!registry.released.empty())
+        {
+            holder.buffer = registry.released.back();
+            registry.released.pop_back();
+        }
+        else
+        {
+            registry.buffers.push_back(std::unique_ptr<TraceBuffer>(new TraceBuffer(registry.buffers.size()+1,trace_capacity)));
+            holder.buffer = registry.buffers.back().get();
+        }
+    }
+    return *holder.buffer;
+}
+
+/**
+ * @brief trace_to_chrome_json
+ * @return the events of all the threads in the Chrome trace event format, viewable in chrome://tracing or Perfetto
+ */
+std::string trace_to_chrome_json()
+{
+    TraceRegistry &registry = trace_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    std::stringstream ss;
+    ss.precision(3);
+    ss << std::fixed << "{\"traceEvents\":[";
+    bool first = true;
+    std::vector<TraceEvent> events;
+    for (size_t b=0; b<registry.buffers.size(); ++b)
+    {
+        events.clear();
+        registry.buffers[b]->snapshot(events);
+        for (size_t i=0; i<events.size(); ++i)
+        {
+            ss << (first ? "\n" : ",\n") << "{\"name\":\"" << events[i].name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << registry.buffers[b]->get_tid()
+               << ",\"ts\":" << events[i].begin*1E-3 << ",\"dur\":" << (events[i].end-events[i].begin)*1E-3 << "}";
+            first = false;
+        }
+    }
+    ss << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return ss.str();
+}
+
+/**
+ * @brief write_chrome_trace Saves trace_to_chrome_json to filename
+ * @param filename
+ */
+void write_chrome_trace(const std::string &filename)
+{
+    std::ofstream out(filename.c_str());
+    if (!out.good())
+        throw std::ios_base::failure("Error, file " + filename + " can't be written");
+    out << trace_to_chrome_json();
+}
+
+/**
+ * @brief clear_trace Drops the events of all the threads, to be called when no traced work is running
+ */
+void clear_trace()
+{
+    TraceRegistry &registry = trace_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (size_t b=0; b<registry.buffers.size(); ++b)
+        registry.buffers[b]->clear();
+}
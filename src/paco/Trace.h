@@ -0,0 +1,118 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * A begin/end pair of a traced scope, in nanoseconds of the steady clock since the start of the trace.
+ * The name must be a string literal, only its pointer is stored.
+ */
+struct TraceEvent
+{
+    const char *name;
+    int64_t begin;
+    int64_t end;
+};
+
+/**
+ * @brief The TraceBuffer class is a ring of the last events of a thread. Only the owner thread writes, with a
+ * release store of the head, so recording takes no lock. When full the oldest events are overwritten.
+ */
+class TraceBuffer
+{
+public:
+    TraceBuffer(uint32_t tid, size_t capacity);
+    inline void record(const char *name, int64_t begin, int64_t end)
+    {
+        const uint64_t h = head.load(std::memory_order_relaxed);
+        TraceEvent &e = events[h & mask];
+        e.name = name;
+        e.begin = begin;
+        e.end = end;
+        head.store(h+1,std::memory_order_release);
+    }
+    void snapshot(std::vector<TraceEvent> &out) const;
+    void clear();
+    uint32_t get_tid() const
+    {
+        return tid;
+    }
+
+private:
+    std::vector<TraceEvent> events;
+    uint64_t mask;
+    std::atomic<uint64_t> head;
+    uint32_t tid;
+};
+
+int64_t trace_now();
+TraceBuffer &trace_buffer();
+std::string trace_to_chrome_json();
+void write_chrome_trace(const std::string &filename);
+void clear_trace();
+
+/**
+ * @brief The TraceScope class records the lifetime of a scope in the buffer of the calling thread
+ */
+class TraceScope
+{
+public:
+    explicit TraceScope(const char *name) : name(name), begin(trace_now()) {}
+    ~TraceScope()
+    {
+        trace_buffer().record(name,begin,trace_now());
+    }
+
+private:
+    const char *name;
+    int64_t begin;
+};
+
+// Tracing points of the library, compiled only with the TRACING option
+#define PACO_TRACE_CONCAT2(a,b) a##b
+#define PACO_TRACE_CONCAT(a,b) PACO_TRACE_CONCAT2(a,b)
+#ifdef PACO_TRACING
+#define PACO_TRACE_SCOPE(name) TraceScope PACO_TRACE_CONCAT(paco_trace_scope_,__LINE__)(name)
+#else
+#define PACO_TRACE_SCOPE(name)
+#endif
+
+#endif // _TRACE_H_
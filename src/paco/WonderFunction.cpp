@@ -62,9 +62,9 @@ void WonderFunction::eval(const PartitionHelper *par) const
     igraph_real_t pi = 0;
     igraph_real_t qi = 0;
 
-    for (CommMapCIter iter=par->get_communities().begin(); iter!=par->get_communities().end(); ++iter)
+    for (CommListCIter iter=par->get_communities().begin(); iter!=par->get_communities().end(); ++iter)
     {
-        size_t c = iter->first;
+        size_t c = *iter;
         igraph_real_t mc = par->get_incomm_weight().at(c);
         igraph_real_t nc = par->get_incomm_nvert().at(c);
         igraph_real_t pc = nc*(nc-1.0)/2.0;
@@ -35,6 +35,7 @@
 
 
 #include <algorithm>
+#include <thread>
 #include "igraph_utils.h"
 
 void igraph_matrix_view(igraph_matrix_t *A, igraph_real_t *data, int nrows, int ncols)
@@ -82,8 +83,69 @@ igraph_vector_t* order_membership(const igraph_vector_t *curmemb)
     return newmemb;
 }
 
+/**
+ * @brief membership_from_igraph Convert a membership vector of reals to the compact form used by the optimizers
+ * @param src
+ * @param dst resized to the length of src
+ */
+void membership_from_igraph(const igraph_vector_t *src, std::vector<uint32_t> &dst)
+{
+    long int n = igraph_vector_size(src);
+    dst.resize(n);
+    for (long int i=0; i<n; ++i)
+    {
+        igraph_real_t c = VECTOR(*src)[i];
+        if (!(c>=0 && c<=4294967295.0))
+            throw std::logic_error("Invalid community index in membership vector");
+        dst[i] = static_cast<uint32_t>(c);
+    }
+}
+
+/**
+ * @brief membership_to_igraph Convert a compact membership to a vector of reals, as returned to Matlab, Python or igraph
+ * @param src
+ * @param dst an initialized vector, resized to the length of src
+ */
+void membership_to_igraph(const std::vector<uint32_t> &src, igraph_vector_t *dst)
+{
+    IGRAPH_TRY(igraph_vector_resize(dst,src.size()));
+    for (size_t i=0; i<src.size(); ++i)
+        VECTOR(*dst)[i] = src[i];
+}
+
 // Implementation based on igraph original functions of the index of structural similarity described in
 // "Density-based shrinkage for revealing hierarchical and overlapping community structure in networks"
+/**
+ * @brief igraph_is_thread_safe
+ * @return true if igraph was built thread safe (./configure --enable-tls). Otherwise its error handling
+ * state is global and two threads must never be inside igraph at the same time.
+ */
+bool igraph_is_thread_safe()
+{
+#if IGRAPH_THREAD_SAFE
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief igraph_threads Number of threads that may call igraph concurrently
+ * @param requested 0 for all the cores
+ * @return requested, or the number of cores if 0. Without a thread safe igraph the default is a single
+ * thread, and asking for more throws std::logic_error.
+ */
+unsigned int igraph_threads(unsigned int requested)
+{
+    if (!igraph_is_thread_safe())
+    {
+        if (requested>1)
+            throw std::logic_error("More than one thread needs igraph built thread safe (./configure --enable-tls)");
+        return 1;
+    }
+    return requested ? requested : std::max(1U,std::thread::hardware_concurrency());
+}
+
 int igraph_i_neisets_intersect(const igraph_t *graph, const igraph_vector_t *v1, const igraph_vector_t *v2, const igraph_vector_t *weights, double *weight_union, double *weight_intersection)
 {
     std::vector<int> vv1 = std::vector<int>(v1->stor_begin,v1->stor_end);
@@ -38,8 +38,10 @@
 #define _IGRAPH_ADDITIONAL_UTILS_
 
 #include <vector>
+#include <stdint.h>
 #include <igraph.h>
 #include <igraph_error.h>
+#include <igraph_threading.h>
 #include <stdexcept>
 #include <sstream>
 
@@ -67,6 +69,14 @@ void igraph_matrix_view(igraph_matrix_t *A, igraph_real_t *data, int nrows, int
 
 igraph_vector_t* order_membership(const igraph_vector_t *curmemb);
 
+void membership_from_igraph(const igraph_vector_t *src, std::vector<uint32_t> &dst);
+
+void membership_to_igraph(const std::vector<uint32_t> &src, igraph_vector_t *dst);
+
+bool igraph_is_thread_safe();
+
+unsigned int igraph_threads(unsigned int requested);
+
 int igraph_similarity_jaccard_weighted_pairs(const igraph_t *graph, igraph_vector_t *res,
                                              const igraph_vector_t *pairs, const igraph_vector_t *weights, igraph_neimode_t mode, igraph_bool_t loops);
 
@@ -58,6 +58,7 @@
 #include "igraph_utils.h"
 #include "Graph.h"
 #include "Community.h"
+#include "ThresholdSweep.h"
 
 #include "RandomOptimizer.h"
 #include "AgglomerativeOptimizer.h"
@@ -119,6 +120,12 @@ void printUsage()
     mexPrintf("	val is the number of repetitions to run over which to choose the best quality value (the lowest for Infomap, the highest for the other methods\n");
     mexPrintf("[m, qual] = paco(W,'seed',val)\n");
     mexPrintf(" val is a specific random seed to the algorithm, in order to have reproducible results.\n");
+    mexPrintf("[m, qual] = paco(W,'time_budget',val)\n");
+    mexPrintf(" val is the time in milliseconds after which the best partition found so far is returned. Infomap ignores it.\n");
+    mexPrintf("[M, quals] = paco(W,'densities',vals)\n");
+    mexPrintf(" vals is a vector of graph densities in (0,1]. W is thresholded keeping the heaviest edges at every density and\n");
+    mexPrintf(" the partitions are computed in increasing density order, each one starting from the previous one.\n");
+    mexPrintf(" M is a (num_densities x n) matrix with a membership per row, quals the row vector of their qualities.\n");
     mexPrintf("\n\n");
     mexPrintf("Example:\n");
     mexPrintf("%Create a random symmetric thresholded network\n");
@@ -146,7 +153,7 @@ static const char *error_strings[] =
     "Not enough input arguments.",
     "Non valid argument value.",
     "Non valid argument type.",
-    "Non valid input adjacency matrix. PACO accepts symmetric real dense-type (n x n) matrices or sparse edges-list representation \
+    "Non valid input adjacency matrix. PACO accepts symmetric real dense or sparse (n x n) matrices or edges-list representation \
     [num_edges x 3] array of edges list with edge endpoints and weight.",
     "Expected some argument value but empty found.",
     "Unkwown argument."
@@ -159,6 +166,8 @@ struct PacoParams
     size_t nrep;      // Maximum number of consecutive repetitions to perform.
     int rand_seed; // random seed for the louvain algorithm
     int verbosity_level;
+    double time_budget; // milliseconds, no limit if not positive
+    std::vector<double> densities; // threshold sweep densities, empty to optimize W as it is
 };
 
 error_type parse_args(int nOutputArgs, mxArray *outputArgs[], int nInputArgs, const mxArray * inputArgs[], PacoParams *pars, int *argposerr )
@@ -181,7 +190,7 @@ error_type parse_args(int nOutputArgs, mxArray *outputArgs[], int nInputArgs, co
     int N = mxGetN(W);
     // In this case we are feeding instead of the adjacency matrix, the result of [i j w]=find(A);
     bool feedingSparseMatrix=false;
-    if (N==3 && M>3)
+    if (N==3 && M>3 && !mxIsSparse(W))
     {
         feedingSparseMatrix=true;
     }
@@ -251,6 +260,30 @@ error_type parse_args(int nOutputArgs, mxArray *outputArgs[], int nInputArgs, co
                 pars->rand_seed = static_cast<int>(std::floor(*mxGetPr(parval)));
                 argcount+=2;
             }
+            else if ( strcasecmp(cpartype,static_cast<const char*>("time_budget"))==0 )
+            {
+                pars->time_budget = *mxGetPr(parval);
+                if (pars->time_budget<0)
+                {
+                    *argposerr = argcount+1;
+                    return ERROR_ARG_VALUE;
+                }
+                argcount+=2;
+            }
+            else if ( strcasecmp(cpartype,static_cast<const char*>("densities"))==0 )
+            {
+                const double *d = mxGetPr(parval);
+                pars->densities.assign(d,d+mxGetNumberOfElements(parval));
+                for (size_t i=0; i<pars->densities.size(); ++i)
+                {
+                    if (!(pars->densities[i]>0 && pars->densities[i]<=1))
+                    {
+                        *argposerr = argcount+1;
+                        return ERROR_ARG_VALUE;
+                    }
+                }
+                argcount+=2;
+            }
             else if ( strcasecmp(cpartype,static_cast<const char*>("verbosity"))==0 )
             {
                 pars->verbosity_level = static_cast<int>(std::floor(*mxGetPr(parval)));
@@ -273,6 +306,15 @@ error_type parse_args(int nOutputArgs, mxArray *outputArgs[], int nInputArgs, co
 }
 
 
+/**
+ * @brief interrupt_pending Progress callback that stops the optimization when the user presses Ctrl+C
+ * @return false if Ctrl+C has been pressed
+ */
+static bool interrupt_pending(const OptimizerProgress &progress, void *data)
+{
+    return !utIsInterruptPending();
+}
+
 void mexFunction(int nOutputArgs, mxArray *outputArgs[], int nInputArgs, const mxArray * inputArgs[])
 {
     PacoParams pars;
@@ -282,6 +324,7 @@ void mexFunction(int nOutputArgs, mxArray *outputArgs[], int nInputArgs, const m
     pars.nrep = 2; // two are necessary
     pars.verbosity_level=7;
     pars.rand_seed = -1; // default value for the random seed, if -1 then microseconds time is used.
+    pars.time_budget = 0;
 
     FILELog::ReportingLevel() = static_cast<TLogLevel>(pars.verbosity_level);
 
@@ -308,7 +351,7 @@ void mexFunction(int nOutputArgs, mxArray *outputArgs[], int nInputArgs, const m
 
     // In this case we are feeding instead of the adjacency matrix, the result of [i j w]=find(A);
     bool feedingSparseMatrix=false;
-    if (M>3 && N==3)
+    if (M>3 && N==3 && !mxIsSparse(inputArgs[0]))
     {
         feedingSparseMatrix=true;
     }
@@ -374,14 +417,44 @@ void mexFunction(int nOutputArgs, mxArray *outputArgs[], int nInputArgs, const m
             
             G = new GraphC(edges_list.data(),edges_weights.data(),edges_weights.size());
         }
+        else if (mxIsSparse(inputArgs[0]))
+        {
+            // Matlab sparse matrices are stored by columns, that for a symmetric matrix is the same as by rows
+            G = new GraphC(static_cast<mwIndex>(N),mxGetJc(inputArgs[0]),mxGetIr(inputArgs[0]),mxGetPr(inputArgs[0]));
+        }
         else
         {
             G  = new GraphC(mxGetPr(inputArgs[0]),N,N);
         }
+        if (!pars.densities.empty())
+        {
+            std::vector<ThresholdStep> steps = ThresholdSweep(*G).run(pars.densities,pars.qual,pars.method,pars.nrep,pars.rand_seed);
+            size_t T = steps.size(), n = G->number_of_nodes();
+            // One membership per row, Matlab arrays are stored by columns
+            outputArgs[0] = mxCreateDoubleMatrix((mwSize)T,(mwSize)n, mxREAL);
+            outputArgs[1] = mxCreateDoubleMatrix(1,(mwSize)T, mxREAL);
+            double *memb = mxGetPr(outputArgs[0]);
+            double *quals = mxGetPr(outputArgs[1]);
+            for (size_t t=0; t<T; ++t)
+            {
+                for (size_t i=0; i<n; ++i)
+                    memb[t+T*i] = steps[t].membership[i];
+                quals[t] = steps[t].quality;
+            }
+            delete G;
+            return;
+        }
         // Create an instance of the optimizer
         CommunityStructure c(G);
         c.set_random_seed(pars.rand_seed);
+        c.set_time_budget(pars.time_budget);
+        c.set_progress_callback(interrupt_pending);
         double finalquality=c.optimize(pars.qual,pars.method,pars.nrep);
+        if (c.cancelled())
+        {
+            delete G;
+            mexErrMsgTxt("Operation terminated by user");
+        }
         // Prepare output
         outputArgs[0] = mxCreateDoubleMatrix(1,(mwSize)G->number_of_nodes(), mxREAL);
         // Copy the membership vector to outputArgs[0] which has been already preallocated
@@ -0,0 +1,370 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "Graph.h"
+#include "Community.h"
+#include "BenchmarkGraphs.h"
+#include "PartitionMetrics.h"
+#include "Timer.h"
+
+#if !(defined(WIN32) || defined(_WIN32) || defined(__WIN32__))
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <signal.h>
+#define PACO_FORK_RUNS
+#endif
+
+using namespace std;
+
+void exit_with_help()
+{
+    std::printf(
+                "Usage: paco_accuracy [options]\n"
+                "Accuracy versus time of every quality function and optimizer on synthetic graphs with a ground truth.\n"
+                "Runs every combination of generator, weighting, number of vertices, mixing, quality and method and\n"
+                "prints one tab separated line per run with wall time, peak resident memory in KB, quality, number of\n"
+                "communities and normalized mutual information with the ground truth.\n"
+                "options (lists are comma separated):\n"
+                "-g [generators] planted,lfr, default both\n"
+                "-n [nodes] list of numbers of vertices, default 1000,4000\n"
+                "-u [mixing] list of fractions of edges between communities, default 0.1,0.3,0.5\n"
+                "-w [weighted] list of 0 (binary) and 1 (weighted), default 0,1\n"
+                "-W [factor] weights between communities are scaled by factor in weighted graphs, default 0.5\n"
+                "-a [degree] average degree, default 20\n"
+                "-c [size] average community size of planted partitions, default 50\n"
+                "-q [qualities] list of quality functions, default 0,1,2,3\n"
+                "-m [methods] list of optimizers, default 0,1,2. Infomap runs once whatever the method\n"
+                "-r [repetitions] repetitions of every optimization, default 1\n"
+                "-S [seed] seed of the graphs and of the optimizers, default 1\n"
+                "-T [seconds] time limit of every run, default 60\n"
+                "\n"
+                );
+    exit(1);
+}
+
+struct AccuracyParams
+{
+    std::vector<std::string> generators;
+    std::vector<size_t> nodes;
+    std::vector<double> mixing;
+    std::vector<int> weighted;
+    std::vector<int> qualities;
+    std::vector<int> methods;
+    double inter_weight=0.5;
+    double avg_degree=20;
+    size_t community_size=50;
+    int nrep=1;
+    int seed=1;
+    unsigned int time_limit=60;
+};
+
+/**
+ * @brief split_list Splits a comma separated list
+ */
+template <class T>
+std::vector<T> split_list(const char *arg)
+{
+    std::vector<T> values;
+    std::stringstream ss(arg);
+    std::string token;
+    while (std::getline(ss,token,','))
+    {
+        std::stringstream ts(token);
+        T value;
+        if (!(ts >> value))
+            exit_with_help();
+        values.push_back(value);
+    }
+    if (values.empty())
+        exit_with_help();
+    return values;
+}
+
+AccuracyParams parse_command_line(int argc, char **argv)
+{
+    AccuracyParams params;
+    params.generators = split_list<std::string>("planted,lfr");
+    params.nodes = split_list<size_t>("1000,4000");
+    params.mixing = split_list<double>("0.1,0.3,0.5");
+    params.weighted = split_list<int>("0,1");
+    params.qualities = split_list<int>("0,1,2,3");
+    params.methods = split_list<int>("0,1,2");
+    for (int i=1; i<argc; i++)
+    {
+        if (argv[i][0] != '-' || ++i>=argc)
+            exit_with_help();
+        switch (argv[i-1][1])
+        {
+        case 'g':
+            params.generators = split_list<std::string>(argv[i]);
+            break;
+        case 'n':
+            params.nodes = split_list<size_t>(argv[i]);
+            break;
+        case 'u':
+            params.mixing = split_list<double>(argv[i]);
+            break;
+        case 'w':
+            params.weighted = split_list<int>(argv[i]);
+            break;
+        case 'W':
+            params.inter_weight = atof(argv[i]);
+            break;
+        case 'a':
+            params.avg_degree = atof(argv[i]);
+            break;
+        case 'c':
+            params.community_size = atoi(argv[i]);
+            break;
+        case 'q':
+            params.qualities = split_list<int>(argv[i]);
+            break;
+        case 'm':
+            params.methods = split_list<int>(argv[i]);
+            break;
+        case 'r':
+            params.nrep = atoi(argv[i]);
+            break;
+        case 'S':
+            params.seed = atoi(argv[i]);
+            break;
+        case 'T':
+            params.time_limit = atoi(argv[i]);
+            break;
+        default:
+            exit_with_help();
+        }
+    }
+    for (size_t i=0; i<params.generators.size(); ++i)
+        if (params.generators[i]!="planted" && params.generators[i]!="lfr")
+            exit_with_help();
+    for (size_t i=0; i<params.qualities.size(); ++i)
+        if (params.qualities[i]<QualitySurprise || params.qualities[i]>QualityInfoMap)
+            exit_with_help();
+    for (size_t i=0; i<params.methods.size(); ++i)
+        if (params.methods[i]<MethodAgglomerative || params.methods[i]>MethodAnneal)
+            exit_with_help();
+    return params;
+}
+
+/**
+ * Outcome of a single optimization
+ */
+struct RunResult
+{
+    std::string status="ok";
+    double time=0;
+    long peak_rss=-1; // KB, -1 if not measured
+    double quality=0;
+    double nmi=0;
+    size_t num_communities=0;
+};
+
+/**
+ * @brief optimize_benchmark Optimizes the graph and compares the partition with the ground truth.
+ * The time doesn't include the construction of the graph.
+ */
+RunResult optimize_benchmark(const BenchmarkGraph &bg, bool weighted, QualityType qual, OptimizerType method, int nrep, int seed)
+{
+    RunResult result;
+    std::unique_ptr<GraphC> g = bg.to_graph(weighted);
+    Timer timer;
+    timer.start();
+    CommunityStructure comm(g.get());
+    comm.set_random_seed(seed);
+    result.quality = comm.optimize(qual,method,nrep);
+    timer.stop();
+    result.time = timer.getElapsedTimeInSec();
+    comm.reindex_membership();
+    Membership memb(g->number_of_nodes());
+    for (size_t v=0; v<memb.size(); ++v)
+    {
+        memb[v] = comm.get_membership(v);
+        result.num_communities = std::max<size_t>(result.num_communities,memb[v]+1);
+    }
+    result.nmi = normalized_mutual_information(memb,bg.ground_truth);
+    return result;
+}
+
+/**
+ * @brief run_isolated Runs optimize_benchmark in a child process, so that its peak resident memory is measured alone,
+ * its output is discarded and it is stopped after the time limit
+ */
+RunResult run_isolated(const BenchmarkGraph &bg, bool weighted, QualityType qual, OptimizerType method, const AccuracyParams &pars)
+{
+#ifdef PACO_FORK_RUNS
+    int fds[2];
+    if (pipe(fds)!=0)
+        throw std::runtime_error("Error, can't create pipe");
+    cout.flush();
+    pid_t pid = fork();
+    if (pid<0)
+        throw std::runtime_error("Error, can't fork");
+    if (pid==0)
+    {
+        close(fds[0]);
+        if (!freopen("/dev/null","w",stdout))
+            _exit(2);
+        alarm(pars.time_limit);
+        std::stringstream ss;
+        ss.precision(12);
+        try
+        {
+            RunResult r = optimize_benchmark(bg,weighted,qual,method,pars.nrep,pars.seed);
+            ss << "ok " << r.time << " " << r.quality << " " << r.nmi << " " << r.num_communities;
+        }
+        catch (std::exception &e)
+        {
+            ss << "error " << e.what();
+        }
+        std::string msg = ss.str();
+        ssize_t written = write(fds[1],msg.data(),msg.size());
+        close(fds[1]);
+        _exit(written==(ssize_t)msg.size() ? 0 : 2);
+    }
+    close(fds[1]);
+    std::string msg;
+    char buf[1024];
+    ssize_t nread;
+    while ((nread = read(fds[0],buf,sizeof(buf)))>0)
+        msg.append(buf,nread);
+    close(fds[0]);
+    int status = 0;
+    struct rusage usage;
+    wait4(pid,&status,0,&usage);
+
+    RunResult result;
+#ifdef __APPLE__
+    result.peak_rss = usage.ru_maxrss/1024; // bytes on OSX
+#else
+    result.peak_rss = usage.ru_maxrss;
+#endif
+    std::stringstream ss(msg);
+    std::string head;
+    ss >> head;
+    if (WIFSIGNALED(status))
+        result.status = WTERMSIG(status)==SIGALRM ? "timeout" : "killed";
+    else if (head=="ok")
+        ss >> result.time >> result.quality >> result.nmi >> result.num_communities;
+    else if (head=="error")
+    {
+        std::getline(ss,result.status);
+        result.status = result.status.substr(result.status.find_first_not_of(' '));
+    }
+    else
+        result.status = "failed";
+    return result;
+#else
+    try
+    {
+        return optimize_benchmark(bg,weighted,qual,method,pars.nrep,pars.seed);
+    }
+    catch (std::exception &e)
+    {
+        RunResult result;
+        result.status = e.what();
+        return result;
+    }
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+    AccuracyParams pars = parse_command_line(argc,argv);
+    const char *method_names[] = {"Agglomerative", "Random", "Anneal"};
+    const char *quality_names[] = {"Surprise", "Significance", "AsymptoticSurprise", "Infomap"};
+
+    cout << "generator\tweighted\tnodes\tedges\tmixing\tquality\tmethod\ttime\tpeak_rss_kb\tvalue\tcommunities\tnmi\tstatus" << endl;
+    for (size_t gi=0; gi<pars.generators.size(); ++gi)
+    for (size_t ni=0; ni<pars.nodes.size(); ++ni)
+    for (size_t ui=0; ui<pars.mixing.size(); ++ui)
+    {
+        const size_t n = pars.nodes[ni];
+        BenchmarkGraph bg;
+        try
+        {
+            if (pars.generators[gi]=="planted")
+            {
+                size_t k = std::max<size_t>(1,n/std::max<size_t>(pars.community_size,1));
+                planted_partition_graph(n,k,pars.avg_degree/(n-1),pars.mixing[ui],pars.seed,&bg);
+            }
+            else
+            {
+                LFRParams lfr;
+                lfr.num_nodes = n;
+                lfr.mixing = pars.mixing[ui];
+                lfr.avg_degree = pars.avg_degree;
+                lfr.max_degree = std::min<size_t>(n-1,static_cast<size_t>(2.5*pars.avg_degree));
+                lfr.min_community = std::min<size_t>(n,pars.community_size/2);
+                lfr.max_community = std::min<size_t>(n,2*pars.community_size);
+                lfr_graph(lfr,pars.seed,&bg);
+            }
+        }
+        catch (std::invalid_argument &e)
+        {
+            cerr << pars.generators[gi] << " n=" << n << " mixing=" << pars.mixing[ui] << ": " << e.what() << endl;
+            continue;
+        }
+        set_benchmark_weights(&bg,pars.inter_weight,pars.seed);
+
+        for (size_t wi=0; wi<pars.weighted.size(); ++wi)
+        for (size_t qi=0; qi<pars.qualities.size(); ++qi)
+        for (size_t mi=0; mi<pars.methods.size(); ++mi)
+        {
+            QualityType qual = static_cast<QualityType>(pars.qualities[qi]);
+            OptimizerType method = static_cast<OptimizerType>(pars.methods[mi]);
+            if (qual==QualityInfoMap && mi>0)
+                continue; // Infomap has its own optimizer
+            RunResult r = run_isolated(bg,pars.weighted[wi]!=0,qual,method,pars);
+            cout << pars.generators[gi] << "\t" << pars.weighted[wi] << "\t" << n << "\t" << bg.num_edges() << "\t"
+                 << bg.mixing() << "\t" << quality_names[qual] << "\t" << (qual==QualityInfoMap ? "-" : method_names[method]) << "\t"
+                 << r.time << "\t" << r.peak_rss << "\t" << r.quality << "\t" << r.num_communities << "\t" << r.nmi << "\t" << r.status << endl;
+        }
+    }
+    return 0;
+}
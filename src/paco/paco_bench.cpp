@@ -0,0 +1,266 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <memory>
+#include <stdexcept>
+#include <cstdio>
+#include <cstdlib>
+#include <stdint.h>
+
+#include "Graph.h"
+#include "GraphContext.h"
+#include "PartitionHelper.h"
+#include "Surprise.h"
+#include "KLDivergence.h"
+#include "SurpriseFunction.h"
+#include "SignificanceFunction.h"
+#include "AsymptoticSurpriseFunction.h"
+#include "Timer.h"
+#include "BenchmarkGraphs.h"
+
+using namespace std;
+
+void exit_with_help()
+{
+    std::printf(
+                "Usage: paco_bench [options]\n"
+                "Micro-benchmarks of the quality functions and of PartitionHelper on a synthetic planted partition graph.\n"
+                "Prints one tab separated line per benchmark: name, arguments, iterations and nanoseconds per operation.\n"
+                "options:\n"
+                "-n [nodes] number of vertices, default 2000\n"
+                "-d [density] fraction of the vertex pairs that are edges, default 0.02\n"
+                "-k [communities] number of planted communities, default 20\n"
+                "-u [mixing] fraction of the edges between communities, default 0.2\n"
+                "-t [seconds] minimum time of every benchmark, default 0.2\n"
+                "-f [filter] run only the benchmarks whose name contains filter\n"
+                "-S [seed] random seed of the graph, default 1\n"
+                "\n"
+                );
+    exit(1);
+}
+
+struct BenchParams
+{
+    size_t num_nodes=2000;
+    double density=0.02;
+    size_t num_communities=20;
+    double mixing=0.2;
+    double min_time=0.2;
+    std::string filter="";
+    unsigned int seed=1;
+};
+
+BenchParams parse_command_line(int argc, char **argv)
+{
+    BenchParams params;
+    for (int i=1; i<argc; i++)
+    {
+        if (argv[i][0] != '-' || ++i>=argc)
+            exit_with_help();
+        switch (argv[i-1][1])
+        {
+        case 'n':
+            params.num_nodes = atoi(argv[i]);
+            break;
+        case 'd':
+            params.density = atof(argv[i]);
+            break;
+        case 'k':
+            params.num_communities = atoi(argv[i]);
+            break;
+        case 'u':
+            params.mixing = atof(argv[i]);
+            break;
+        case 't':
+            params.min_time = atof(argv[i]);
+            break;
+        case 'f':
+            params.filter = std::string(argv[i]);
+            break;
+        case 'S':
+            params.seed = atoi(argv[i]);
+            break;
+        default:
+            exit_with_help();
+        }
+    }
+    if (params.num_nodes<2 || params.num_communities<1 || params.num_communities>params.num_nodes
+            || !(params.density>0 && params.density<=1) || !(params.mixing>=0 && params.mixing<=1))
+        exit_with_help();
+    return params;
+}
+
+static BenchParams params;
+static volatile double sink; // keeps the results of the benchmarked operations alive
+
+/**
+ * @brief bench Times op, running it in batches of growing size until a batch takes at least the minimum time
+ * @param name
+ * @param args
+ * @param op called with the iteration number, returns a value that is accumulated
+ */
+template <class Op>
+void bench(const std::string &name, const std::string &args, Op op)
+{
+    if (!params.filter.empty() && name.find(params.filter)==std::string::npos)
+        return;
+    size_t iters = 1;
+    double elapsed = 0;
+    while (true)
+    {
+        Timer timer;
+        timer.start();
+        double acc = 0;
+        for (size_t i=0; i<iters; ++i)
+            acc += op(i);
+        timer.stop();
+        elapsed = timer.getElapsedTimeInSec();
+        sink = acc;
+        if (elapsed>=params.min_time)
+            break;
+        // Aim a bit above the minimum time, at most 100 times more iterations than the last batch
+        double scale = elapsed>0 ? 1.2*params.min_time/elapsed : 100;
+        iters = static_cast<size_t>(iters*std::min(100.0,std::max(2.0,scale)));
+    }
+    cout << name << "\t" << args << "\t" << iters << "\t" << elapsed*1E9/iters << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    params = parse_command_line(argc,argv);
+
+    BenchmarkGraph bg;
+    try
+    {
+        planted_partition_graph(params.num_nodes,params.num_communities,params.density,params.mixing,params.seed,&bg);
+        set_benchmark_weights(&bg,1.0,params.seed);
+    }
+    catch (std::invalid_argument &e)
+    {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    const Membership &planted = bg.ground_truth;
+    std::unique_ptr<GraphC> binary_graph = bg.to_graph(false), weighted_graph = bg.to_graph(true);
+    const GraphC &binary = *binary_graph, &weighted = *weighted_graph;
+    std::shared_ptr<const GraphContext> binary_ctx = std::make_shared<const GraphContext>(binary);
+    std::shared_ptr<const GraphContext> weighted_ctx = std::make_shared<const GraphContext>(weighted);
+    const size_t n = binary.number_of_nodes(), m = binary.number_of_edges();
+
+    cout << "# nodes=" << n << " edges=" << m << " communities=" << params.num_communities
+         << " mixing=" << params.mixing << " seed=" << params.seed << endl;
+    cout << "benchmark\targs\titerations\tns_per_op" << endl;
+
+    // Surprise and KL over regimes of sparse and dense graphs, small and large partitions
+    PartitionHelper planted_par;
+    planted_par.init(binary_ctx,&planted);
+    const int64_t regimes[][4] = {
+        {static_cast<int64_t>(planted_par.get_graph_total_pairs()), static_cast<int64_t>(planted_par.get_total_incomm_pairs()),
+         static_cast<int64_t>(m), static_cast<int64_t>(planted_par.get_total_incomm_weight())},
+        {4950, 450, 500, 300},                         // small graph
+        {499999500000LL, 4999995000LL, 5000000, 4000000}, // million vertices, sparse
+        {1999000, 999000, 1500000, 800000},            // dense graph
+        {1999000, 10000, 20000, 9000}                  // few dense communities
+    };
+    for (size_t r=0; r<sizeof(regimes)/sizeof(regimes[0]); ++r)
+    {
+        const int64_t *a = regimes[r];
+        char args[256];
+        std::sprintf(args,"p=%lld,pi=%lld,m=%lld,mi=%lld",(long long)a[0],(long long)a[1],(long long)a[2],(long long)a[3]);
+        bench("computeSurprise",args,[&](size_t i) { return (double)computeSurprise(a[0],a[1],a[2],a[3]-(int64_t)(i&1)); });
+    }
+    const double kl_args[][2] = { {0.3,0.01}, {0.999,0.5}, {1E-6,1E-3} };
+    for (size_t r=0; r<sizeof(kl_args)/sizeof(kl_args[0]); ++r)
+    {
+        char args[256];
+        std::sprintf(args,"q=%g,p=%g",kl_args[r][0],kl_args[r][1]);
+        bench("KL",args,[&](size_t i) { return KL(kl_args[r][0]*(1-1E-12*(i&1)),kl_args[r][1]); });
+    }
+
+    // Quality functions on the planted partition, from the aggregates and from scratch
+    SurpriseFunction surprise;
+    SignificanceFunction significance;
+    AsymptoticSurpriseFunction asymptotic_surprise;
+    PartitionHelper weighted_par;
+    weighted_par.init(weighted_ctx,&planted,weighted.get_weights());
+    bench("SurpriseFunction::eval(par)","binary",[&](size_t) { return surprise(&planted_par); });
+    bench("SignificanceFunction::eval(par)","binary",[&](size_t) { return significance(&planted_par); });
+    bench("AsymptoticSurpriseFunction::eval(par)","weighted",[&](size_t) { return asymptotic_surprise(&weighted_par); });
+    bench("SurpriseFunction::eval(g,memb)","binary",[&](size_t) { return surprise(binary.get_igraph(),planted); });
+    bench("SignificanceFunction::eval(g,memb)","binary",[&](size_t) { return significance(binary.get_igraph(),planted); });
+    bench("AsymptoticSurpriseFunction::eval(g,memb)","weighted",[&](size_t) { return asymptotic_surprise(weighted.get_igraph(),planted,weighted.get_weights()); });
+
+    // PartitionHelper construction, on the igraph and on a shared context
+    PartitionHelper par;
+    bench("PartitionHelper::init","igraph,weighted",[&](size_t) { par.init(weighted.get_igraph(),&planted,weighted.get_weights()); return par.get_total_incomm_weight(); });
+    bench("PartitionHelper::init","context,weighted",[&](size_t) { par.init(weighted_ctx,&planted,weighted.get_weights()); return par.get_total_incomm_weight(); });
+    bench("PartitionHelper::reset","context,weighted",[&](size_t) { par.reset(&planted,weighted.get_weights()); return par.get_total_incomm_weight(); });
+
+    // Moves of random vertices to the community of a random neighbor, as the agglomerative optimizer does
+    const size_t nmoves = 1<<16;
+    vector<std::pair<int,int> > moves(nmoves);
+    std::mt19937 gen(params.seed);
+    std::uniform_int_distribution<size_t> edge(0,m-1);
+    for (size_t i=0; i<nmoves; ++i)
+    {
+        size_t e = edge(gen);
+        moves[i] = std::make_pair((int)bg.sources[e],(int)bg.targets[e]);
+    }
+    const char *modes[] = {"igraph,weighted", "context,weighted"};
+    for (int mode=0; mode<2; ++mode)
+    {
+        Membership memb(planted);
+        if (mode==0)
+            par.init(weighted.get_igraph(),&memb,weighted.get_weights());
+        else
+            par.init(weighted_ctx,&memb,weighted.get_weights());
+        bench("PartitionHelper::move_vertex",modes[mode],[&](size_t i) {
+            const std::pair<int,int> &mv = moves[i%nmoves];
+            return (double)par.move_vertex(weighted.get_igraph(),&memb,mv.first,memb[mv.second],weighted.get_weights());
+        });
+        memb = planted;
+        par.reset(&memb,weighted.get_weights());
+        bench("PartitionHelper::weight_to_from_community",modes[mode],[&](size_t i) {
+            const std::pair<int,int> &mv = moves[i%nmoves];
+            return par.weight_to_from_community(weighted.get_igraph(),&memb,mv.first,memb[mv.second],IGRAPH_ALL,weighted.get_weights());
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,146 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+#include <cmath>
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+
+#include "Common.h"
+#include "PartitionMetrics.h"
+
+#ifdef __linux__
+#include <mex.h>
+#endif
+
+#ifdef __APPLE__
+#include "mex.h"
+#endif
+
+
+#ifdef WIN32
+#include <mex.h>
+#endif
+
+using namespace std;
+
+void printUsage()
+{
+    mexPrintf("PACO partition comparison.\n");
+    mexPrintf("[nmi, vi, ari, jaccard] = paco_compare(A, b);\n");
+    mexPrintf("Input:\n");
+    mexPrintf("	A: a membership vector of n vertices, or a matrix with one membership vector per row, as the memberships of the repetitions of a stability analysis.\n");
+    mexPrintf("	b: the reference membership vector of the same n vertices. Communities are labeled by nonnegative integers, not necessarily consecutive.\n");
+    mexPrintf("Output, one value per row of A:\n");
+    mexPrintf("	nmi: normalized mutual information, 1 for identical partitions.\n");
+    mexPrintf("	vi: variation of information in nats, 0 for identical partitions.\n");
+    mexPrintf("	ari: adjusted Rand index, 1 for identical partitions and close to 0 for independent ones.\n");
+    mexPrintf("	jaccard: Jaccard index of the pairs of vertices in the same community.\n");
+    mexPrintf("The rows of A are compared in parallel.\n");
+}
+
+/**
+ * @brief to_membership Copies the labels at stride step from values, throwing if they are not nonnegative integers
+ */
+static Membership to_membership(const double *values, size_t n, size_t step)
+{
+    Membership m(n);
+    for (size_t v=0; v<n; ++v)
+    {
+        double x = values[v*step];
+        if (x<0 || x!=std::floor(x) || x>4294967295.0)
+            throw std::invalid_argument("Membership labels must be nonnegative integers");
+        m[v] = static_cast<uint32_t>(x);
+    }
+    return m;
+}
+
+void mexFunction(int nOutputArgs, mxArray *outputArgs[], int nInputArgs, const mxArray * inputArgs[])
+{
+    if (nInputArgs!=2 || !mxIsDouble(inputArgs[0]) || !mxIsDouble(inputArgs[1]) || mxIsSparse(inputArgs[0]) || mxIsSparse(inputArgs[1]))
+    {
+        printUsage();
+        mexErrMsgTxt("Two full double membership arguments are required");
+    }
+    if (nOutputArgs>4)
+        mexErrMsgTxt("At most four outputs: nmi, vi, ari, jaccard");
+
+    try
+    {
+        const size_t n = mxGetNumberOfElements(inputArgs[1]);
+        Membership reference = to_membership(mxGetPr(inputArgs[1]),n,1);
+
+        // A single membership vector, in any orientation, or one membership per row
+        const double *A = mxGetPr(inputArgs[0]);
+        size_t k = 1, stride = 1;
+        if (mxGetNumberOfElements(inputArgs[0])!=n)
+        {
+            if (mxGetN(inputArgs[0])!=n)
+                throw std::invalid_argument("The memberships in A must have as many vertices as b");
+            k = mxGetM(inputArgs[0]);
+            stride = k; // column-major, the vertices of a row are k elements apart
+        }
+        std::vector<Membership> partitions;
+        partitions.reserve(k);
+        for (size_t i=0; i<k; ++i)
+            partitions.push_back(to_membership(A+i,n,stride));
+
+        std::vector<PartitionComparison> c = compare_partitions(partitions,reference);
+
+        double *out[4];
+        for (int o=0; o<4; ++o)
+        {
+            if (o>0 && o>=nOutputArgs)
+                break;
+            outputArgs[o] = mxCreateDoubleMatrix((mwSize)k,1,mxREAL);
+            out[o] = mxGetPr(outputArgs[o]);
+        }
+        for (size_t i=0; i<k; ++i)
+        {
+            out[0][i] = c[i].nmi;
+            if (nOutputArgs>1)
+                out[1][i] = c[i].vi;
+            if (nOutputArgs>2)
+                out[2][i] = c[i].ari;
+            if (nOutputArgs>3)
+                out[3][i] = c[i].jaccard;
+        }
+    }
+    catch (std::exception &e)
+    {
+        cerr << e.what() << endl;
+        mexErrMsgTxt(e.what());
+    }
+}
@@ -0,0 +1,114 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2016 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*
+* If you use PACO for you publication please cite:
+*
+* "Modular structure of brain functional networks: breaking the resolution limit by Surprise"
+* C. Nicolini and A. Bifone, Scientific Reports
+* doi:10.1038/srep19250
+*
+* "Community detection in weighted brain connectivity networks beyond the resolution limit", 
+* C.Nicolini. C.Bordier, A.Bifone, arxiv 1609.04316
+* https://arxiv.org/abs/1609.04316
+*/
+
+
+#include <cstdlib>
+#include "Graph.h"
+
+using namespace std;
+
+void exit_with_help()
+{
+    std::printf(
+                "Usage: paco_convert [options] input_graph_file output_file.pacobin\n"
+                "Convert a graph to the native PACO binary format, that is memory mapped at load time without any parsing.\n"
+                "input_graph_file is any format accepted by paco_optimizer: pajek (net), graph_ml (gml), adjacency matrix (adj),\n"
+                "edges list (ncol), weighted edges list (wncol) or another pacobin file.\n"
+                "options:\n"
+                "-f [bool] store edge weights in single precision (float32), default 0\n"
+                "-p [print graph info]\n"
+                "\n"
+                );
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    bool float32_weights = false;
+    bool print_info = false;
+    int i=1;
+    for(i=1; i<argc; i++)
+    {
+        if(argv[i][0] != '-')
+            break;
+        if(++i>=argc)
+            exit_with_help();
+        switch(argv[i-1][1])
+        {
+        case 'f':
+        case 'F':
+        {
+            float32_weights = (bool)atoi(argv[i]);
+            break;
+        }
+        case 'p':
+        case 'P':
+        {
+            print_info = (bool)atoi(argv[i]);
+            break;
+        }
+        default:
+            FILE_LOG(logERROR) << "Unknown option: " << argv[i-1][1] ;
+            exit_with_help();
+        }
+    }
+    if (i+1 >= argc)
+        exit_with_help();
+
+    string input(argv[i]);
+    string output(argv[i+1]);
+
+    try
+    {
+        GraphC g;
+        if (!g.read(input))
+        {
+            cerr << "Non supported graph format" << endl;
+            exit_with_help();
+        }
+        if (print_info)
+        {
+            FILELog::ReportingLevel() =  logINFO;
+            g.info();
+        }
+        g.write_binary(output,float32_weights);
+    }
+    catch (std::exception &e)
+    {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
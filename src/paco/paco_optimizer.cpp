@@ -34,8 +34,24 @@
 */
 
 
+#include <cmath>
+#include <sstream>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
 #include "Graph.h"
 #include "Community.h"
+#include "PartitionInitializer.h"
+#include "ThresholdSweep.h"
+#include "RepetitionRace.h"
+#include "ConsensusClustering.h"
+#include "Timer.h"
+#include "PacoServer.h"
+#include "Trace.h"
+#include "igraph_utils.h"
 
 using namespace std;
 
@@ -45,8 +61,11 @@ void exit_with_help()
 {
     std::printf(
                 "Usage: paco_optimizer graph_file [options]\n"
+                "       paco_optimizer [options] --batch manifest_file [--jobs threads]\n"
+                "       paco_optimizer --daemon socket_file [--cache graphs]\n"
                 "graph_file the file containing the graph. Accepted formats are pajek, graph_ml, adjacency matrix or"
-                "\nedges list (the ncol format), additionally with a third column with edge weights"
+                "\nedges list (the ncol format), additionally with a third column with edge weights (wncol),"
+                "\nor the native binary format (pacobin) created by paco_convert\n"
                 "options:\n"
                 "-q [quality]\n"
                 "   0 Binary Surprise\n"
@@ -64,9 +83,41 @@ void exit_with_help()
                 "   2 Simulated Annealing\n"
                 "-V [report_level] ERROR=0, WARNING=1, INFO=2, DEBUG=3, DEBUG1=4, DEBUG2=5, DEBUG3=6, DEBUG4=7\n"
                 "-S [seed] specify the random seed, default time(0)\n"
-                "-b [bool] wheter to start with initial random cluster or every node in its community\n"
+                "-b [initializer] initial partition the optimizer starts from:\n"
+                "   0 Every node in its community (default)\n"
+                "   1 Random clusters, see -k\n"
+                "   2 Membership file, see -i\n"
+                "   3 Label propagation, see -j\n"
+                "-k [clusters] number of initial random clusters, default sqrt(number of nodes)\n"
+                "-i [file] initial membership file, one community per line\n"
+                "-j [threads] number of label propagation threads, default all cores\n"
+                "-t [densities] proportional threshold sweep over comma separated densities, as 0.05,0.1,0.2\n"
+                "   Prints density, number of edges, weight threshold and quality for every density and saves\n"
+                "   the memberships as one column per density\n"
                 "-r [repetitions], number of repetitions of PACO, default=1\n"
+                "-l [milliseconds] time budget of the optimization, after which the best partition found so far\n"
+                "   is returned, default no limit. Infomap ignores it\n"
                 "-p [print solution]\n"
+                "-f [bool] store the edge weights in single precision, halving their memory, default 0\n"
+                "--batch [manifest_file] optimizes many graphs, one per line of the manifest as\n"
+                "   graph_file membership_file [options]\n"
+                "   the options of the command line are the defaults of every line. Prints a summary table\n"
+                "--jobs [threads] number of graphs optimized concurrently in batch mode, or of racing repetitions,\n"
+                "   default all cores, or 1 if igraph isn't built thread safe (--enable-tls)\n"
+                "--race [margin] runs the repetitions of a single graph in parallel, each one from singletons, and\n"
+                "   abandons those whose quality trails the best one at the same stage by more than the fraction margin,\n"
+                "   as 0.05, starting new ones in their place. -r counts the abandoned repetitions too\n"
+                "--consensus [threshold] consensus clustering: rounds of -r parallel repetitions, each one on the graph of\n"
+                "   the edges whose endpoints were put together by at least the fraction threshold of the previous round,\n"
+                "   as 0.5, until the repetitions agree\n"
+                "--passes [passes] optimizer passes of every racing or consensus repetition, each one from the partition\n"
+                "   of the previous one, default 1\n"
+                "--daemon [socket_file] serves optimize requests on a Unix domain socket, keeping the graphs read in memory\n"
+                "--cache [graphs] number of graphs kept in memory in daemon mode, default 8\n"
+                "--counters [json_file] saves the counters of moves and quality evaluations and the time of every phase\n"
+                "   of the optimization. In batch mode every graph gets its own membership_file.counters.json\n"
+                "--trace [json_file] saves the phases of the run of every thread in the Chrome trace format,\n"
+                "   PACO must be compiled with the TRACING option\n"
                 "\n"
                 );
     exit(1);
@@ -103,35 +154,51 @@ struct PacoParams
     QualityType qual=QualitySurprise;
     size_t nrep=1;      // Maximum number of consecutive repetitions to perform.
     int rand_seed=-1; // random seed for the louvain algorithm
+    bool seed_given=false;
     int verbosity_level=0;
     std::string membership_file="membership.txt";
     std::string filename="";
     bool print_info=false;
+    bool float32_weights=false;
+    int initializer=0;
+    size_t init_clusters=0; // 0 for sqrt(number of nodes)
+    std::string init_membership_file="";
+    unsigned int init_threads=0;
+    std::vector<double> densities; // threshold sweep, if not empty
+    std::string batch_file="";
+    unsigned int batch_jobs=0; // 0 for all the cores, or one if igraph isn't thread safe
+    std::string daemon_socket="";
+    size_t cache_graphs=8;
+    std::string counters_file=""; // JSON dump of the optimizer counters, if not empty
+    std::string trace_file=""; // Chrome trace of the run, if not empty
+    double time_budget=0; // milliseconds, no limit if not positive
+    double race_margin=-1; // of the racing repetitions, no race if negative
+    double consensus_threshold=0; // of consensus clustering, no consensus if zero
+    size_t passes=1; // of every racing or consensus repetition
 };
 
 /**
- * @brief parse_command_line
- * @param argc
- * @param argv
- * @param input_file_name
+ * @brief parse_options Parses the options in args up to the first argument which is not an option
+ * @param args
+ * @param params the parsed options are set here, the others are kept
+ * @return the position of the first argument which is not an option
  */
-PacoParams parse_command_line(int argc, char **argv)
+size_t parse_options(const std::vector<std::string> &args, PacoParams &params)
 {
-    PacoParams params;
-
-    int i=1;
-    for(i=1; i<argc; i++)
+    size_t i=0;
+    for(i=0; i<args.size(); i++)
     {
-        if(argv[i][0] != '-')
+        if(args[i].size()<2 || args[i][0] != '-')
             break;
-        if(++i>=argc)
-            exit_with_help();
-        switch(argv[i-1][1])
+        if(++i>=args.size())
+            throw std::invalid_argument("Missing value of option " + args[i-1]);
+        const char *arg = args[i].c_str();
+        switch(args[i-1][1])
         {
         case 'v':
         case 'V':
         {
-            params.verbosity_level = atoi(argv[i]);
+            params.verbosity_level = atoi(arg);
             if (params.verbosity_level>7)
                 params.verbosity_level=7;
             FILELog::ReportingLevel() =  static_cast<TLogLevel>(params.verbosity_level);
@@ -140,13 +207,14 @@ PacoParams parse_command_line(int argc, char **argv)
         case 's':
         case 'S':
         {
-            params.rand_seed = atoi(argv[i]);
+            params.rand_seed = atoi(arg);
+            params.seed_given = true;
             break;
         }
         case 'q':
         case 'Q':
         {
-            switch (atoi(argv[i]))
+            switch (atoi(arg))
             {
             case 0:
             {
@@ -171,7 +239,7 @@ PacoParams parse_command_line(int argc, char **argv)
             }
             default:
             {
-                exit_with_help();
+                throw std::invalid_argument("Non valid quality " + args[i]);
             }
             }
             break;
@@ -179,42 +247,173 @@ PacoParams parse_command_line(int argc, char **argv)
         case 'm':
         case 'M':
         {
-            params.method = static_cast<OptimizerType>(atoi(argv[i]));
+            params.method = static_cast<OptimizerType>(atoi(arg));
             break;
         }
         case 'r':
         case 'R':
         {
-            params.nrep = atoi(argv[i]);
+            params.nrep = atoi(arg);
             break;
         }
         case 'o':
         case 'O':
         {
-            params.membership_file = std::string(argv[i]);
+            params.membership_file = std::string(arg);
             break;
         }
         case 'p':
         case 'P':
         {
-            params.print_info = (bool)atoi(argv[i]);
+            params.print_info = (bool)atoi(arg);
+            break;
+        }
+        case 'f':
+        case 'F':
+        {
+            params.float32_weights = (bool)atoi(arg);
+            break;
+        }
+        case 'b':
+        case 'B':
+        {
+            params.initializer = atoi(arg);
+            if (params.initializer<0 || params.initializer>3)
+                throw std::invalid_argument("Non valid initializer " + args[i]);
+            break;
+        }
+        case 'k':
+        case 'K':
+        {
+            params.init_clusters = atoi(arg);
+            break;
+        }
+        case 'i':
+        case 'I':
+        {
+            params.init_membership_file = std::string(arg);
+            break;
+        }
+        case 'j':
+        case 'J':
+        {
+            params.init_threads = atoi(arg);
+            break;
+        }
+        case 'l':
+        case 'L':
+        {
+            params.time_budget = atof(arg);
+            break;
+        }
+        case 't':
+        case 'T':
+        {
+            std::stringstream ss(arg);
+            std::string token;
+            while (std::getline(ss,token,','))
+                params.densities.push_back(atof(token.c_str()));
+            if (params.densities.empty())
+                throw std::invalid_argument("Non valid densities " + args[i]);
             break;
         }
         default:
-            FILE_LOG(logERROR) << "Unknown option: " << argv[i-1][1] ;
+            throw std::invalid_argument("Unknown option: " + args[i-1]);
+        }
+    }
+    return i;
+}
+
+/**
+ * @brief parse_command_line
+ * @param argc
+ * @param argv
+ * @param input_file_name
+ */
+PacoParams parse_command_line(int argc, char **argv)
+{
+    PacoParams params;
+
+    // Batch options first, they can be anywhere
+    std::vector<std::string> args;
+    for (int k=1; k<argc; ++k)
+    {
+        std::string a(argv[k]);
+        if ((a=="--batch" || a=="--jobs" || a=="--daemon" || a=="--cache" || a=="--counters" || a=="--trace" || a=="--race" || a=="--consensus" || a=="--passes") && k+1>=argc)
             exit_with_help();
+        if (a=="--batch")
+            params.batch_file = argv[++k];
+        else if (a=="--jobs")
+            params.batch_jobs = atoi(argv[++k]);
+        else if (a=="--daemon")
+            params.daemon_socket = argv[++k];
+        else if (a=="--cache")
+            params.cache_graphs = atoi(argv[++k]);
+        else if (a=="--counters")
+            params.counters_file = argv[++k];
+        else if (a=="--trace")
+            params.trace_file = argv[++k];
+        else if (a=="--race")
+        {
+            params.race_margin = atof(argv[++k]);
+            if (params.race_margin<0)
+                exit_with_help();
         }
+        else if (a=="--passes")
+            params.passes = std::max(atoi(argv[++k]),1);
+        else if (a=="--consensus")
+        {
+            params.consensus_threshold = atof(argv[++k]);
+            if (!(params.consensus_threshold>0 && params.consensus_threshold<=1))
+                exit_with_help();
+        }
+        else
+            args.push_back(a);
+    }
+
+    size_t i=0;
+    try
+    {
+        i = parse_options(args,params);
+    }
+    catch (std::invalid_argument &e)
+    {
+        FILE_LOG(logERROR) << e.what();
+        exit_with_help();
+    }
+
+    if (params.batch_jobs>1 && !igraph_is_thread_safe())
+    {
+        cerr << "igraph isn't built thread safe (--enable-tls), --jobs can't be more than 1" << endl;
+        exit_with_help();
+    }
+
+    if (!params.daemon_socket.empty())
+    {
+        if (i<args.size())
+            exit_with_help();
+        return params;
+    }
+
+    if (!params.batch_file.empty())
+    {
+        std::ifstream is(params.batch_file.c_str());
+        if (i<args.size() || !is.good())
+        {
+            cout << std::string("Manifest \"" + params.batch_file + "\" not found") << endl;
+            exit_with_help();
+        }
+        return params;
     }
 
+
     // Determine filenames
-    if(i>=argc)
+    if(i>=args.size())
         exit_with_help();
 
-    char input[1024];
-    strcpy(input, argv[i]);
-    params.filename = std::string(input);
+    params.filename = args[i];
 
-    std::ifstream is(input);
+    std::ifstream is(params.filename.c_str());
     if (!is.good())
     {
         cout << std::string("File \"" + params.filename + "\" not found") << endl;
@@ -224,40 +423,408 @@ PacoParams parse_command_line(int argc, char **argv)
 }
 
 
-int main(int argc, char *argv[])
+/**
+ * @brief sweep_graph Runs the threshold sweep of pars on g and saves the memberships as one column per density
+ * @param g
+ * @param pars
+ * @return the steps of the sweep
+ */
+std::vector<ThresholdStep> sweep_graph(const GraphC &g, const PacoParams &pars)
 {
-    PacoParams pars = parse_command_line(argc,argv);
+    ThresholdSweep sweep(g);
+    std::vector<ThresholdStep> steps = sweep.run(pars.densities,pars.qual,pars.method,pars.nrep,pars.rand_seed);
+    std::ofstream out(pars.membership_file.c_str());
+    if (!out.good())
+        throw std::ios_base::failure("Error, file" + pars.membership_file + " can't be written");
+    for (size_t v=0; v<g.number_of_nodes(); ++v)
+    {
+        for (size_t i=0; i<steps.size(); ++i)
+            out << steps[i].membership[v] << (i+1<steps.size() ? "\t" : "\n");
+    }
+    return steps;
+}
 
-    // Determine file format
+/**
+ * @brief race_graph Races the repetitions of pars on g and saves the membership of the best one
+ * @param g
+ * @param pars
+ * @return the quality of the partition
+ */
+double race_graph(const GraphC &g, const PacoParams &pars)
+{
+    RepetitionRace race(g,pars.batch_jobs);
+    race.set_margin(pars.race_margin);
+    race.set_time_budget(pars.time_budget);
+    race.set_passes(pars.passes);
+    RaceResult result = race.run(pars.qual,pars.method,pars.nrep,pars.rand_seed);
+    FILE_LOG(logINFO) << result.completed << " repetitions completed, " << result.abandoned << " abandoned";
+    std::ofstream out(pars.membership_file.c_str());
+    if (!out.good())
+        throw std::ios_base::failure("Error, file " + pars.membership_file + " can't be written");
+    for (size_t v=0; v<result.membership.size(); ++v)
+        out << result.membership[v] << endl;
+    return result.quality;
+}
+
+/**
+ * @brief consensus_graph Finds the consensus partition of the repetitions of pars on g and saves it
+ * @param g
+ * @param pars
+ * @return the quality of the partition
+ */
+double consensus_graph(const GraphC &g, const PacoParams &pars)
+{
+    ConsensusClustering consensus(g,pars.batch_jobs);
+    consensus.set_threshold(pars.consensus_threshold);
+    consensus.set_passes(pars.passes);
+    ConsensusResult result = consensus.run(pars.qual,pars.method,pars.nrep,pars.rand_seed);
+    FILE_LOG(logINFO) << "Consensus " << (result.converged ? "reached" : "not reached") << " after " << result.iterations << " rounds";
+    std::ofstream out(pars.membership_file.c_str());
+    if (!out.good())
+        throw std::ios_base::failure("Error, file " + pars.membership_file + " can't be written");
+    for (size_t v=0; v<result.membership.size(); ++v)
+        out << result.membership[v] << endl;
+    return result.quality;
+}
+
+/**
+ * @brief optimize_graph Optimizes g from the initial partition of pars and saves the membership,
+ * and the counters of the optimizer if requested
+ * @param g
+ * @param pars
+ * @return the quality of the partition
+ */
+double optimize_graph(GraphC &g, const PacoParams &pars)
+{
+    CommunityStructure comm(&g);
+    comm.set_random_seed(pars.rand_seed);
+    switch (pars.initializer)
+    {
+    case 1:
+    {
+        size_t k = pars.init_clusters ? pars.init_clusters : (size_t)std::sqrt((double)g.number_of_nodes());
+        comm.initialize(RandomInitializer(std::max<size_t>(k,1)));
+        break;
+    }
+    case 2:
+    {
+        if (pars.init_membership_file.empty())
+            throw std::invalid_argument("Initial membership file not specified, use -i");
+        comm.initialize(FileInitializer(pars.init_membership_file));
+        break;
+    }
+    case 3:
+    {
+        comm.initialize(LabelPropagationInitializer(20,pars.init_threads));
+        break;
+    }
+    default:
+        break;
+    }
+    comm.set_time_budget(pars.time_budget);
+    double quality = comm.optimize(pars.qual,pars.method,pars.nrep);
+    if (comm.time_budget_expired())
+    {
+        FILE_LOG(logWARNING) << "Time budget of " << pars.time_budget << " ms expired, returning the best partition found so far";
+    }
+    comm.reindex_membership();
+    comm.save_membership(pars.membership_file.c_str(),comm.get_membership());
+    if (!pars.counters_file.empty())
+    {
+        std::ofstream out(pars.counters_file.c_str());
+        if (!out.good())
+            throw std::ios_base::failure("Error, file " + pars.counters_file + " can't be written");
+        out << comm.get_counters().to_json() << endl;
+    }
+    return quality;
+}
+
+/**
+ * A graph of the batch read by the loader, waiting for a worker
+ */
+struct LoadedGraph
+{
+    size_t job;
+    std::unique_ptr<GraphC> graph;
+    double load_time;
+    std::string error;
+};
+
+/**
+ * One row of the batch summary
+ */
+struct BatchResult
+{
+    std::string graph_file;
+    std::string membership_file;
+    size_t num_nodes=0;
+    size_t num_edges=0;
+    std::string quality;
+    double load_time=0;
+    double optimize_time=0;
+    std::string status="ok";
+};
+
+/**
+ * @brief read_manifest Reads the jobs of a batch manifest, one per line as "graph_file membership_file [options]".
+ * Empty lines and lines starting with # are skipped. A line with non valid options gets an error result.
+ * @param pars the defaults of every line
+ * @param jobs
+ * @param results one per job, with the error of the non valid lines
+ */
+void read_manifest(const PacoParams &pars, std::vector<PacoParams> &jobs, std::vector<BatchResult> &results)
+{
+    std::ifstream is(pars.batch_file.c_str());
+    if (!is.good())
+        throw std::ios_base::failure("Error, manifest " + pars.batch_file + " can't be read");
+    std::string line;
+    while (std::getline(is,line))
+    {
+        std::stringstream ss(line);
+        std::vector<std::string> args;
+        std::string token;
+        while (ss >> token)
+            args.push_back(token);
+        if (args.empty() || args[0][0]=='#')
+            continue;
+
+        PacoParams job(pars);
+        BatchResult result;
+        result.graph_file = args[0];
+        try
+        {
+            if (args.size()<2)
+                throw std::invalid_argument("Missing membership file");
+            result.membership_file = args[1];
+            std::vector<std::string> options(args.begin()+2,args.end());
+            size_t k = parse_options(options,job);
+            if (k!=options.size())
+                throw std::invalid_argument("Non valid option " + options[k]);
+        }
+        catch (std::invalid_argument &e)
+        {
+            result.status = e.what();
+        }
+        job.filename = result.graph_file;
+        job.membership_file = result.membership_file;
+        if (!job.counters_file.empty())
+            job.counters_file = job.membership_file + ".counters.json";
+        // Every line of the batch without its own seed draws from its own stream, whatever the thread
+        if (!job.seed_given)
+            job.rand_seed = derived_seed(pars.rand_seed,jobs.size());
+        jobs.push_back(job);
+        results.push_back(result);
+    }
+}
+
+/**
+ * @brief run_batch Optimizes the graphs of the manifest over a pool of workers. A loader thread reads the graphs
+ * in manifest order while the workers optimize the ones already read, at most one graph per worker is kept waiting.
+ * Without a thread safe igraph there is a single worker, and it never optimizes while the loader reads.
+ * @param pars
+ * @return the number of failed jobs
+ */
+size_t run_batch(const PacoParams &pars)
+{
+    PacoParams defaults(pars);
+    if (defaults.rand_seed<0)
+        defaults.rand_seed = static_cast<int>(time(0));
+    std::vector<PacoParams> jobs;
+    std::vector<BatchResult> results;
+    read_manifest(defaults,jobs,results);
+
+    unsigned int nworkers = igraph_threads(pars.batch_jobs);
+    nworkers = std::max(1U,std::min<unsigned int>(nworkers,std::max<size_t>(jobs.size(),1)));
+
+    std::mutex mutex, igraph_mutex; // igraph_mutex is held inside igraph if it isn't thread safe
+    std::condition_variable not_full, not_empty;
+    std::deque<LoadedGraph> queue;
+    bool loading = true;
+
+    std::thread loader([&]()
+    {
+        for (size_t j=0; j<jobs.size(); ++j)
+        {
+            LoadedGraph loaded;
+            loaded.job = j;
+            loaded.load_time = 0;
+            if (results[j].status=="ok")
+            {
+                Timer timer;
+                timer.start();
+                std::unique_lock<std::mutex> serial(igraph_mutex,std::defer_lock);
+                if (!igraph_is_thread_safe())
+                    serial.lock();
+                try
+                {
+                    loaded.graph.reset(new GraphC);
+                    if (!loaded.graph->read(jobs[j].filename))
+                        throw std::invalid_argument("Non supported graph format");
+                    loaded.graph->set_float32_weights(jobs[j].float32_weights);
+                }
+                catch (std::exception &e)
+                {
+                    loaded.graph.reset();
+                    loaded.error = e.what();
+                }
+                timer.stop();
+                loaded.load_time = timer.getElapsedTimeInSec();
+            }
+            std::unique_lock<std::mutex> lock(mutex);
+            not_full.wait(lock,[&]() { return queue.size()<nworkers; });
+            queue.push_back(std::move(loaded));
+            not_empty.notify_one();
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        loading = false;
+        not_empty.notify_all();
+    });
+
+    std::vector<std::thread> workers;
+    for (unsigned int w=0; w<nworkers; ++w)
+    {
+        workers.push_back(std::thread([&]()
+        {
+            while (true)
+            {
+                LoadedGraph loaded;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    not_empty.wait(lock,[&]() { return !queue.empty() || !loading; });
+                    if (queue.empty())
+                        return;
+                    loaded = std::move(queue.front());
+                    queue.pop_front();
+                    not_full.notify_one();
+                }
+                // Every job writes only its own result
+                BatchResult &result = results[loaded.job];
+                const PacoParams &job = jobs[loaded.job];
+                result.load_time = loaded.load_time;
+                if (!loaded.error.empty())
+                    result.status = loaded.error;
+                if (!loaded.graph)
+                    continue;
+                GraphC &g = *loaded.graph;
+                result.num_nodes = g.number_of_nodes();
+                result.num_edges = g.number_of_edges();
+                Timer timer;
+                timer.start();
+                std::unique_lock<std::mutex> serial(igraph_mutex,std::defer_lock);
+                if (!igraph_is_thread_safe())
+                    serial.lock();
+                try
+                {
+                    PACO_TRACE_SCOPE("batch job");
+                    std::stringstream quality;
+                    if (!job.densities.empty())
+                    {
+                        std::vector<ThresholdStep> steps = sweep_graph(g,job);
+                        for (size_t i=0; i<steps.size(); ++i)
+                            quality << (i ? "," : "") << steps[i].quality;
+                    }
+                    else
+                        quality << optimize_graph(g,job);
+                    result.quality = quality.str();
+                }
+                catch (std::exception &e)
+                {
+                    result.status = e.what();
+                }
+                timer.stop();
+                result.optimize_time = timer.getElapsedTimeInSec();
+                loaded.graph.reset(); // destroyed while serial is still held
+            }
+        }));
+    }
+    loader.join();
+    for (size_t w=0; w<workers.size(); ++w)
+        workers[w].join();
+
+    size_t nfailed = 0;
+    cout << "graph\tmembership\tnodes\tedges\tquality\tload_time\toptimize_time\tstatus" << endl;
+    for (size_t j=0; j<results.size(); ++j)
+    {
+        const BatchResult &r = results[j];
+        cout << r.graph_file << "\t" << r.membership_file << "\t" << r.num_nodes << "\t" << r.num_edges << "\t"
+             << (r.quality.empty() ? "-" : r.quality) << "\t" << r.load_time << "\t" << r.optimize_time << "\t" << r.status << endl;
+        nfailed += r.status!="ok";
+    }
+    return nfailed;
+}
+
+/**
+ * @brief run Runs the mode selected by pars
+ * @param pars
+ * @return the exit code
+ */
+int run(const PacoParams &pars)
+{
+    if (!pars.batch_file.empty())
+        return run_batch(pars)>0;
+
+    if (!pars.daemon_socket.empty())
+    {
+        PacoServer server(pars.cache_graphs);
+        FILE_LOG(logINFO) << "Serving on " << pars.daemon_socket;
+        server.serve(pars.daemon_socket);
+        return 0;
+    }
+
+    // Determine file format from the extension
     GraphC g;
-    if(pars.filename.substr(pars.filename.find_last_of(".") + 1) == "net")
-        g.read_pajek(pars.filename);
-    else if(pars.filename.substr(pars.filename.find_last_of(".") + 1) == "adj")
-        g.read_adj_matrix(pars.filename);
-    else if(pars.filename.substr(pars.filename.find_last_of(".") + 1) == "gml")
-        g.read_gml(pars.filename);
-    else if (pars.filename.substr(pars.filename.find_last_of(".") + 1) == "ncol" || pars.filename.substr(pars.filename.find_last_of(".") + 1) == "edge")
-        g.read_edge_list(pars.filename);
-    else if(pars.filename.substr(pars.filename.find_last_of(".") + 1) == "wncol")
-        g.read_weighted_edge_list(pars.filename);
-    else
+    if (!g.read(pars.filename))
     {
         cerr << "Non supported graph format" << endl;
         exit_with_help();
     }
 
+    g.set_float32_weights(pars.float32_weights);
+
     if (pars.print_info)
     {
         FILELog::ReportingLevel() =  logINFO;
         g.info();
     }
 
-    CommunityStructure comm(&g);
-    comm.set_random_seed(pars.rand_seed);
-    double quality = comm.optimize(pars.qual,pars.method,pars.nrep);
-    comm.reindex_membership();
-    comm.save_membership(pars.membership_file.c_str(),comm.get_membership());
-    cout << quality << endl;
+    if (!pars.densities.empty())
+    {
+        std::vector<ThresholdStep> steps = sweep_graph(g,pars);
+        for (size_t i=0; i<steps.size(); ++i)
+            cout << steps[i].density << "\t" << steps[i].num_edges << "\t" << steps[i].min_weight << "\t" << steps[i].quality << endl;
+        return 0;
+    }
+
+    if (pars.race_margin>=0 || pars.consensus_threshold>0)
+    {
+        if (pars.initializer!=0)
+        {
+            cerr << "Racing and consensus repetitions start from singletons, -b can't be used with --race or --consensus" << endl;
+            exit_with_help();
+        }
+        cout << (pars.consensus_threshold>0 ? consensus_graph(g,pars) : race_graph(g,pars)) << endl;
+        return 0;
+    }
+
+    if (pars.initializer==2 && pars.init_membership_file.empty())
+    {
+        cerr << "Initial membership file not specified, use -i" << endl;
+        exit_with_help();
+    }
+    cout << optimize_graph(g,pars) << endl;
 
     return 0;
 }
+
+int main(int argc, char *argv[])
+{
+    PacoParams pars = parse_command_line(argc,argv);
+#ifndef PACO_TRACING
+    if (!pars.trace_file.empty())
+        cerr << "PACO compiled without the TRACING option, the trace will be empty" << endl;
+#endif
+    int status = run(pars);
+    if (!pars.trace_file.empty())
+        write_chrome_trace(pars.trace_file);
+    return status;
+}
@@ -25,22 +25,101 @@ from __future__ import division
 import numpy as np
 cimport numpy as np
 from ctypes import c_double
+import functools
+import threading
 
 # Cython imports
+from libcpp cimport bool
 from libcpp.string cimport string
 from libcpp.map cimport map
 from libcpp.vector cimport vector
+from libc.stdint cimport int32_t, int64_t, uint32_t, uint64_t
 import cython
+from cpython.exc cimport PyErr_CheckSignals
 
 ctypedef map[string, int] params_map
 
+cdef extern from "igraph_utils.h":
+    bool igraph_is_thread_safe()
+
+# Held by the calls into igraph when it isn't thread safe, reentrant for a progress callback that calls paco
+_igraph_lock = threading.RLock()
+
+def _igraph_serialized(f):
+    """Without a thread safe igraph the calls of f from different threads take turns"""
+    if igraph_is_thread_safe():
+        return f
+    @functools.wraps(f)
+    def serialized(*args, **kwargs):
+        with _igraph_lock:
+            return f(*args, **kwargs)
+    return serialized
+
 cdef extern from "Graph.h":
     cdef cppclass GraphC:
         GraphC() except +
         GraphC(double *A, int n, int m) except +
+        GraphC(int32_t n, const int32_t *indptr, const int32_t *indices, const float *values) except +
+        GraphC(int32_t n, const int32_t *indptr, const int32_t *indices, const double *values) except +
+        GraphC(int64_t n, const int64_t *indptr, const int64_t *indices, const float *values) except +
+        GraphC(int64_t n, const int64_t *indptr, const int64_t *indices, const double *values) except +
+        GraphC(int32_t n, size_t nnz, const int32_t *rows, const int32_t *cols, const float *values) except +
+        GraphC(int32_t n, size_t nnz, const int32_t *rows, const int32_t *cols, const double *values) except +
+        GraphC(int64_t n, size_t nnz, const int64_t *rows, const int64_t *cols, const float *values) except +
+        GraphC(int64_t n, size_t nnz, const int64_t *rows, const int64_t *cols, const double *values) except +
         void init(const double *ewlist, int _is_weighted, int m) except +
+        void init_edges(const int32_t *ewlist, size_t num_edges, bool weighted) except +
+        void init_edges(const int64_t *ewlist, size_t num_edges, bool weighted) except +
+        void init_edges(const float *ewlist, size_t num_edges, bool weighted) except +
+        void init_edges(const double *ewlist, size_t num_edges, bool weighted) except +
+        bool read(const string &filename) except +
         void info() except+
 
+# Index and value types of the buffers viewed without copies
+ctypedef fused index_t:
+    int32_t
+    int64_t
+
+ctypedef fused value_t:
+    float
+    double
+
+ctypedef fused edge_t:
+    int32_t
+    int64_t
+    float
+    double
+
+cdef extern from "OptimizerCounters.h":
+    cdef struct OptimizerCounters:
+        uint64_t moves_attempted
+        uint64_t moves_accepted
+        uint64_t moves_reverted
+        uint64_t quality_evaluations
+        uint64_t surprise_terms
+        uint64_t cache_hits
+        double init_time
+        double sort_time
+        double optimize_time
+        double evaluation_time
+
+cdef extern from "OptimizerProgress.h":
+    cdef struct OptimizerProgress:
+        uint64_t steps
+        size_t repetition
+        size_t repetitions
+        double quality
+        double best_quality
+    ctypedef bool (*ProgressCallback)(const OptimizerProgress &progress, void *data) noexcept
+
+cdef extern from "PartitionMetrics.h":
+    cdef struct PartitionComparison:
+        double nmi
+        double vi
+        double ari
+        double jaccard
+    vector[PartitionComparison] _compare_partitions "compare_partitions"(const vector[vector[uint32_t]] &partitions, const vector[uint32_t] &reference, unsigned int nthreads) except + nogil
+
 cdef extern from "Community.h":
     cdef enum QualityType:
         pyQualityType
@@ -48,14 +127,137 @@ cdef extern from "Community.h":
         pyOptimizerType
     cdef cppclass CommunityStructure:
         CommunityStructure(const GraphC *) except +
-        void set_random_seed(int n)
-        double optimize(QualityType quality, OptimizerType method, int repetitions)  except +
+        void set_random_seed(int n) nogil
+        void set_time_budget(double milliseconds) nogil
+        bint time_budget_expired()
+        void set_progress_callback(ProgressCallback callback, void *data, unsigned int interval)
+        bint cancelled()
+        double optimize(QualityType quality, OptimizerType method, int repetitions) except + nogil
         void reindex_membership()
         vector[int] get_membership_vector()
+        const OptimizerCounters &get_counters()
+
+cdef extern from "ThresholdSweep.h":
+    cdef struct ThresholdStep:
+        double density
+        size_t num_edges
+        double min_weight
+        double quality
+        vector[uint32_t] membership
+    cdef cppclass ThresholdSweep:
+        ThresholdSweep(const GraphC &g) except +
+        vector[ThresholdStep] run(const vector[double] &densities, QualityType qual, OptimizerType method, int nrep, int seed) except + nogil
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+cdef GraphC* _graph_from_csr(index_t n, const index_t[::1] indptr, const index_t[::1] indices, const value_t[::1] data) except NULL:
+    # Empty index arrays are never dereferenced, their pointer can be NULL
+    return new GraphC(n, &indptr[0], &indices[0] if indices.shape[0] else NULL, &data[0] if data.shape[0] else NULL)
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+cdef GraphC* _graph_from_coo(index_t n, const index_t[::1] rows, const index_t[::1] cols, const value_t[::1] data) except NULL:
+    cdef size_t nnz = rows.shape[0]
+    if nnz == 0:
+        return new GraphC(n, nnz, <const index_t*>NULL, <const index_t*>NULL, <const value_t*>NULL)
+    return new GraphC(n, nnz, &rows[0], &cols[0], &data[0])
 
 @cython.boundscheck(False)
 @cython.wraparound(False)
-def paco(np.ndarray[double, ndim=2, mode="c"] graph_rep not None, **kwargs):
+cdef GraphC* _graph_from_edges(const edge_t[:, ::1] edges) except NULL:
+    cdef GraphC *G = new GraphC()
+    try:
+        G.init_edges(&edges[0,0], edges.shape[0], edges.shape[1] == 3)
+    except:
+        del G
+        raise
+    return G
+
+def _as_index_array(a, dtype):
+    # Views the array if it already has a supported index type, otherwise converts it
+    return np.ascontiguousarray(a, dtype=dtype)
+
+cdef GraphC* _graph_from_sparse(A) except NULL:
+    """
+    Build the graph from a scipy.sparse matrix. CSR, CSC and COO matrices with int32 or int64 indices and float32 or float64
+    values are viewed in place, other formats and value types are converted first.
+    """
+    if A.shape[0] != A.shape[1]:
+        raise Exception("Sparse adjacency matrix must be square")
+    fmt = A.format
+    if fmt not in ('csr', 'csc', 'coo'):
+        A = A.tocsr()
+        fmt = 'csr'
+    data = A.data
+    if data.dtype != np.float32 and data.dtype != np.float64:
+        data = data.astype(np.float64)
+    data = np.ascontiguousarray(data)
+    if fmt == 'coo':
+        index_dtype = np.int32 if (A.row.dtype == np.int32 and A.col.dtype == np.int32) else np.int64
+        rows = _as_index_array(A.row, index_dtype)
+        cols = _as_index_array(A.col, index_dtype)
+        if index_dtype == np.int32:
+            if data.dtype == np.float32:
+                return _graph_from_coo[int32_t, float](A.shape[0], rows, cols, data)
+            return _graph_from_coo[int32_t, double](A.shape[0], rows, cols, data)
+        if data.dtype == np.float32:
+            return _graph_from_coo[int64_t, float](A.shape[0], rows, cols, data)
+        return _graph_from_coo[int64_t, double](A.shape[0], rows, cols, data)
+    # The compressed columns of a symmetric matrix are its compressed rows
+    index_dtype = np.int32 if (A.indptr.dtype == np.int32 and A.indices.dtype == np.int32) else np.int64
+    indptr = _as_index_array(A.indptr, index_dtype)
+    indices = _as_index_array(A.indices, index_dtype)
+    if index_dtype == np.int32:
+        if data.dtype == np.float32:
+            return _graph_from_csr[int32_t, float](A.shape[0], indptr, indices, data)
+        return _graph_from_csr[int32_t, double](A.shape[0], indptr, indices, data)
+    if data.dtype == np.float32:
+        return _graph_from_csr[int64_t, float](A.shape[0], indptr, indices, data)
+    return _graph_from_csr[int64_t, double](A.shape[0], indptr, indices, data)
+
+cdef GraphC* _graph_from_edges_array(E) except NULL:
+    """
+    Build the graph from a [m x 2] or [m x 3] edges list. C-contiguous int32, int64, float32 and float64 arrays
+    are viewed in place, other types and layouts are converted first.
+    """
+    if E.dtype not in (np.int32, np.int64, np.float32, np.float64):
+        E = E.astype(np.float64 if E.shape[1] == 3 else np.int64)
+    E = np.ascontiguousarray(E)
+    if E.dtype == np.int32:
+        return _graph_from_edges[int32_t](E)
+    if E.dtype == np.int64:
+        return _graph_from_edges[int64_t](E)
+    if E.dtype == np.float32:
+        return _graph_from_edges[float](E)
+    return _graph_from_edges[double](E)
+
+cdef GraphC* _graph_from_rep(graph_rep) except NULL:
+    # Create graph instance from an adjacency matrix, sparse matrix or edges list
+    cdef GraphC *G = NULL
+    cdef np.ndarray[double, ndim=2, mode="c"] dense
+
+    if hasattr(graph_rep, 'tocsr') and hasattr(graph_rep, 'format'):
+        G = _graph_from_sparse(graph_rep)
+    else:
+        graph_rep = np.asarray(graph_rep)
+        if graph_rep.ndim != 2:
+            raise Exception("graph_rep must be a square adjacency matrix or an edges list with 2 or 3 columns")
+        num_rows = graph_rep.shape[0]
+        num_cols = graph_rep.shape[1]
+        if num_cols<=3 and num_cols>=2 and num_rows>2:
+            # The matrix is an edgelist representation, passing a mx3 (if weighted) or mx2 (if binary) vector
+            G = _graph_from_edges_array(graph_rep)
+        elif num_cols==num_rows and num_cols>2:
+            # The matrix is an adjacency matrix
+            dense = np.ascontiguousarray(graph_rep, dtype=np.float64)
+            G = new GraphC(&dense[0,0], num_cols, num_cols)
+        else:
+            raise Exception("graph_rep must be a square adjacency matrix or an edges list with 2 or 3 columns")
+
+    return G
+
+@_igraph_serialized
+def paco(graph_rep, **kwargs):
     """
     PACO: PArtitioning Cost Optimization
     
@@ -65,12 +267,19 @@ def paco(np.ndarray[double, ndim=2, mode="c"] graph_rep not None, **kwargs):
       G = nx.karate_club_graph()
       A  = nx.to_numpy_matrix(G)
       [membership,quality] = paco(A, quality=0, nreps=10)
+
+    Example: passing graph as a scipy sparse matrix
+      import networkx as nx
+      from pypaco import paco
+      G = nx.karate_club_graph()
+      A = nx.to_scipy_sparse_matrix(G, format='csr')
+      [membership,quality] = paco(A, quality=0, nreps=10)
     
     Example: passing graph as edges list
       import numpy as np
       from pypaco import paco
       G = nx.karate_club_graph()
-      E = np.array(G.edges()).astype(float64) # E must be a numpy array of doubles, not a list
+      E = np.array(G.edges()) # integer or floating point arrays are both accepted
       [membership,quality] = paco(E, quality=0, nreps=10)
 
     Example: passing graph as weighted edges list
@@ -83,11 +292,20 @@ def paco(np.ndarray[double, ndim=2, mode="c"] graph_rep not None, **kwargs):
       EW = np.concatenate((E,W),axis=1).astype(float)
       [membership,quality] = paco(EW, quality=2, nreps=10)
 
+    Example: optimizing many graphs concurrently, the GIL is released during the optimization.
+      from concurrent.futures import ThreadPoolExecutor
+      with ThreadPoolExecutor(8) as pool:
+          results = list(pool.map(lambda A: paco(A, quality=2), adjacency_matrices))
+
     Usage:
         [membership, quality] = paco(A, **kwargs)
 
     Args: 
-        graph_rep: Adjacency matrix of the graph as a numpy 2D array, symmetric, binary or weighted. Otherwise an edgelist with m rows and 2 or 3 columns representing nodes indices
+        graph_rep: Adjacency matrix of the graph as a numpy 2D array or a scipy.sparse matrix, symmetric, binary or weighted.
+        Otherwise an edgelist with m rows and 2 or 3 columns representing nodes indices.
+        Sparse CSR, CSC and COO matrices with int32/int64 indices and float32/float64 values, and C-contiguous edges lists
+        of int32, int64, float32 or float64 are used without copies. Only the upper triangle of sparse matrices is read.
+        Dense adjacency matrices are converted to C-contiguous float64 arrays if needed.
     Kwargs:
         quality: quality function to maximize
             0: Surprise
@@ -103,14 +321,80 @@ def paco(np.ndarray[double, ndim=2, mode="c"] graph_rep not None, **kwargs):
 
         nreps: number of repetitions of PACO (can increase the quality of the partition), (default 1).
         seed: random seed for randomization (integer value)
+
+        time_budget: milliseconds after which the best partition found so far is returned, 0 for no
+        limit (default 0). Infomap ignores it
         
         save_solution: 1 to save ongoing solution, 0 otherwise (default 0)
+
+        counters: True to return also a dict with the counters of moves and quality evaluations and the
+        time in seconds of every phase of the optimization (default False)
+
+        progress: function called during the optimization with a dict of steps, repetition, repetitions,
+        quality and best_quality. Returning False, or raising, stops the optimization, that returns the best
+        partition found so far. Exceptions, as KeyboardInterrupt for Ctrl+C, are raised again by paco
+        progress_interval: number of optimizer steps between two calls of progress (default 8192)
         
     Out:
         membership: a list of vertices community membership
         quality: the partition quality value
+        counters: only if requested
     """
-    args = ['nreps','quality', 'seed', 'opt_method']
+    cdef GraphC *G = _graph_from_rep(graph_rep)
+    try:
+        return _optimize(G, kwargs)
+    finally:
+        del G
+
+@_igraph_serialized
+def paco_file(filename, **kwargs):
+    """
+    PACO: PArtitioning Cost Optimization on a graph stored in a file
+
+    Example: optimizing a graph stored in the native binary format
+      from pypaco import paco_file
+      [membership,quality] = paco_file('graph.pacobin', quality=2, nreps=10)
+
+    Usage:
+        [membership, quality] = paco_file(filename, **kwargs)
+
+    Args:
+        filename: the graph file, the format is chosen from the extension: net (pajek), gml, adj (adjacency matrix),
+        ncol (edges list), wncol (weighted edges list), pacobin (native binary format, memory mapped without parsing).
+    Kwargs:
+        the same keyword arguments of paco
+    Out:
+        membership: a list of vertices community membership
+        quality: the partition quality value
+    """
+    cdef GraphC *G = new GraphC()
+    try:
+        if not G.read(filename.encode('utf-8') if isinstance(filename, type(u'')) else filename):
+            raise Exception("Non supported graph format: " + str(filename))
+        return _optimize(G, kwargs)
+    finally:
+        del G
+
+cdef bool _report_progress(const OptimizerProgress &p, void *data) noexcept with gil:
+    progress = <object>data
+    try:
+        PyErr_CheckSignals()
+        keep_going = progress[0]({
+            'steps': p.steps,
+            'repetition': p.repetition,
+            'repetitions': p.repetitions,
+            'quality': p.quality,
+            'best_quality': p.best_quality })
+        # bool is the C++ type here, the truth value of keep_going is taken by the conversion
+        if keep_going is None:
+            return True
+        return keep_going
+    except BaseException as e:
+        progress[1] = e
+        return False
+
+cdef _optimize(GraphC *G, kwargs):
+    args = ['nreps','quality', 'seed', 'opt_method', 'counters', 'time_budget', 'progress', 'progress_interval']
 
     args_diff = set(kwargs.keys()) - set(args)
     if args_diff:
@@ -122,26 +406,6 @@ def paco(np.ndarray[double, ndim=2, mode="c"] graph_rep not None, **kwargs):
     par[str("seed")] = kwargs.get("seed", -1)
     par[str("opt_method")] = kwargs.get("opt_method", 0)
 
-    # Create graph instance
-    cdef GraphC *G
-
-    num_rows = graph_rep.shape[0]
-    num_cols = graph_rep.shape[1]
-    cdef np.ndarray[double, ndim=1, mode="c"] edges_list
-    cdef np.ndarray[double, ndim=1, mode="c"] weights_list
-    if num_cols<=3 and num_rows>2:
-        # The matrix is an edgelist representation, passing a mx3 (if weighted) or mx2 (if binary) vector
-        try:
-            G = new GraphC()
-            G.init(&graph_rep[0,0], int(num_cols!=2), num_rows)
-        except RuntimeError:
-            raise
-    elif num_cols==num_rows and num_cols>2:
-        # The matrix is an adjacency matrix
-        try:
-            G = new GraphC(&graph_rep[0,0], num_cols, num_cols)
-        except RuntimeError:
-            raise
     # Create community structure instance
     cdef CommunityStructure* c
     try:
@@ -149,18 +413,159 @@ def paco(np.ndarray[double, ndim=2, mode="c"] graph_rep not None, **kwargs):
     except RuntimeError:
         raise 
 
-    c.set_random_seed(int(par["seed"]));
+    cdef int seed = par["seed"]
+    cdef QualityType quality = <QualityType>par["quality"]
+    cdef OptimizerType method = <OptimizerType>par["opt_method"]
+    cdef int nreps = par["nreps"]
+    cdef double time_budget = kwargs.get("time_budget", 0)
+    cdef double finalquality
+    cdef OptimizerCounters counters
+    # The callback of the user and the exception it raised, if any
+    progress = [kwargs.get("progress"), None]
+    try:
+        if progress[0] is not None:
+            c.set_progress_callback(_report_progress, <void*>progress, kwargs.get("progress_interval", 8192))
+        # The optimization doesn't touch Python objects, other Python threads can run meanwhile.
+        with nogil:
+            c.set_random_seed(seed)
+            c.set_time_budget(time_budget)
+            finalquality = c.optimize(quality, method, nreps)
+        if progress[1] is not None:
+            raise progress[1]
+        c.reindex_membership()
+        membership = c.get_membership_vector()
+        counters = c.get_counters()
+    finally:
+        del c
+
+    if kwargs.get("counters", False):
+        return membership, finalquality, {
+            'moves_attempted': counters.moves_attempted,
+            'moves_accepted': counters.moves_accepted,
+            'moves_reverted': counters.moves_reverted,
+            'quality_evaluations': counters.quality_evaluations,
+            'surprise_terms': counters.surprise_terms,
+            'cache_hits': counters.cache_hits,
+            'init_time': counters.init_time,
+            'sort_time': counters.sort_time,
+            'optimize_time': counters.optimize_time,
+            'evaluation_time': counters.evaluation_time }
+    return membership, finalquality
+
+@_igraph_serialized
+def paco_sweep(graph_rep, densities, **kwargs):
+    """
+    PACO over a proportional threshold sweep of a weighted graph
+
+    The edges are sorted by decreasing weight once and inserted in batches, density after density.
+    The sparsest graph is optimized as in paco, every denser one is re-optimized from the partition
+    of the previous density, moving only the vertices around the inserted edges.
+
+    Example: brain network at increasing densities
+      import numpy as np
+      from pypaco import paco_sweep
+      [memberships, qualities, num_edges] = paco_sweep(A, [0.05, 0.1, 0.15, 0.2], quality=2)
+
+    Usage:
+        [memberships, qualities, num_edges] = paco_sweep(A, densities, **kwargs)
+
+    Args:
+        graph_rep: the weighted graph, as in paco
+        densities: fractions of the vertex pairs to keep as edges, in (0,1]
+    Kwargs:
+        the same keyword arguments of paco, nreps and opt_method apply to the sparsest graph
+    Out:
+        memberships: array with one row per density, in increasing density order
+        qualities: the partition quality at every density
+        num_edges: number of edges kept at every density
+    """
+    args = ['nreps','quality', 'seed', 'opt_method']
+    args_diff = set(kwargs.keys()) - set(args)
+    if args_diff:
+        raise Exception("Invalid args:" + str(tuple(args_diff)) + "as graph_rep: valid arguments are " + str(args))
 
+    cdef vector[double] dens = [float(d) for d in densities]
+    cdef QualityType quality = <QualityType><int>kwargs.get("quality",1)
+    cdef OptimizerType method = <OptimizerType><int>kwargs.get("opt_method", 0)
+    cdef int nreps = kwargs.get("nreps",1)
+    cdef int seed = kwargs.get("seed", -1)
+    cdef vector[ThresholdStep] steps
+    cdef ThresholdSweep *sweep = NULL
+    cdef GraphC *G = _graph_from_rep(graph_rep)
     try:
-        finalquality = c.optimize(int(par["quality"]),int(par["opt_method"]),int(par["nreps"]))
-    except RuntimeError:
-        raise 
-    
-    c.reindex_membership()
-    membership = c.get_membership_vector()
+        sweep = new ThresholdSweep(G[0])
+        with nogil:
+            steps = sweep.run(dens, quality, method, nreps, seed)
+    finally:
+        del sweep
+        del G
 
-    del G
-    del c
+    memberships = np.array([list(steps[i].membership) for i in range(steps.size())], dtype=np.int64)
+    qualities = np.array([steps[i].quality for i in range(steps.size())])
+    num_edges = np.array([steps[i].num_edges for i in range(steps.size())], dtype=np.int64)
+    return memberships, qualities, num_edges
 
-    return membership, finalquality
+def _as_labels(m):
+    # Community labels as a contiguous uint32 array, rejecting the ones that don't fit
+    m = np.asarray(m)
+    if m.size:
+        if not np.issubdtype(m.dtype, np.integer) and np.any(m != np.floor(m)):
+            raise ValueError("Membership labels must be integers")
+        if m.min() < 0 or m.max() > np.iinfo(np.uint32).max:
+            raise ValueError("Membership labels must be nonnegative 32 bit integers")
+    return np.ascontiguousarray(m, dtype=np.uint32)
+
+cdef vector[uint32_t] _as_membership(m) except *:
+    cdef const uint32_t[::1] labels = _as_labels(m)
+    cdef vector[uint32_t] memb
+    if labels.shape[0]:
+        memb.assign(&labels[0], &labels[0] + labels.shape[0])
+    return memb
+
+def compare_partitions(memberships, reference, threads=0):
+    """
+    Agreement of partitions of the same vertices with a reference partition
+
+    All the measures come from one sparse contingency table per partition, built in C++ in a
+    single pass over the vertices. Many partitions, like the repetitions of a stability analysis,
+    are compared in parallel.
+
+    Example: stability of the repetitions against the best partition
+      from pypaco import paco, compare_partitions
+      scores = compare_partitions(repetitions, best)
+      print(scores['nmi'].mean(), scores['ari'].mean())
+
+    Usage:
+        scores = compare_partitions(memberships, reference, threads=0)
+
+    Args:
+        memberships: a membership vector of n vertices, or a [k x n] array with one per row
+        reference: the membership vector of the same n vertices to compare with
+        threads: number of threads, 0 to use all the cores
+    Out:
+        scores: dictionary with the normalized mutual information 'nmi', the variation of information
+        'vi' in nats, the adjusted Rand index 'ari' and the Jaccard index 'jaccard'. Floats for a
+        single membership vector, arrays of k values otherwise.
+    """
+    cdef vector[uint32_t] ref = _as_membership(np.ravel(reference))
+    M = np.asarray(memberships)
+    single = M.ndim == 1
+    if single:
+        M = M[None, :]
+    if M.ndim != 2:
+        raise Exception("memberships must be a membership vector or an array with one per row")
+    cdef vector[vector[uint32_t]] parts
+    for row in M:
+        parts.push_back(_as_membership(row))
+    cdef unsigned int nthreads = threads
+    cdef vector[PartitionComparison] comp
+    with nogil:
+        comp = _compare_partitions(parts, ref, nthreads)
 
+    scores = { 'nmi': np.array([comp[i].nmi for i in range(comp.size())]),
+               'vi': np.array([comp[i].vi for i in range(comp.size())]),
+               'ari': np.array([comp[i].ari for i in range(comp.size())]),
+               'jaccard': np.array([comp[i].jaccard for i in range(comp.size())]) }
+    if single:
+        return dict((key, float(val[0])) for key, val in scores.items())
+    return scores
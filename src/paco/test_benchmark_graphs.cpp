@@ -0,0 +1,115 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2015 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <iostream>
+#include <set>
+#include <utility>
+#include <cmath>
+#include <cstdlib>
+
+#include "BenchmarkGraphs.h"
+#include "PartitionMetrics.h"
+
+using namespace std;
+
+/**
+ * @brief simple_graph true if all edges are sorted pairs of valid vertices without repetitions
+ */
+static bool simple_graph(const BenchmarkGraph &bg)
+{
+    set< pair<int32_t,int32_t> > seen;
+    for (size_t e=0; e<bg.num_edges(); ++e)
+    {
+        if (bg.sources[e]>=bg.targets[e] || bg.sources[e]<0 || bg.targets[e]>=bg.num_nodes)
+            return false;
+        if (!seen.insert(make_pair(bg.sources[e],bg.targets[e])).second)
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    int nfail = 0;
+
+    // Planted partition, edges count, communities and mixing
+    BenchmarkGraph planted;
+    planted_partition_graph(1000,20,0.02,0.3,1,&planted);
+    bool planted_ok = planted.num_edges()==9990 && planted.ground_truth.size()==1000
+            && planted.ground_truth[25]==5 && simple_graph(planted) && fabs(planted.mixing()-0.3)<0.02;
+    cout << "Planted partition: " << (planted_ok ? "OK" : "FAIL") << endl;
+    nfail += !planted_ok;
+
+    // LFR, every community within the size bounds and mixing close to the requested one
+    LFRParams pars;
+    BenchmarkGraph lfr;
+    lfr_graph(pars,2,&lfr);
+    vector<size_t> sizes;
+    for (size_t v=0; v<lfr.ground_truth.size(); ++v)
+    {
+        if (lfr.ground_truth[v]>=sizes.size())
+            sizes.resize(lfr.ground_truth[v]+1);
+        sizes[lfr.ground_truth[v]]++;
+    }
+    bool lfr_ok = lfr.ground_truth.size()==pars.num_nodes && simple_graph(lfr) && fabs(lfr.mixing()-pars.mixing)<0.05
+            && fabs(2.0*lfr.num_edges()/pars.num_nodes-pars.avg_degree)<0.2*pars.avg_degree;
+    for (size_t c=0; c<sizes.size(); ++c)
+        lfr_ok = lfr_ok && sizes[c]>=pars.min_community && sizes[c]<=pars.max_community;
+    cout << "LFR graph: " << (lfr_ok ? "OK" : "FAIL") << endl;
+    nfail += !lfr_ok;
+
+    // Weights, lighter between communities on average
+    set_benchmark_weights(&planted,0.5,3);
+    double intra = 0, inter = 0;
+    size_t nintra = 0, ninter = 0;
+    for (size_t e=0; e<planted.num_edges(); ++e)
+    {
+        if (planted.ground_truth[planted.sources[e]]==planted.ground_truth[planted.targets[e]])
+            intra += planted.weights[e], nintra++;
+        else
+            inter += planted.weights[e], ninter++;
+    }
+    bool weights_ok = planted.weights.size()==planted.num_edges() && fabs(intra/nintra-1)<0.05 && fabs(inter/ninter-0.5)<0.05;
+    unique_ptr<GraphC> g = planted.to_graph(true);
+    weights_ok = weights_ok && g->number_of_nodes()==1000 && g->number_of_edges()==planted.num_edges();
+    cout << "Benchmark weights: " << (weights_ok ? "OK" : "FAIL") << endl;
+    nfail += !weights_ok;
+
+    // Normalized mutual information
+    Membership relabeled(planted.ground_truth.size()), unrelated(planted.ground_truth.size());
+    srand(4);
+    for (size_t v=0; v<relabeled.size(); ++v)
+    {
+        relabeled[v] = 19-planted.ground_truth[v];
+        unrelated[v] = rand()%20;
+    }
+    bool nmi_ok = fabs(normalized_mutual_information(planted.ground_truth,planted.ground_truth)-1)<1E-12
+            && fabs(normalized_mutual_information(planted.ground_truth,relabeled)-1)<1E-12
+            && normalized_mutual_information(planted.ground_truth,unrelated)<0.1
+            && normalized_mutual_information(Membership(10,0),Membership(10,0))==1;
+    cout << "Normalized mutual information: " << (nmi_ok ? "OK" : "FAIL") << endl;
+    nfail += !nmi_ok;
+
+    return nfail;
+}
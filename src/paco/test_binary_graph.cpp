@@ -0,0 +1,130 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2015 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <iostream>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "Graph.h"
+#include "BinaryGraph.h"
+#include "BenchmarkGraphs.h"
+
+using namespace std;
+
+/**
+ * @brief same_graph true if a and b have the same edges in the same order with the same weights
+ */
+static bool same_graph(const GraphC &a, const GraphC &b)
+{
+    if (a.number_of_nodes()!=b.number_of_nodes() || a.number_of_edges()!=b.number_of_edges() || a.is_weighted()!=b.is_weighted())
+        return false;
+    const EdgeWeights wa = a.get_weights(), wb = b.get_weights();
+    for (size_t e=0; e<a.number_of_edges(); ++e)
+    {
+        if (a.get_edge(e)!=b.get_edge(e))
+            return false;
+        if (wa && wb && wa[e]!=wb[e])
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief rejected true if reading filename throws std::runtime_error
+ */
+static bool rejected(const string &filename)
+{
+    try
+    {
+        GraphC g;
+        g.read_binary(filename);
+    }
+    catch (std::runtime_error &)
+    {
+        return true;
+    }
+    return false;
+}
+
+int main(int argc, char *argv[])
+{
+    BenchmarkGraph bg;
+    planted_partition_graph(300,5,0.05,0.3,1,&bg);
+    unique_ptr<GraphC> graph = bg.to_graph(true);
+    const string filename = "test_binary_graph.pacobin";
+    int nfail = 0;
+
+    // Edges and weights are read back as written
+    graph->write_binary(filename);
+    GraphC read;
+    read.read_binary(filename);
+    bool round_ok = same_graph(*graph,read);
+    cout << "Round trip: " << (round_ok ? "OK" : "FAIL") << endl;
+    nfail += !round_ok;
+
+    // An edge endpoint out of the vertex range is an error, not a new vertex
+    PacoBinHeader h;
+    FILE *f = fopen(filename.c_str(),"r+b");
+    bool header_ok = f && fread(&h,sizeof(h),1,f)==1;
+    uint32_t bad_vertex = static_cast<uint32_t>(h.num_vertices);
+    header_ok = header_ok && fseek(f,static_cast<long>(h.edges_offset+sizeof(uint32_t)),SEEK_SET)==0 && fwrite(&bad_vertex,sizeof(bad_vertex),1,f)==1;
+    if (f)
+        fclose(f);
+    bool corrupt_ok = header_ok && rejected(filename);
+    cout << "Endpoint out of range: " << (corrupt_ok ? "OK" : "FAIL") << endl;
+    nfail += !corrupt_ok;
+
+    // Truncated files are an error
+    graph->write_binary(filename);
+    string bytes;
+    {
+        ifstream in(filename.c_str(),ios::binary);
+        bytes.assign(istreambuf_iterator<char>(in),istreambuf_iterator<char>());
+    }
+    {
+        ofstream out(filename.c_str(),ios::binary|ios::trunc);
+        out.write(bytes.data(),bytes.size()/2);
+    }
+    bool truncated_ok = rejected(filename);
+    cout << "Truncated file: " << (truncated_ok ? "OK" : "FAIL") << endl;
+    nfail += !truncated_ok;
+
+    // A section offset so large that the end of the section wraps around is an error
+    {
+        PacoBinHeader *wrapped = reinterpret_cast<PacoBinHeader*>(&bytes[0]);
+        wrapped->edges_offset = ~static_cast<uint64_t>(7); // 2^64-8
+        ofstream out(filename.c_str(),ios::binary|ios::trunc);
+        out.write(bytes.data(),bytes.size());
+    }
+    bool wrapped_ok = rejected(filename);
+    cout << "Section offset wrapping around: " << (wrapped_ok ? "OK" : "FAIL") << endl;
+    nfail += !wrapped_ok;
+
+    remove(filename.c_str());
+    return nfail;
+}
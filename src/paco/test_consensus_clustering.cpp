@@ -0,0 +1,86 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2015 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cmath>
+
+#include "Graph.h"
+#include "Community.h"
+#include "BenchmarkGraphs.h"
+#include "ConsensusClustering.h"
+#include "PartitionInitializer.h"
+#include "PartitionMetrics.h"
+#include "igraph_utils.h"
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+    BenchmarkGraph bg;
+    planted_partition_graph(600,6,0.05,0.2,1,&bg);
+    unique_ptr<GraphC> graph = bg.to_graph(false);
+    int nfail = 0;
+
+    // The quality of a given membership is the one returned by optimize
+    CommunityStructure c(graph.get());
+    c.set_random_seed(2);
+    double q = c.optimize(QualitySurprise,MethodAgglomerative,2);
+    vector<int> memb = c.get_membership_vector();
+    CommunityStructure given(graph.get());
+    given.initialize(MembershipInitializer(Membership(memb.begin(),memb.end())));
+    bool quality_ok = std::fabs(given.quality(QualitySurprise)-q)<1E-9*std::fabs(q);
+    cout << "Quality of a given membership: " << (quality_ok ? "OK" : "FAIL") << endl;
+    nfail += !quality_ok;
+
+    // The repetitions agree on the planted partition
+    const unsigned int nthreads = igraph_is_thread_safe() ? 4 : 1;
+    ConsensusClustering serial(*graph,1), parallel(*graph,nthreads);
+    serial.set_passes(4);
+    parallel.set_passes(4);
+    ConsensusResult rs = serial.run(QualitySurprise,MethodAgglomerative,16,5);
+    ConsensusResult rp = parallel.run(QualitySurprise,MethodAgglomerative,16,5);
+    double nmi = normalized_mutual_information(rs.membership,bg.ground_truth);
+    bool consensus_ok = rs.converged && rs.iterations>=1 && nmi>0.9 && rs.quality>0;
+    cout << "Consensus of the planted partition (NMI " << nmi << ", " << rs.iterations << " rounds): " << (consensus_ok ? "OK" : "FAIL") << endl;
+    nfail += !consensus_ok;
+
+    // The co-assignment counts of the threads add up to the same consensus
+    bool threads_ok = rp.membership==rs.membership && rp.quality==rs.quality && rp.iterations==rs.iterations;
+    cout << "Consensus over threads: " << (threads_ok ? "OK" : "FAIL") << endl;
+    nfail += !threads_ok;
+
+    // Weighted consensus graphs with Asymptotic Surprise
+    ConsensusClustering weighted(*graph,igraph_is_thread_safe() ? 2 : 1);
+    weighted.set_threshold(0.3);
+    weighted.set_max_iterations(3);
+    ConsensusResult rw = weighted.run(QualityAsymptoticSurprise,MethodRandom,8,5);
+    bool weighted_ok = rw.iterations>=1 && rw.iterations<=3 && rw.membership.size()==bg.ground_truth.size() && rw.quality>0;
+    cout << "Consensus with Asymptotic Surprise: " << (weighted_ok ? "OK" : "FAIL") << endl;
+    nfail += !weighted_ok;
+
+    return nfail;
+}
@@ -0,0 +1,131 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2015 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+#include "Graph.h"
+#include "FastParser.h"
+#include "Timer.h"
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+    // Check the number parsers against the standard library on some tricky values
+    const char *reals[] = {"0", "1", "-2.5", "+3.25", "1e3", "1E-3", "0.000123456789", "123456789012345678901234",
+                           "6.02214076e23", "4.9e-300", ".5", "5.", "0.1", "0.30000000000000004"};
+    int nfail = 0;
+    for (size_t i=0; i<sizeof(reals)/sizeof(reals[0]); ++i)
+    {
+        double fast = 0;
+        const char *s = reals[i];
+        const char *q = parse_real(s,s+strlen(s),&fast);
+        double ref = strtod(s,NULL);
+        bool ok = (q==s+strlen(s)) && std::fabs(fast-ref) <= 2E-16*std::fabs(ref);
+        cout << s << "\t" << fast << "\t" << ref << "\t" << (ok ? "OK" : "FAIL") << endl;
+        nfail += !ok;
+    }
+
+    // Parse the same weighted edges list with one and many threads, results must be identical
+    string text;
+    for (int i=0; i<200000; ++i)
+    {
+        stringstream ss;
+        ss << i << " " << (i*7+1)%200000 << "\t" << (i%100)/10.0 << "\r\n";
+        if (i%1000==0)
+            ss << "\n";
+        text += ss.str();
+    }
+    vector<igraph_real_t> e1,w1,e2,w2;
+    Timer t;
+    t.start();
+    parse_edge_list(text.data(),text.data()+text.size(),true,e1,w1,1);
+    cout << "1 thread: " << t.getElapsedTimeInMilliSec() << " [ms]" << endl;
+    t.start();
+    parse_edge_list(text.data(),text.data()+text.size(),true,e2,w2,8);
+    cout << "8 threads: " << t.getElapsedTimeInMilliSec() << " [ms]" << endl;
+    bool same = (e1==e2) && (w1==w2) && (w1.size()==200000) && (e1.size()==400000);
+    cout << "Parallel parsing consistent: " << (same ? "OK" : "FAIL") << endl;
+    nfail += !same;
+
+    // Malformed input must throw reporting the line
+    string bad = "0 1 1.0\n1 2 x\n";
+    try
+    {
+        parse_edge_list(bad.data(),bad.data()+bad.size(),true,e1,w1,1);
+        cout << "Malformed input: FAIL" << endl;
+        ++nfail;
+    }
+    catch (std::runtime_error &e)
+    {
+        cout << "Malformed input: OK (" << e.what() << ")" << endl;
+    }
+
+    // Dense adjacency matrix, only the nonzero upper triangular entries must become edges
+    string adj;
+    const int nadj = 1500;
+    for (int i=0; i<nadj; ++i)
+    {
+        stringstream ss;
+        for (int j=0; j<nadj; ++j)
+            ss << (i!=j && (i+j)%3==0 ? 0.5+(i*j)%7 : 0) << (j+1<nadj ? " " : "\n");
+        adj += ss.str();
+    }
+    igraph_integer_t n1=0, n2=0;
+    bool weighted1=false, weighted2=false;
+    parse_adj_matrix(adj.data(),adj.data()+adj.size(),e1,w1,&n1,&weighted1,1);
+    parse_adj_matrix(adj.data(),adj.data()+adj.size(),e2,w2,&n2,&weighted2,8);
+    size_t expected_edges = 0;
+    for (int i=0; i<nadj; ++i)
+        for (int j=i+1; j<nadj; ++j)
+            expected_edges += ((i+j)%3==0);
+    same = (e1==e2) && (w1==w2) && (n1==nadj) && (n2==nadj) && weighted1 && weighted2 && (w1.size()==expected_edges) && (e1[0]<e1[1]);
+    cout << "Parallel adjacency matrix parsing consistent: " << (same ? "OK" : "FAIL") << endl;
+    nfail += !same;
+
+    string nonsquare = "0 1 1\n1 0 1\n";
+    try
+    {
+        parse_adj_matrix(nonsquare.data(),nonsquare.data()+nonsquare.size(),e1,w1,&n1,&weighted1,1);
+        cout << "Non square matrix: FAIL" << endl;
+        ++nfail;
+    }
+    catch (std::runtime_error &e)
+    {
+        cout << "Non square matrix: OK (" << e.what() << ")" << endl;
+    }
+
+    if (argc>1)
+    {
+        GraphC g;
+        t.start();
+        g.read_weighted_edge_list(string(argv[1]));
+        cout << "Loaded " << argv[1] << " in " << t.getElapsedTimeInMilliSec() << " [ms]" << endl;
+        g.info();
+    }
+    return nfail;
+}
@@ -0,0 +1,135 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2015 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <cstdio>
+
+#ifndef WIN32
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+#include "FileLogger.h"
+
+using namespace std;
+
+static int evaluations = 0;
+
+static int expensive()
+{
+    return ++evaluations;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *filename = "test_file_logger.log";
+    FILE *log_file = fopen(filename,"w");
+    Output2FILE::Stream() = log_file;
+    FILELog::ReportingLevel() = logDEBUG;
+    int nfail = 0;
+
+    // Four threads log concurrently through the writer thread
+    const int nthreads = 4, nmessages = 5000;
+    vector<thread> workers;
+    for (int t=0; t<nthreads; ++t)
+        workers.push_back(thread([t]() {
+            for (int i=0; i<nmessages; ++i)
+                FILE_LOG(logDEBUG) << "thread " << t << " message " << i << " value " << 0.5*i;
+        }));
+    for (int t=0; t<nthreads; ++t)
+        workers[t].join();
+
+    // Disabled levels don't format their arguments, formatting flags don't leak to the next message
+    FILE_LOG(logDEBUG1) << "hidden " << expensive();
+    FILE_LOG(logINFO) << std::hex << 255;
+    FILE_LOG(logINFO) << 255;
+    Output2FILE::Flush();
+
+    ifstream in(filename);
+    string line;
+    vector<int> next(nthreads,0);
+    size_t nlines = 0;
+    bool order_ok = true;
+    vector<string> last;
+    while (getline(in,line))
+    {
+        ++nlines;
+        int t, i;
+        double value;
+        string tag, word1, word2, word3;
+        stringstream ss(line);
+        if (ss >> tag >> word1 >> t >> word2 >> i >> word3 >> value && tag=="[DEBUG]" && word1=="thread")
+        {
+            order_ok = order_ok && t>=0 && t<nthreads && i==next[t] && value==0.5*i;
+            next[t] = i+1;
+        }
+        else
+            last.push_back(line);
+    }
+    for (int t=0; t<nthreads; ++t)
+        order_ok = order_ok && next[t]==nmessages;
+    bool lines_ok = order_ok && nlines==size_t(nthreads*nmessages+2);
+    cout << "Concurrent messages: " << (lines_ok ? "OK" : "FAIL") << endl;
+    nfail += !lines_ok;
+
+    bool format_ok = evaluations==0 && last.size()==2 && last[0]=="[INFO] ff" && last[1]=="[INFO] 255";
+    cout << "Levels and formatting: " << (format_ok ? "OK" : "FAIL") << endl;
+    nfail += !format_ok;
+
+    Output2FILE::Stream() = stderr;
+    fclose(log_file);
+    remove(filename);
+
+#ifndef WIN32
+    // A forked child has no writer thread, its errors are still written instead of waiting forever
+    const char *child_filename = "test_file_logger_child.log";
+    pid_t pid = fork();
+    if (pid==0)
+    {
+        alarm(10);
+        Output2FILE::Stream() = fopen(child_filename,"w");
+        FILE_LOG(logINFO) << "queued";
+        FILE_LOG(logERROR) << "child error";
+        fclose(Output2FILE::Stream());
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(pid,&status,0);
+    ifstream child_in(child_filename);
+    bool child_error = false;
+    while (getline(child_in,line))
+        child_error = child_error || line=="[ERROR] child error";
+    bool fork_ok = WIFEXITED(status) && WEXITSTATUS(status)==0 && child_error;
+    cout << "Error logged without the writer thread: " << (fork_ok ? "OK" : "FAIL") << endl;
+    nfail += !fork_ok;
+    remove(child_filename);
+#endif
+
+    return nfail;
+}
@@ -0,0 +1,119 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2015 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+#include <stdexcept>
+
+#include "Graph.h"
+#include "PartitionHelper.h"
+#include "AsymptoticSurpriseFunction.h"
+#include "Community.h"
+#include "PartitionInitializer.h"
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+    // Random weighted graph with weights not representable in single precision
+    const int n = 2000, m = 20000;
+    srand(1);
+    vector<double> edges, weights;
+    for (int e=0; e<m; ++e)
+    {
+        edges.push_back(rand()%n);
+        edges.push_back(rand()%n);
+        weights.push_back(double(rand())/RAND_MAX + 1E-3);
+    }
+    GraphC gd(edges.data(),weights.data(),m);
+    GraphC gf(gd);
+    gf.set_float32_weights();
+    int nfail = 0;
+
+    bool mode_ok = gf.has_float32_weights() && gf.get_weights().is_single_precision() && !gd.get_weights().is_single_precision();
+    cout << "Single precision storage: " << (mode_ok ? "OK" : "FAIL") << endl;
+    nfail += !mode_ok;
+
+    Membership memb(n);
+    for (int i=0; i<n; ++i)
+        memb[i] = i%10;
+
+    PartitionHelper pd, pf;
+    pd.init(gd.get_igraph(),&memb,gd.get_weights());
+    pf.init(gf.get_igraph(),&memb,gf.get_weights());
+    double max_rel = 0;
+    for (int i=0; i<n; ++i)
+    {
+        double sd = VECTOR(*pd.get_all_strenghts())[i], sf = VECTOR(*pf.get_all_strenghts())[i];
+        if (sd>0)
+            max_rel = std::max(max_rel,fabs(sd-sf)/sd);
+    }
+    bool strengths_ok = max_rel < 1E-6;
+    cout << "Strengths max relative difference " << max_rel << ": " << (strengths_ok ? "OK" : "FAIL") << endl;
+    nfail += !strengths_ok;
+
+    AsymptoticSurpriseFunction fun;
+    double qd = fun(&pd), qf = fun(&pf);
+    bool quality_ok = fabs(qd-qf) <= 1E-6*fabs(qd);
+    cout << "Asymptotic surprise double=" << qd << " float=" << qf << ": " << (quality_ok ? "OK" : "FAIL") << endl;
+    nfail += !quality_ok;
+
+    // The double precision igraph vector is not available anymore
+    try
+    {
+        gf.get_edge_weights();
+        cout << "Double precision access: FAIL" << endl;
+        ++nfail;
+    }
+    catch (std::logic_error &e)
+    {
+        cout << "Double precision access: OK (" << e.what() << ")" << endl;
+    }
+
+    gf.set_float32_weights(false);
+    bool back_ok = !gf.has_float32_weights() && fabs(VECTOR(*gf.get_edge_weights())[0]-weights[0]) < 1E-6;
+    cout << "Back to double precision: " << (back_ok ? "OK" : "FAIL") << endl;
+    nfail += !back_ok;
+
+    // Switching precision after an optimization rebuilds the graph context, which viewed the released weights
+    GraphC gs(edges.data(),weights.data(),m);
+    CommunityStructure c(&gs), fresh(&gs);
+    c.set_random_seed(1);
+    c.optimize(QualityAsymptoticSurprise,MethodAgglomerative,1);
+    gs.set_float32_weights(true);
+    c.initialize(LabelPropagationInitializer(20,1));
+    vector<int> lp = c.get_membership_vector();
+    fresh.initialize(MembershipInitializer(Membership(lp.begin(),lp.end())));
+    bool switch_ok = c.quality(QualityAsymptoticSurprise)==fresh.quality(QualityAsymptoticSurprise);
+    gs.set_float32_weights(false);
+    c.initialize(LabelPropagationInitializer(20,1));
+    switch_ok = switch_ok && c.quality(QualityAsymptoticSurprise)>0;
+    cout << "Precision switched after optimize: " << (switch_ok ? "OK" : "FAIL") << endl;
+    nfail += !switch_ok;
+
+    return nfail;
+}
@@ -0,0 +1,179 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2015 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "Graph.h"
+#include "Community.h"
+#include "GraphCache.h"
+#include "PacoServer.h"
+
+#if !(defined(WIN32) || defined(_WIN32) || defined(__WIN32__))
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+using namespace std;
+
+/**
+ * @brief write_ring Writes a weighted edges list of ncliques cliques of size vertices joined in a ring
+ */
+static void write_ring(const string &filename, int ncliques, int size)
+{
+    ofstream out(filename.c_str());
+    for (int q=0; q<ncliques; ++q)
+    {
+        for (int i=0; i<size; ++i)
+            for (int j=i+1; j<size; ++j)
+                out << q*size+i << " " << q*size+j << " 1" << endl;
+        out << q*size << " " << ((q+1)%ncliques)*size+1 << " 0.1" << endl;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const string files[] = {"test_cache_a.wncol", "test_cache_b.wncol", "test_cache_c.wncol"};
+    write_ring(files[0],4,6);
+    write_ring(files[1],5,6);
+    write_ring(files[2],6,6);
+    int nfail = 0;
+
+    // Hits, misses and least recently used eviction
+    GraphCache cache(2);
+    shared_ptr<const CachedGraph> a = cache.get(files[0]);
+    bool lru_ok = a->graph->number_of_nodes()==24 && a->context && cache.get(files[0])==a;
+    cache.get(files[1]);
+    cache.get(files[0]);     // b is now the least recently used
+    cache.get(files[2]);     // evicts b
+    lru_ok = lru_ok && cache.size()==2 && cache.hits()==2 && cache.misses()==3;
+    cache.get(files[0]);
+    lru_ok = lru_ok && cache.hits()==3;
+    cache.get(files[1]);
+    lru_ok = lru_ok && cache.misses()==4 && a->graph->number_of_nodes()==24; // evicted entries live while used
+    cout << "LRU cache: " << (lru_ok ? "OK" : "FAIL") << endl;
+    nfail += !lru_ok;
+
+    // A changed file is read again
+    write_ring(files[1],7,6);
+    bool stale_ok = cache.get(files[1])->graph->number_of_nodes()==42 && cache.misses()==5;
+    cout << "Changed file read again: " << (stale_ok ? "OK" : "FAIL") << endl;
+    nfail += !stale_ok;
+
+    // The server answers with the membership and quality of a direct optimization
+    PacoServer server(2);
+    string response = server.handle_request("optimize " + files[0] + " quality=2 nrep=3 seed=4");
+    GraphC g;
+    g.read(files[0]);
+    CommunityStructure c(&g);
+    c.set_random_seed(4);
+    double q = c.optimize(QualityAsymptoticSurprise,MethodAgglomerative,3);
+    c.reindex_membership();
+    stringstream expected;
+    expected.precision(15);
+    expected << "ok " << q;
+    for (size_t v=0; v<g.number_of_nodes(); ++v)
+        expected << " " << c.get_membership(v);
+    expected << "\n";
+    bool request_ok = response==expected.str();
+    request_ok = request_ok && server.handle_request("optimize " + files[0] + " quality=2 nrep=3 seed=4")==response;
+    request_ok = request_ok && server.handle_request("stats")=="ok 1 1 1\n";
+    request_ok = request_ok && server.handle_request("optimize missing.wncol").compare(0,6,"error ")==0;
+    request_ok = request_ok && server.handle_request("optimize " + files[0] + " quality=9").compare(0,6,"error ")==0;
+    request_ok = request_ok && server.handle_request("rename " + files[0]).compare(0,6,"error ")==0;
+    cout << "Requests: " << (request_ok ? "OK" : "FAIL") << endl;
+    nfail += !request_ok;
+
+#if !(defined(WIN32) || defined(_WIN32) || defined(__WIN32__))
+    // Round trip over the socket, the server stops at the shutdown request
+    const string socket_path = "test_paco_server.sock";
+    PacoServer daemon(2);
+    std::thread serving(&PacoServer::serve,&daemon,socket_path);
+    struct sockaddr_un addr;
+    memset(&addr,0,sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path,socket_path.c_str(),sizeof(addr.sun_path)-1);
+    auto connect_server = [&]()
+    {
+        int fd = -1;
+        for (int attempt=0; attempt<100 && fd<0; ++attempt)
+        {
+            fd = socket(AF_UNIX,SOCK_STREAM,0);
+            if (connect(fd,(struct sockaddr*)&addr,sizeof(addr))!=0)
+            {
+                close(fd);
+                fd = -1;
+                usleep(20000);
+            }
+        }
+        return fd;
+    };
+    char buf[4096];
+    ssize_t n;
+
+    // Only the owner can connect, and a line without end closes its connection
+    int fd = connect_server();
+    struct stat st;
+    bool guard_ok = fd>=0 && stat(socket_path.c_str(),&st)==0 && (st.st_mode & 0777)==0600;
+    string endless(70000,'x');
+    guard_ok = guard_ok && send(fd,endless.data(),endless.size(),MSG_NOSIGNAL)==(ssize_t)endless.size();
+    string refused;
+    while (guard_ok && (n = read(fd,buf,sizeof(buf)))>0)
+        refused.append(buf,n);
+    if (fd>=0)
+        close(fd);
+    guard_ok = guard_ok && refused=="error Request too long\n";
+    cout << "Socket permissions and request length: " << (guard_ok ? "OK" : "FAIL") << endl;
+    nfail += !guard_ok;
+
+    fd = connect_server();
+    string request = "optimize " + files[0] + " quality=2 nrep=3 seed=4\nshutdown\n";
+    bool socket_ok = fd>=0 && write(fd,request.data(),request.size())==(ssize_t)request.size();
+    string received;
+    while (socket_ok && (n = read(fd,buf,sizeof(buf)))>0)
+        received.append(buf,n);
+    if (fd>=0)
+        close(fd);
+    serving.join();
+    socket_ok = socket_ok && received==response+"ok\n";
+    cout << "Socket round trip: " << (socket_ok ? "OK" : "FAIL") << endl;
+    nfail += !socket_ok;
+#endif
+
+    for (int i=0; i<3; ++i)
+        remove(files[i].c_str());
+    return nfail;
+}
@@ -0,0 +1,113 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2015 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <cstdlib>
+#include <cmath>
+
+#include "Graph.h"
+#include "GraphContext.h"
+#include "PartitionHelper.h"
+#include "AsymptoticSurpriseFunction.h"
+
+using namespace std;
+
+// Random moves from a given membership, evaluating the quality after every move
+static double random_moves(const GraphC &g, const std::shared_ptr<const GraphContext> &ctx, Membership memb, unsigned seed)
+{
+    PartitionHelper par;
+    if (ctx)
+        par.init(ctx,&memb,g.get_weights());
+    else
+        par.init(g.get_igraph(),&memb,g.get_weights());
+    AsymptoticSurpriseFunction fun;
+    double q = 0;
+    for (int i=0; i<2000; ++i)
+    {
+        seed = seed*1103515245u + 12345u;
+        int v = (seed>>8) % g.number_of_nodes();
+        par.move_vertex(g.get_igraph(),&memb,v,(seed>>4)%20,g.get_weights());
+        q += fun(&par);
+    }
+    return q;
+}
+
+int main(int argc, char *argv[])
+{
+    const int n = 500, m = 5000;
+    srand(1);
+    vector<double> edges, weights;
+    // No self loops, since PartitionHelper without context skips part of the neighbors of vertices with self loops
+    while (weights.size() < size_t(m))
+    {
+        int a = rand()%n, b = rand()%n;
+        if (a==b)
+            continue;
+        edges.push_back(a);
+        edges.push_back(b);
+        weights.push_back(double(rand())/RAND_MAX);
+    }
+    GraphC g(edges.data(),weights.data(),m);
+    std::shared_ptr<const GraphContext> ctx = std::make_shared<const GraphContext>(g);
+    int nfail = 0;
+
+    Membership memb(n);
+    for (int i=0; i<n; ++i)
+        memb[i] = i%20;
+
+    PartitionHelper p1, p2;
+    p1.init(g.get_igraph(),&memb,g.get_weights());
+    p2.init(ctx,&memb,g.get_weights());
+    bool init_ok = p1.get_total_incomm_weight()==p2.get_total_incomm_weight() && p1.get_graph_total_weight()==p2.get_graph_total_weight();
+    for (int i=0; i<n; ++i)
+        init_ok = init_ok && VECTOR(*p1.get_all_degrees())[i]==VECTOR(*p2.get_all_degrees())[i]
+                && fabs(VECTOR(*p1.get_all_strenghts())[i]-VECTOR(*p2.get_all_strenghts())[i])<1E-12;
+    cout << "Context initialization: " << (init_ok ? "OK" : "FAIL") << endl;
+    nfail += !init_ok;
+
+    double q_igraph = random_moves(g,std::shared_ptr<const GraphContext>(),memb,7);
+    double q_context = random_moves(g,ctx,memb,7);
+    bool moves_ok = fabs(q_igraph-q_context) < 1E-9*fabs(q_igraph);
+    cout << "Moves with and without context " << q_igraph << " " << q_context << ": " << (moves_ok ? "OK" : "FAIL") << endl;
+    nfail += !moves_ok;
+
+    // Many workers sharing the same context
+    const int nthreads = 4;
+    vector<double> q(nthreads);
+    vector<std::thread> workers;
+    for (int t=0; t<nthreads; ++t)
+        workers.push_back(std::thread([&,t]() { q[t] = random_moves(g,ctx,memb,7); }));
+    for (int t=0; t<nthreads; ++t)
+        workers[t].join();
+    bool threads_ok = true;
+    for (int t=0; t<nthreads; ++t)
+        threads_ok = threads_ok && q[t]==q_context;
+    cout << "Concurrent workers on a shared context: " << (threads_ok ? "OK" : "FAIL") << endl;
+    nfail += !threads_ok;
+
+    return nfail;
+}
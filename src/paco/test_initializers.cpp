@@ -0,0 +1,126 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2015 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <set>
+#include <cstdlib>
+
+#include "Graph.h"
+#include "GraphContext.h"
+#include "PartitionInitializer.h"
+#include "Community.h"
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+    // Ten cliques of 20 vertices joined in a ring by a single edge
+    const int ncliques = 10, size = 20, n = ncliques*size;
+    vector<double> edges;
+    for (int q=0; q<ncliques; ++q)
+    {
+        for (int i=0; i<size; ++i)
+            for (int j=i+1; j<size; ++j)
+            {
+                edges.push_back(q*size+i);
+                edges.push_back(q*size+j);
+            }
+        edges.push_back(q*size);
+        edges.push_back(((q+1)%ncliques)*size+1);
+    }
+    GraphC g(edges.data(),(const double*)NULL,edges.size()/2);
+    GraphContext ctx(g);
+    igraph_rng_t rng;
+    igraph_rng_init(&rng,&igraph_rngtype_mt19937);
+    igraph_rng_seed(&rng,42);
+    int nfail = 0;
+
+    Membership memb;
+    SingletonInitializer().initialize(ctx,&memb,&rng);
+    bool singleton_ok = memb.size()==size_t(n);
+    for (int v=0; v<n; ++v)
+        singleton_ok = singleton_ok && memb[v]==uint32_t(v);
+    cout << "Singletons: " << (singleton_ok ? "OK" : "FAIL") << endl;
+    nfail += !singleton_ok;
+
+    RandomInitializer(7).initialize(ctx,&memb,&rng);
+    set<uint32_t> ids(memb.begin(),memb.end());
+    bool random_ok = memb.size()==size_t(n) && ids.size()==7 && *ids.rbegin()==6;
+    cout << "Random clusters: " << (random_ok ? "OK" : "FAIL") << endl;
+    nfail += !random_ok;
+
+    // Every clique is found whatever the number of threads
+    Membership lpa1, lpa4;
+    igraph_rng_seed(&rng,1);
+    LabelPropagationInitializer(20,1).initialize(ctx,&lpa1,&rng);
+    igraph_rng_seed(&rng,1);
+    LabelPropagationInitializer(20,4).initialize(ctx,&lpa4,&rng);
+    bool lpa_ok = lpa1==lpa4;
+    for (int v=0; v<n; ++v)
+        lpa_ok = lpa_ok && (lpa1[v]==lpa1[(v/size)*size+2]) && (v<size || lpa1[v]!=lpa1[2]);
+    cout << "Label propagation: " << (lpa_ok ? "OK" : "FAIL") << endl;
+    nfail += !lpa_ok;
+
+    // The optimizers start from the initializer output
+    CommunityStructure c(&g);
+    c.set_random_seed(3);
+    c.initialize(LabelPropagationInitializer());
+    const char *filename = "test_initializers_membership.txt";
+    c.save_membership(filename);
+    FileInitializer(filename).initialize(ctx,&memb,&rng);
+    Membership saved(n);
+    for (int v=0; v<n; ++v)
+        saved[v] = c.get_membership(v);
+    renumber_first_appearance(&saved);
+    bool file_ok = memb==saved;
+    cout << "Membership file: " << (file_ok ? "OK" : "FAIL") << endl;
+    nfail += !file_ok;
+
+    // Large community ids are renumbered rather than allocating as many communities
+    {
+        ofstream out(filename);
+        for (int v=0; v<n; ++v)
+            out << (v<size ? 3000000000U : 7U) << "\n";
+    }
+    FileInitializer(filename).initialize(ctx,&memb,&rng);
+    bool large_ok = memb.size()==size_t(n);
+    for (int v=0; v<n; ++v)
+        large_ok = large_ok && memb[v]==(v<size ? 0U : 1U);
+    cout << "Membership file with large ids: " << (large_ok ? "OK" : "FAIL") << endl;
+    nfail += !large_ok;
+    remove(filename);
+
+    double q = c.optimize(QualityAsymptoticSurprise,MethodAgglomerative,1);
+    set<uint32_t> final_ids;
+    for (int v=0; v<n; ++v)
+        final_ids.insert(c.get_membership(v));
+    bool optimize_ok = final_ids.size()==size_t(ncliques) && q>0;
+    cout << "Optimization from label propagation " << q << ": " << (optimize_ok ? "OK" : "FAIL") << endl;
+    nfail += !optimize_ok;
+
+    igraph_rng_destroy(&rng);
+    return nfail;
+}
@@ -0,0 +1,87 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2015 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <iostream>
+#include <vector>
+
+#include "Graph.h"
+#include "PartitionHelper.h"
+#include "SurpriseFunction.h"
+#include "Surprise.h"
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+    // A sparse ring on more than 46341 vertices, where n*(n-1)/2 doesn't fit in 32 bits
+    const int64_t n = 100000;
+    vector<double> edges;
+    for (int64_t i=0; i<n; ++i)
+    {
+        edges.push_back(i);
+        edges.push_back((i+1)%n);
+    }
+    GraphC g(edges.data(),static_cast<const double*>(NULL),n);
+    int nfail = 0;
+
+    // Two communities made of the two halves of the ring
+    Membership memb(n);
+    for (int64_t i=0; i<n; ++i)
+        memb[i] = (i < n/2) ? 0 : 1;
+
+    PartitionHelper par;
+    par.init(g.get_igraph(),&memb);
+    bool total_ok = par.get_graph_total_pairs()==n*(n-1)/2;
+    cout << "Total pairs " << par.get_graph_total_pairs() << ": " << (total_ok ? "OK" : "FAIL") << endl;
+    nfail += !total_ok;
+
+    // Move a vertex, the incremental pairs update must match the count from scratch
+    par.move_vertex(g.get_igraph(),&memb,0,1);
+    int64_t expected = num_pairs(n/2-1) + num_pairs(n/2+1);
+    bool move_ok = par.get_total_incomm_pairs()==expected;
+    cout << "Intracluster pairs after move " << par.get_total_incomm_pairs() << ": " << (move_ok ? "OK" : "FAIL") << endl;
+    nfail += !move_ok;
+
+    SurpriseFunction fun;
+    double s1 = fun(&par);
+    double s2 = fun(g.get_igraph(),memb,NULL);
+    bool surprise_ok = s1>0 && s1==s2;
+    cout << "Surprise " << s1 << " " << s2 << ": " << (surprise_ok ? "OK" : "FAIL") << endl;
+    nfail += !surprise_ok;
+
+    // Counts beyond 64 bits must be reported, not wrapped around
+    try
+    {
+        checkedCount(1E20,"p");
+        cout << "Overflow check: FAIL" << endl;
+        ++nfail;
+    }
+    catch (std::logic_error &e)
+    {
+        cout << "Overflow check: OK (" << e.what() << ")" << endl;
+    }
+
+    return nfail;
+}
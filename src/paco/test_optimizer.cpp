@@ -54,7 +54,9 @@ int main(int argc, char *argv[])
     opt.set_edges_order(c.get_sorted_edges_indices());
 
 
-    cerr << "Final S=" << opt.optimize(h.get_igraph(),fun,c.get_membership()) << endl;
+    Membership memb;
+    membership_from_igraph(c.get_membership(),memb);
+    cerr << "Final S=" << opt.optimize(h.get_igraph(),fun,&memb) << endl;
     //c.reindex_membership();
     //c.save_membership("test.csv");
     return 0;
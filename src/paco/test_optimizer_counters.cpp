@@ -0,0 +1,100 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2015 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cmath>
+
+#include "Graph.h"
+#include "Community.h"
+#include "BenchmarkGraphs.h"
+#include "OptimizerCounters.h"
+
+using namespace std;
+
+/**
+ * @brief consistent true if the moves add up and all the times are non negative
+ */
+static bool consistent(const OptimizerCounters &c)
+{
+    return c.moves_attempted>0 && c.moves_accepted+c.moves_reverted<=c.moves_attempted && c.quality_evaluations>0
+            && c.init_time>=0 && c.sort_time>=0 && c.optimize_time>=0 && c.evaluation_time>=0;
+}
+
+int main(int argc, char *argv[])
+{
+    BenchmarkGraph bg;
+    planted_partition_graph(400,8,0.05,0.2,1,&bg);
+    set_benchmark_weights(&bg,0.5,2);
+    unique_ptr<GraphC> binary = bg.to_graph(false);
+    unique_ptr<GraphC> weighted = bg.to_graph(true);
+    int nfail = 0;
+
+    // Every optimizer on Surprise, the moves that leave the partition unchanged are evaluated once
+    const char *method_names[] = {"Agglomerative", "Random"};
+    for (int m=MethodAgglomerative; m<=MethodRandom; ++m)
+    {
+        CommunityStructure c(binary.get());
+        c.set_random_seed(3);
+        c.optimize(QualitySurprise,static_cast<OptimizerType>(m),2);
+        const OptimizerCounters &counters = c.get_counters();
+        bool ok = consistent(counters) && counters.surprise_terms>0 && counters.cache_hits>0
+                && counters.quality_evaluations+counters.cache_hits>=2*(counters.moves_accepted+counters.moves_reverted);
+        cout << "Counters of " << method_names[m] << ": " << (ok ? "OK" : "FAIL") << endl;
+        nfail += !ok;
+    }
+
+    // Asymptotic Surprise sums no hypergeometric terms, the counters restart at every optimize
+    CommunityStructure c(weighted.get());
+    c.set_random_seed(3);
+    c.optimize(QualityAsymptoticSurprise,MethodAgglomerative,3);
+    uint64_t attempted = c.get_counters().moves_attempted;
+    c.optimize(QualityAsymptoticSurprise,MethodAgglomerative,3);
+    bool asymptotic_ok = consistent(c.get_counters()) && c.get_counters().surprise_terms==0
+            && c.get_counters().moves_attempted<=3*bg.num_edges() && attempted<=3*bg.num_edges();
+    cout << "Counters of Asymptotic Surprise: " << (asymptotic_ok ? "OK" : "FAIL") << endl;
+    nfail += !asymptotic_ok;
+
+    // Reoptimize counts only the local moves around the edits
+    vector<EdgeEdit> edits;
+    edits.push_back(EdgeEdit(EdgeEdit::Insert,0,1,1.0));
+    edits.push_back(EdgeEdit(EdgeEdit::Insert,0,2,1.0));
+    vector<EdgeChange> changes = weighted->apply_edits(edits);
+    c.reoptimize(changes,QualityAsymptoticSurprise);
+    bool reoptimize_ok = c.get_counters().quality_evaluations>0 && c.get_counters().moves_attempted<attempted
+            && c.get_counters().moves_accepted+c.get_counters().moves_reverted<=c.get_counters().moves_attempted;
+    cout << "Counters of reoptimize: " << (reoptimize_ok ? "OK" : "FAIL") << endl;
+    nfail += !reoptimize_ok;
+
+    // JSON dump
+    string json = c.get_counters().to_json();
+    bool json_ok = json[0]=='{' && json[json.size()-1]=='}' && json.find("\"moves_attempted\": ")!=string::npos
+            && json.find("\"cache_hits\": ")!=string::npos && json.find("\"evaluation\": ")!=string::npos;
+    cout << "Counters JSON: " << (json_ok ? "OK" : "FAIL") << endl;
+    nfail += !json_ok;
+
+    return nfail;
+}
@@ -62,12 +62,17 @@ int main(int argc, char *argv[])
     pars.temperature = 1;
     ann.set_parameters(pars);
 
-    cerr << "Annealing AS=" << ann.optimize(h.get_igraph(),fun,c.get_membership(),NULL) << endl;
+    Membership memb;
+    membership_from_igraph(c.get_membership(),memb);
+    cerr << "Annealing AS=" << ann.optimize(h.get_igraph(),fun,&memb,NULL) << endl;
 
-    c.reindex_membership();
-    c.save_membership("test.csv");
+    igraph_vector_t m;
+    igraph_vector_init(&m,0);
+    membership_to_igraph(memb,&m);
+    c.save_membership("test.csv",&m);
 
-    igraph_vector_print(c.get_membership());
+    igraph_vector_print(&m);
+    igraph_vector_destroy(&m);
 
     return 0;
 }
@@ -42,20 +42,22 @@ int main(int argc, char *argv[])
     CommunityStructure c(&h);
     c.read_membership_from_file(argv[2]);
 
-    const igraph_vector_t *m = c.get_membership();
+    Membership memb;
+    membership_from_igraph(c.get_membership(),memb);
+    Membership *m = &memb;
     const igraph_vector_t *w = h.get_edge_weights();
     PartitionHelper par;
     par.init(g,m,w);
 
     AsymptoticSurpriseFunction f;
-    cout << "AS pre movement=" << f(g,m,w) << endl;
+    cout << "AS pre movement=" << f(g,*m,w) << endl;
     par.move_vertex(g,m,0,29,h.get_edge_weights());
     par.move_vertex(g,m,1,29,h.get_edge_weights());
     par.move_vertex(g,m,2,29,h.get_edge_weights());
     par.move_vertex(g,m,3,29,h.get_edge_weights());
     //igraph_vector_print(m);
     par.print();
-    cout << "AS pre movement=" << f(g,m,w) << endl;
+    cout << "AS pre movement=" << f(g,*m,w) << endl;
     /*
     SurpriseFunction f;
     cout << f(&par) << endl;
@@ -0,0 +1,109 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2015 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <iostream>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+#include "Common.h"
+#include "PartitionMetrics.h"
+
+using namespace std;
+
+static bool close(double x, double y)
+{
+    return std::fabs(x-y)<1E-12;
+}
+
+int main(int argc, char *argv[])
+{
+    int nfail = 0;
+
+    // Identical partitions up to a relabeling of the communities
+    uint32_t a_init[] = {0,0,0,1,1,1};
+    uint32_t r_init[] = {7,7,7,2,2,2};
+    Membership a(a_init,a_init+6), relabeled(r_init,r_init+6);
+    PartitionComparison same = compare_partitions(a,relabeled);
+    bool same_ok = close(same.nmi,1) && close(same.vi,0) && close(same.ari,1) && close(same.jaccard,1);
+    cout << "Identical partitions: " << (same_ok ? "OK" : "FAIL") << endl;
+    nfail += !same_ok;
+
+    // Contingency table {{2,1,0},{0,1,2}}: 2 pairs together in both, 6 in a, 3 in b out of 15
+    uint32_t b_init[] = {0,0,1,1,2,2};
+    Membership b(b_init,b_init+6);
+    PartitionComparison c = compare_partitions(a,b);
+    bool known_ok = close(c.ari,(2-1.2)/(4.5-1.2)) && close(c.jaccard,2.0/7)
+            && close(c.vi,std::log(3.0)-std::log(2.0)/3)
+            && close(c.nmi,normalized_mutual_information(a,b))
+            && close(c.vi,variation_of_information(b,a)) && close(c.ari,adjusted_rand_index(b,a))
+            && close(c.jaccard,jaccard_index(b,a));
+    cout << "Known contingency table: " << (known_ok ? "OK" : "FAIL") << endl;
+    nfail += !known_ok;
+
+    // Partitions made only of singletons agree on every pair
+    uint32_t s_init[] = {0,1,2,3,4,5};
+    uint32_t t_init[] = {5,4,3,2,1,0};
+    PartitionComparison singletons = compare_partitions(Membership(s_init,s_init+6),Membership(t_init,t_init+6));
+    bool singletons_ok = close(singletons.ari,1) && close(singletons.jaccard,1) && close(singletons.vi,0);
+    cout << "Singleton partitions: " << (singletons_ok ? "OK" : "FAIL") << endl;
+    nfail += !singletons_ok;
+
+    // Many against one over threads gives the comparisons one by one
+    const size_t n = 5000;
+    Membership reference(n);
+    for (size_t v=0; v<n; ++v)
+        reference[v] = static_cast<uint32_t>(v/50);
+    vector<Membership> many(37,Membership(n));
+    for (size_t i=0; i<many.size(); ++i)
+    {
+        for (size_t v=0; v<n; ++v)
+            many[i][v] = static_cast<uint32_t>((v*(i+1)*2654435761U)%(i+2)==0 ? v/50 : 1000000000U+v%(7*i+3));
+    }
+    vector<PartitionComparison> serial = compare_partitions(many,reference,1);
+    vector<PartitionComparison> parallel = compare_partitions(many,reference,4);
+    bool many_ok = serial.size()==many.size() && parallel.size()==many.size();
+    for (size_t i=0; many_ok && i<many.size(); ++i)
+    {
+        PartitionComparison one = compare_partitions(many[i],reference);
+        many_ok = one.nmi==serial[i].nmi && one.vi==serial[i].vi && one.ari==serial[i].ari && one.jaccard==serial[i].jaccard
+                && one.nmi==parallel[i].nmi && one.vi==parallel[i].vi && one.ari==parallel[i].ari && one.jaccard==parallel[i].jaccard;
+    }
+    cout << "Many partitions against one: " << (many_ok ? "OK" : "FAIL") << endl;
+    nfail += !many_ok;
+
+    // Partitions of different sizes can't be compared
+    bool size_ok = false;
+    try
+    {
+        compare_partitions(a,reference);
+    }
+    catch (std::logic_error &)
+    {
+        size_ok = true;
+    }
+    cout << "Partitions of different sizes: " << (size_ok ? "OK" : "FAIL") << endl;
+    nfail += !size_ok;
+
+    return nfail;
+}
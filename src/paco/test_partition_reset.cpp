@@ -0,0 +1,140 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2015 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+
+#include "Graph.h"
+#include "GraphContext.h"
+#include "PartitionHelper.h"
+#include "Community.h"
+#include "AsymptoticSurpriseFunction.h"
+
+using namespace std;
+
+// Compares the community aggregates of two helpers
+static bool same_partition(const PartitionHelper &a, const PartitionHelper &b)
+{
+    if (a.get_communities()!=b.get_communities() || a.get_num_comms()!=b.get_num_comms())
+        return false;
+    if (a.get_total_incomm_weight()!=b.get_total_incomm_weight() || a.get_total_incomm_pairs()!=b.get_total_incomm_pairs())
+        return false;
+    for (CommListCIter it=a.get_communities().begin(); it!=a.get_communities().end(); ++it)
+    {
+        size_t c = *it;
+        if (a.get_incomm_nvert().at(c)!=b.get_incomm_nvert().at(c) || a.get_incomm_pairs().at(c)!=b.get_incomm_pairs().at(c)
+                || a.get_incomm_weight().at(c)!=b.get_incomm_weight().at(c) || a.get_incomm_deg().at(c)!=b.get_incomm_deg().at(c))
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    const int n = 300, m = 3000;
+    srand(3);
+    vector<double> edges, weights;
+    while (weights.size() < size_t(m))
+    {
+        int a = rand()%n, b = rand()%n;
+        if (a==b)
+            continue;
+        edges.push_back(a);
+        edges.push_back(b);
+        weights.push_back(double(rand())/RAND_MAX);
+    }
+    GraphC g(edges.data(),weights.data(),m);
+    std::shared_ptr<const GraphContext> ctx = std::make_shared<const GraphContext>(g);
+    int nfail = 0;
+
+    Membership initial(n), memb;
+    for (int i=0; i<n; ++i)
+        initial[i] = i;
+
+    // Moves vertices around, then resets to the initial partition
+    PartitionHelper par, fresh;
+    memb = initial;
+    par.init(ctx,&memb,g.get_weights());
+    const double *weight_buffer = par.get_incomm_weight().data();
+    const size_t *comm_buffer = par.get_communities().data();
+    AsymptoticSurpriseFunction fun;
+    double q0 = fun(&par);
+    for (int rep=0; rep<3; ++rep)
+    {
+        for (int i=0; i<1000; ++i)
+        {
+            int e = rand()%m;
+            par.move_vertex(g.get_igraph(),&memb,edges[2*e],memb[edges[2*e+1]],g.get_weights());
+        }
+        memb = initial;
+        par.reset(&memb,g.get_weights());
+    }
+    fresh.init(ctx,&memb,g.get_weights());
+    bool reset_ok = same_partition(par,fresh) && fun(&par)==q0;
+    cout << "Reset to the initial partition: " << (reset_ok ? "OK" : "FAIL") << endl;
+    nfail += !reset_ok;
+
+    bool buffers_ok = par.get_incomm_weight().data()==weight_buffer && par.get_communities().data()==comm_buffer;
+    cout << "Buffers reused by reset: " << (buffers_ok ? "OK" : "FAIL") << endl;
+    nfail += !buffers_ok;
+
+    // Moves to a community id beyond the initial ones
+    Membership half(n);
+    for (int i=0; i<n; ++i)
+        half[i] = i/2;
+    memb = half;
+    par.reset(&memb,g.get_weights());
+    par.move_vertex(g.get_igraph(),&memb,0,n+5,g.get_weights());
+    Membership moved(memb);
+    fresh.init(ctx,&moved,g.get_weights());
+    bool grow_ok = par.get_incomm_nvert().at(n+5)==1 && par.get_total_incomm_weight()==fresh.get_total_incomm_weight()
+            && par.get_communities().back()==size_t(n+5) && fabs(fun(&par)-fun(&fresh))<1E-9*fabs(fun(&fresh));
+    cout << "New community after reset: " << (grow_ok ? "OK" : "FAIL") << endl;
+    nfail += !grow_ok;
+
+    // Repetitions from singletons are independent of each other, so a single repetition matches the first of many
+    CommunityStructure c1(&g), c2(&g);
+    c1.set_initial_partition(InitialSingletons);
+    c2.set_initial_partition(InitialSingletons);
+    srand(11);
+    double q1 = c1.optimize(QualityAsymptoticSurprise,MethodAgglomerative,1);
+    srand(11);
+    double q2 = c2.optimize(QualityAsymptoticSurprise,MethodAgglomerative,4);
+    bool singletons_ok = q2 >= q1;
+    cout << "Repetitions from singletons " << q1 << " " << q2 << ": " << (singletons_ok ? "OK" : "FAIL") << endl;
+    nfail += !singletons_ok;
+
+    // Repetitions from a given membership keep starting from it
+    CommunityStructure c3(&g);
+    c3.set_initial_partition(InitialGiven);
+    srand(11);
+    double q3 = c3.optimize(QualityAsymptoticSurprise,MethodAgglomerative,4);
+    bool given_ok = q3 == q2;
+    cout << "Repetitions from the given singletons " << q3 << ": " << (given_ok ? "OK" : "FAIL") << endl;
+    nfail += !given_ok;
+
+    return nfail;
+}
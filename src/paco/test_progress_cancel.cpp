@@ -0,0 +1,134 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2015 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <chrono>
+
+#include "Graph.h"
+#include "Community.h"
+#include "BenchmarkGraphs.h"
+
+using namespace std;
+
+/**
+ * Progress reports received by the callback
+ */
+struct ProgressLog
+{
+    vector<OptimizerProgress> reports;
+    size_t stop_after=0; // cancels at this report, never if 0
+};
+
+static bool log_progress(const OptimizerProgress &progress, void *data)
+{
+    ProgressLog *log = static_cast<ProgressLog*>(data);
+    log->reports.push_back(progress);
+    return log->reports.size()!=log->stop_after;
+}
+
+/**
+ * @brief valid_membership true if every vertex has a community in [0,n)
+ */
+static bool valid_membership(const CommunityStructure &c, size_t n)
+{
+    vector<int> memb = c.get_membership_vector();
+    if (memb.size()!=n)
+        return false;
+    for (size_t i=0; i<n; ++i)
+        if (memb[i]<0 || static_cast<size_t>(memb[i])>=n)
+            return false;
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    BenchmarkGraph bg;
+    planted_partition_graph(1000,10,0.05,0.2,1,&bg);
+    unique_ptr<GraphC> graph = bg.to_graph(false);
+    const size_t n = bg.num_nodes;
+    int nfail = 0;
+
+    // Reports in order, the callback doesn't change the result
+    CommunityStructure plain(graph.get()), reported(graph.get());
+    plain.set_random_seed(3);
+    reported.set_random_seed(3);
+    ProgressLog log;
+    reported.set_progress_callback(log_progress,&log,1000);
+    double q_plain = plain.optimize(QualitySurprise,MethodAgglomerative,3);
+    double q_reported = reported.optimize(QualitySurprise,MethodAgglomerative,3);
+    bool reports_ok = log.reports.size()>2 && q_plain==q_reported && !reported.cancelled()
+            && plain.get_membership_vector()==reported.get_membership_vector();
+    for (size_t i=0; i<log.reports.size(); ++i)
+    {
+        const OptimizerProgress &p = log.reports[i];
+        reports_ok = reports_ok && p.repetitions==3 && p.repetition<3 && (p.repetition==0 || p.best_quality>0);
+        if (i>0)
+            reports_ok = reports_ok && p.repetition>=log.reports[i-1].repetition
+                    && (p.repetition>log.reports[i-1].repetition || p.steps>log.reports[i-1].steps);
+    }
+    cout << "Progress reports: " << (reports_ok ? "OK" : "FAIL") << endl;
+    nfail += !reports_ok;
+
+    // The callback cancels at its second call
+    CommunityStructure stopped(graph.get());
+    stopped.set_random_seed(3);
+    ProgressLog stop_log;
+    stop_log.stop_after = 2;
+    stopped.set_progress_callback(log_progress,&stop_log,1000);
+    double q_stopped = stopped.optimize(QualitySurprise,MethodAgglomerative,100);
+    bool stop_ok = stopped.cancelled() && stop_log.reports.size()==2 && q_stopped>0 && valid_membership(stopped,n);
+    cout << "Cancel from the callback: " << (stop_ok ? "OK" : "FAIL") << endl;
+    nfail += !stop_ok;
+
+    // Cancel from another thread
+    CommunityStructure running(graph.get());
+    running.set_random_seed(3);
+    double q_running = 0;
+    auto start = chrono::steady_clock::now();
+    thread worker([&]() { q_running = running.optimize(QualitySurprise,MethodRandom,1000000); });
+    this_thread::sleep_for(chrono::milliseconds(50));
+    running.cancel();
+    worker.join();
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now()-start).count();
+    bool thread_ok = running.cancelled() && elapsed<5 && q_running>0 && valid_membership(running,n);
+    cout << "Cancel from another thread: " << (thread_ok ? "OK" : "FAIL") << endl;
+    nfail += !thread_ok;
+
+    // A cancel before optimize stops it at its first check and is then cleared
+    CommunityStructure early(graph.get());
+    early.set_random_seed(3);
+    early.cancel();
+    early.optimize(QualitySurprise,MethodAgglomerative,100);
+    bool early_ok = early.cancelled() && valid_membership(early,n);
+    early.optimize(QualitySurprise,MethodAgglomerative,1);
+    early_ok = early_ok && !early.cancelled();
+    cout << "Cancel before optimize: " << (early_ok ? "OK" : "FAIL") << endl;
+    nfail += !early_ok;
+
+    return nfail;
+}
@@ -0,0 +1,132 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2015 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+
+#include "Graph.h"
+#include "GraphContext.h"
+#include "PartitionHelper.h"
+#include "Community.h"
+#include "AsymptoticSurpriseFunction.h"
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+    // Eight weighted cliques of 15 vertices joined in a ring by a single light edge
+    const int ncliques = 8, size = 15, n = ncliques*size;
+    srand(5);
+    vector<double> edges, weights;
+    for (int q=0; q<ncliques; ++q)
+    {
+        for (int i=0; i<size; ++i)
+            for (int j=i+1; j<size; ++j)
+            {
+                edges.push_back(q*size+i);
+                edges.push_back(q*size+j);
+                weights.push_back(0.5+double(rand())/RAND_MAX);
+            }
+        edges.push_back(q*size);
+        edges.push_back(((q+1)%ncliques)*size+1);
+        weights.push_back(0.1);
+    }
+    GraphC g(edges.data(),weights.data(),weights.size());
+    const size_t m0 = g.number_of_edges();
+    int nfail = 0;
+
+    CommunityStructure c(&g);
+    c.set_random_seed(1);
+    c.optimize(QualityAsymptoticSurprise,MethodAgglomerative,3);
+    Membership memb(n);
+    for (int v=0; v<n; ++v)
+        memb[v] = c.get_membership(v);
+    std::shared_ptr<const GraphContext> ctx0 = std::make_shared<const GraphContext>(g);
+    PartitionHelper par;
+    par.init(ctx0,&memb,g.get_weights());
+
+    // Vertex 5 leaves its clique for the third one, a light edge is reweighted
+    vector<EdgeEdit> edits;
+    for (int j=0; j<size; ++j)
+    {
+        if (j!=5)
+            edits.push_back(EdgeEdit(EdgeEdit::Delete,5,j));
+        edits.push_back(EdgeEdit(EdgeEdit::Insert,5,3*size+j,1.2));
+    }
+    edits.push_back(EdgeEdit(EdgeEdit::Reweight,size,2*size+1,0.3));
+    edits.push_back(EdgeEdit(EdgeEdit::Insert,0,1,5.0)); // existing edge, not changed
+    vector<EdgeChange> changes = g.apply_edits(edits);
+
+    igraph_integer_t eid;
+    igraph_get_eid(g.get_igraph(),&eid,5,3*size+2,false,false);
+    bool edits_ok = g.number_of_edges()==m0+1 && changes.size()==size_t(2*size) && eid>=0 && g.get_weights()[eid]==1.2
+            && !g.is_edge(5,6) && g.is_edge(0,1);
+    cout << "Edits applied " << g.number_of_edges() << " edges, " << changes.size() << " changes: " << (edits_ok ? "OK" : "FAIL") << endl;
+    nfail += !edits_ok;
+
+    // Aggregates updated from the changes match those recomputed on the edited graph
+    std::shared_ptr<const GraphContext> ctx1 = std::make_shared<const GraphContext>(g);
+    par.update_graph(ctx1,changes);
+    PartitionHelper fresh;
+    fresh.init(ctx1,&memb,g.get_weights());
+    bool update_ok = fabs(par.get_total_incomm_weight()-fresh.get_total_incomm_weight())<1E-9 && par.get_graph_total_weight()==fresh.get_graph_total_weight();
+    for (CommListCIter it=fresh.get_communities().begin(); it!=fresh.get_communities().end(); ++it)
+        update_ok = update_ok && fabs(par.get_incomm_weight().at(*it)-fresh.get_incomm_weight().at(*it))<1E-9
+                && fabs(par.get_incomm_deg().at(*it)-fresh.get_incomm_deg().at(*it))<1E-9;
+    cout << "Aggregates updated in place: " << (update_ok ? "OK" : "FAIL") << endl;
+    nfail += !update_ok;
+
+    // The moved vertex follows its new clique, the others stay
+    double q = c.reoptimize(changes,QualityAsymptoticSurprise);
+    bool moved_ok = c.get_membership(5)==c.get_membership(3*size);
+    for (int v=0; v<n; ++v)
+        if (v!=5)
+            moved_ok = moved_ok && c.get_membership(v)==memb[v];
+    AsymptoticSurpriseFunction fun;
+    Membership final_memb(n);
+    for (int v=0; v<n; ++v)
+        final_memb[v] = c.get_membership(v);
+    double q_full = fun(g.get_igraph(),final_memb,g.get_weights());
+    bool quality_ok = fabs(q-q_full) < 1E-9*fabs(q_full);
+    cout << "Reoptimized vertex moved: " << (moved_ok ? "OK" : "FAIL") << endl;
+    cout << "Reoptimized quality " << q << " " << q_full << ": " << (quality_ok ? "OK" : "FAIL") << endl;
+    nfail += !moved_ok + !quality_ok;
+
+    // A second batch reuses the aggregates of the first one: vertex 5 goes back
+    edits.clear();
+    for (int j=0; j<size; ++j)
+    {
+        edits.push_back(EdgeEdit(EdgeEdit::Delete,5,3*size+j));
+        if (j!=5)
+            edits.push_back(EdgeEdit(EdgeEdit::Insert,5,j,1.0));
+    }
+    q = c.reoptimize(g.apply_edits(edits),QualityAsymptoticSurprise);
+    bool back_ok = c.get_membership(5)==c.get_membership(0) && g.number_of_edges()==m0;
+    cout << "Second batch: " << (back_ok ? "OK" : "FAIL") << endl;
+    nfail += !back_ok;
+
+    return nfail;
+}
@@ -0,0 +1,106 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2015 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+
+#include "Graph.h"
+#include "Community.h"
+#include "BenchmarkGraphs.h"
+#include "RepetitionRace.h"
+#include "igraph_utils.h"
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+    BenchmarkGraph bg;
+    planted_partition_graph(1000,10,0.05,0.3,1,&bg);
+    unique_ptr<GraphC> graph = bg.to_graph(false);
+    const size_t n = bg.num_nodes;
+    const size_t nrep = 24;
+    int nfail = 0;
+
+    // Without racing every repetition runs to the end and the threads don't change the result
+    const unsigned int nthreads = igraph_is_thread_safe() ? 4 : 1;
+    RepetitionRace serial(*graph,1), parallel(*graph,nthreads);
+    serial.set_margin(-1);
+    parallel.set_margin(-1);
+    RaceResult rs = serial.run(QualitySurprise,MethodAgglomerative,nrep,11);
+    RaceResult rp = parallel.run(QualitySurprise,MethodAgglomerative,nrep,11);
+    bool norace_ok = rs.completed==nrep && rs.abandoned==0 && rp.completed==nrep && rp.abandoned==0
+            && rs.quality==rp.quality && rs.membership==rp.membership && rs.membership.size()==n;
+    cout << "Repetitions without racing: " << (norace_ok ? "OK" : "FAIL") << endl;
+    nfail += !norace_ok;
+
+    // Racing abandons the repetitions that trail, the best one is among the completed ones
+    RepetitionRace racing(*graph,1);
+    racing.set_margin(0);
+    racing.set_checkpoint_interval(256);
+    RaceResult rr = racing.run(QualitySurprise,MethodAgglomerative,nrep,11);
+    bool race_ok = rr.abandoned>0 && rr.completed>0 && rr.completed+rr.abandoned==nrep && rr.quality>0
+            && rr.membership.size()==n;
+    cout << "Racing repetitions: " << (race_ok ? "OK" : "FAIL") << endl;
+    nfail += !race_ok;
+
+    // Every repetition is accounted for with many threads too
+    RepetitionRace racing_parallel(*graph,nthreads);
+    racing_parallel.set_margin(0.01);
+    RaceResult rq = racing_parallel.run(QualitySurprise,MethodRandom,nrep,11);
+    bool parallel_ok = rq.completed>0 && rq.completed+rq.abandoned==nrep && rq.quality>0;
+    cout << "Racing repetitions in parallel: " << (parallel_ok ? "OK" : "FAIL") << endl;
+    nfail += !parallel_ok;
+
+    // More than one thread is refused without a thread safe igraph
+    bool gate_ok = false;
+    try
+    {
+        RepetitionRace threads(*graph,4);
+        gate_ok = igraph_is_thread_safe();
+    }
+    catch (std::logic_error &)
+    {
+        gate_ok = !igraph_is_thread_safe();
+    }
+    cout << "Threads and igraph thread safety: " << (gate_ok ? "OK" : "FAIL") << endl;
+    nfail += !gate_ok;
+
+    // Infomap is run by igraph and can't be raced
+    bool infomap_ok = false;
+    try
+    {
+        serial.run(QualityInfoMap,MethodAgglomerative,nrep,11);
+    }
+    catch (std::logic_error &)
+    {
+        infomap_ok = true;
+    }
+    cout << "Racing Infomap: " << (infomap_ok ? "OK" : "FAIL") << endl;
+    nfail += !infomap_ok;
+
+    return nfail;
+}
@@ -0,0 +1,91 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2015 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <cstdlib>
+
+#include "Graph.h"
+#include "Community.h"
+
+using namespace std;
+
+/**
+ * @brief run_optimization Optimizes g with a given seed and returns the membership
+ */
+static Membership run_optimization(GraphC *g, OptimizerType method, int seed, double *quality)
+{
+    CommunityStructure c(g);
+    c.set_random_seed(seed);
+    *quality = c.optimize(QualityAsymptoticSurprise,method,3);
+    Membership memb(g->number_of_nodes());
+    for (size_t v=0; v<memb.size(); ++v)
+        memb[v] = c.get_membership(v);
+    return memb;
+}
+
+int main(int argc, char *argv[])
+{
+    // Random weighted graph with ties in the edge weights, so that the edge order is shuffled too
+    const int n = 80;
+    srand(11);
+    vector<double> edges, weights;
+    for (int i=0; i<n; ++i)
+        for (int j=i+1; j<n; ++j)
+        {
+            if (rand()%5==0 || (i/10==j/10 && rand()%2))
+            {
+                edges.push_back(i);
+                edges.push_back(j);
+                weights.push_back(1+rand()%3);
+            }
+        }
+    GraphC g(edges.data(),weights.data(),weights.size());
+    int nfail = 0;
+
+    // Every optimization draws from the stream of its CommunityStructure, the results run concurrently
+    // are the ones run one after the other
+    const OptimizerType methods[] = {MethodAgglomerative, MethodRandom};
+    for (int m=0; m<2; ++m)
+    {
+        const int nthreads = 4;
+        vector<Membership> sequential(nthreads), concurrent(nthreads);
+        vector<double> q_sequential(nthreads), q_concurrent(nthreads);
+        for (int t=0; t<nthreads; ++t)
+            sequential[t] = run_optimization(&g,methods[m],t+1,&q_sequential[t]);
+        vector<std::thread> threads;
+        for (int t=0; t<nthreads; ++t)
+            threads.push_back(std::thread([&,t]() { concurrent[t] = run_optimization(&g,methods[m],t+1,&q_concurrent[t]); }));
+        for (int t=0; t<nthreads; ++t)
+            threads[t].join();
+        bool same = true;
+        for (int t=0; t<nthreads; ++t)
+            same = same && sequential[t]==concurrent[t] && q_sequential[t]==q_concurrent[t];
+        cout << "Method " << methods[m] << " concurrent runs reproducible: " << (same ? "OK" : "FAIL") << endl;
+        nfail += !same;
+    }
+
+    return nfail;
+}
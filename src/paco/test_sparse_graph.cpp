@@ -0,0 +1,162 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2015 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+#include "Graph.h"
+#include "Community.h"
+
+using namespace std;
+
+/**
+ * @brief same_graph Check that two graphs have the same edges in the same order and the same weights
+ */
+bool same_graph(const GraphC &a, const GraphC &b)
+{
+    if (a.number_of_nodes()!=b.number_of_nodes() || a.number_of_edges()!=b.number_of_edges() || a.is_weighted()!=b.is_weighted())
+        return false;
+    for (size_t e=0; e<a.number_of_edges(); ++e)
+    {
+        if (a.get_edge(e)!=b.get_edge(e))
+            return false;
+        if (a.is_weighted() && VECTOR(*a.get_edge_weights())[e]!=VECTOR(*b.get_edge_weights())[e])
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    srand(1);
+    const int n = 80;
+    Eigen::MatrixXd W = Eigen::MatrixXd::Zero(n,n);
+    for (int i=0; i<n; ++i)
+        for (int j=i+1; j<n; ++j)
+            if (rand()%5==0)
+                W(i,j) = W(j,i) = 0.25*(1+rand()%8); // exactly representable as float too
+
+    GraphC dense(W);
+    int nfail = 0;
+
+    // Eigen sparse matrix
+    Eigen::SparseMatrix<double> S = W.sparseView();
+    GraphC eigen_sparse(S);
+    cout << "Eigen::SparseMatrix: " << (same_graph(dense,eigen_sparse) ? "OK" : "FAIL") << endl;
+    nfail += !same_graph(dense,eigen_sparse);
+
+    // CSR arrays with 32 and 64 bit indices, single and double precision values
+    vector<int32_t> indptr32(1,0), indices32;
+    vector<int64_t> indptr64(1,0), indices64;
+    vector<float> values32;
+    vector<double> values64;
+    // COO arrays of the lower triangle only
+    vector<int32_t> rows_lower, cols_lower;
+    vector<float> values_lower;
+    for (int i=0; i<n; ++i)
+    {
+        for (int j=0; j<n; ++j)
+        {
+            if (W(i,j)==0)
+                continue;
+            indices32.push_back(j);
+            indices64.push_back(j);
+            values32.push_back(W(i,j));
+            values64.push_back(W(i,j));
+            if (i>j)
+            {
+                rows_lower.push_back(i);
+                cols_lower.push_back(j);
+                values_lower.push_back(W(i,j));
+            }
+        }
+        indptr32.push_back(indices32.size());
+        indptr64.push_back(indices64.size());
+    }
+    GraphC csr32f(n,indptr32.data(),indices32.data(),values32.data());
+    GraphC csr64d(static_cast<int64_t>(n),indptr64.data(),indices64.data(),values64.data());
+    GraphC coo_lower(n,rows_lower.size(),rows_lower.data(),cols_lower.data(),values_lower.data());
+    cout << "CSR int32/float: " << (same_graph(dense,csr32f) ? "OK" : "FAIL") << endl;
+    cout << "CSR int64/double: " << (same_graph(dense,csr64d) ? "OK" : "FAIL") << endl;
+    // Lower triangle in row major order gives the edges in column major order of the upper triangle
+    bool coo_ok = coo_lower.number_of_edges()==dense.number_of_edges() && coo_lower.is_weighted();
+    cout << "COO lower triangle: " << (coo_ok ? "OK" : "FAIL") << endl;
+    nfail += !same_graph(dense,csr32f) + !same_graph(dense,csr64d) + !coo_ok;
+
+    // Row major edges lists of integers and floats, as numpy arrays, and of doubles through the old interface
+    vector<int64_t> edges64;
+    vector<float> edges_weights32;
+    vector<double> edges_weights64;
+    for (int i=0; i<n; ++i)
+    {
+        for (int j=i+1; j<n; ++j)
+        {
+            if (W(i,j)==0)
+                continue;
+            edges64.push_back(i);
+            edges64.push_back(j);
+            edges_weights32.push_back(i);
+            edges_weights32.push_back(j);
+            edges_weights32.push_back(W(i,j));
+            edges_weights64.push_back(i);
+            edges_weights64.push_back(j);
+            edges_weights64.push_back(W(i,j));
+        }
+    }
+    GraphC edges_int64, edges_float, edges_double;
+    edges_int64.init_edges(edges64.data(),edges64.size()/2,false);
+    edges_float.init_edges(edges_weights32.data(),edges_weights32.size()/3,true);
+    edges_double.init(edges_weights64.data(),1,edges_weights64.size()/3);
+    bool edges_ok = same_graph(dense,edges_float) && same_graph(dense,edges_double) && !edges_int64.is_weighted()
+            && edges_int64.number_of_edges()==dense.number_of_edges();
+    cout << "Edges lists: " << (edges_ok ? "OK" : "FAIL") << endl;
+    nfail += !edges_ok;
+
+    // Invalid inputs must throw
+    vector<int32_t> bad_indices(indices32);
+    bad_indices[0] = n;
+    try
+    {
+        GraphC bad(n,indptr32.data(),bad_indices.data(),values32.data());
+        cout << "Out of range index: FAIL" << endl;
+        ++nfail;
+    }
+    catch (std::logic_error &e)
+    {
+        cout << "Out of range index: OK (" << e.what() << ")" << endl;
+    }
+
+    CommunityStructure c1(&dense), c2(&csr32f);
+    c1.set_random_seed(1);
+    double q1 = c1.optimize(QualityAsymptoticSurprise,MethodAgglomerative,3);
+    c2.set_random_seed(1);
+    double q2 = c2.optimize(QualityAsymptoticSurprise,MethodAgglomerative,3);
+    cout << "Asymptotic surprise dense=" << q1 << " CSR=" << q2 << " " << (q1==q2 ? "OK" : "FAIL") << endl;
+    nfail += (q1!=q2);
+    return nfail;
+}
@@ -0,0 +1,110 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2015 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+
+#include "Graph.h"
+#include "ThresholdSweep.h"
+#include "AsymptoticSurpriseFunction.h"
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+    // Six heavy cliques of 10 vertices on a complete graph of light edges
+    const int ncliques = 6, size = 10, n = ncliques*size;
+    srand(3);
+    vector<double> edges, weights;
+    for (int i=0; i<n; ++i)
+        for (int j=i+1; j<n; ++j)
+        {
+            edges.push_back(i);
+            edges.push_back(j);
+            if (i/size==j/size)
+                weights.push_back(0.6+0.4*double(rand())/RAND_MAX);
+            else
+                weights.push_back(0.05+0.25*double(rand())/RAND_MAX);
+        }
+    GraphC g(edges.data(),weights.data(),weights.size());
+    int nfail = 0;
+
+    // Densities in any order, steps in increasing density
+    vector<double> densities;
+    densities.push_back(0.3);
+    densities.push_back(0.1);
+    densities.push_back(0.15);
+    densities.push_back(0.5);
+    vector<ThresholdStep> steps = ThresholdSweep(g).run(densities,QualityAsymptoticSurprise,MethodAgglomerative,2,1);
+
+    vector<double> sorted_weights(weights);
+    sort(sorted_weights.rbegin(),sorted_weights.rend());
+    const double npairs = n*(n-1)/2.0;
+    bool steps_ok = steps.size()==densities.size();
+    for (size_t t=0; steps_ok && t<steps.size(); ++t)
+    {
+        size_t k = static_cast<size_t>(floor(steps[t].density*npairs+0.5));
+        steps_ok = steps_ok && steps[t].num_edges==k && steps[t].min_weight==sorted_weights[k-1] && steps[t].membership.size()==size_t(n);
+        if (t>0)
+            steps_ok = steps_ok && steps[t].density>steps[t-1].density && steps[t].min_weight<=steps[t-1].min_weight;
+    }
+    cout << "Steps in increasing density: " << (steps_ok ? "OK" : "FAIL") << endl;
+    nfail += !steps_ok;
+    if (!steps_ok)
+        return nfail;
+
+    // The quality of every step is the one of its partition on the thresholded graph
+    AsymptoticSurpriseFunction fun;
+    for (size_t t=0; t<steps.size(); ++t)
+    {
+        vector<double> th_edges, th_weights;
+        for (size_t e=0; e<weights.size(); ++e)
+        {
+            if (weights[e]>=steps[t].min_weight)
+            {
+                th_edges.push_back(edges[2*e]);
+                th_edges.push_back(edges[2*e+1]);
+                th_weights.push_back(weights[e]);
+            }
+        }
+        GraphC th(th_edges.data(),th_weights.data(),th_weights.size());
+        double q = fun(th.get_igraph(),steps[t].membership,th.get_weights());
+        bool quality_ok = th.number_of_edges()==steps[t].num_edges && fabs(q-steps[t].quality)<1E-9*fabs(q);
+        cout << "Density " << steps[t].density << " quality " << steps[t].quality << " " << q << ": " << (quality_ok ? "OK" : "FAIL") << endl;
+        nfail += !quality_ok;
+    }
+
+    // Near the density of the cliques they are recovered exactly
+    bool cliques_ok = true;
+    const Membership &memb = steps[1].membership;
+    for (int v=0; v<n; ++v)
+        cliques_ok = cliques_ok && memb[v]==uint32_t(v/size);
+    cout << "Cliques recovered: " << (cliques_ok ? "OK" : "FAIL") << endl;
+    nfail += !cliques_ok;
+
+    return nfail;
+}
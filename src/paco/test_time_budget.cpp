@@ -0,0 +1,101 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2015 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "Graph.h"
+#include "Community.h"
+#include "BenchmarkGraphs.h"
+#include "Timer.h"
+
+using namespace std;
+
+/**
+ * @brief valid_membership true if every vertex has a community in [0,n)
+ */
+static bool valid_membership(const CommunityStructure &c, size_t n)
+{
+    vector<int> memb = c.get_membership_vector();
+    if (memb.size()!=n)
+        return false;
+    for (size_t i=0; i<n; ++i)
+        if (memb[i]<0 || static_cast<size_t>(memb[i])>=n)
+            return false;
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    BenchmarkGraph bg;
+    planted_partition_graph(2000,20,0.05,0.2,1,&bg);
+    set_benchmark_weights(&bg,0.5,2);
+    unique_ptr<GraphC> binary = bg.to_graph(false);
+    unique_ptr<GraphC> weighted = bg.to_graph(true);
+    const size_t n = bg.num_nodes;
+    const double budget = 200; // milliseconds
+    int nfail = 0;
+
+    // Far more repetitions than the budget allows, every optimizer returns soon after it with a valid partition
+    const char *method_names[] = {"Agglomerative", "Random"};
+    for (int m=MethodAgglomerative; m<=MethodRandom; ++m)
+    {
+        CommunityStructure c(weighted.get());
+        c.set_random_seed(5);
+        c.set_time_budget(budget);
+        Timer timer;
+        timer.start();
+        double q = c.optimize(QualityAsymptoticSurprise,static_cast<OptimizerType>(m),100000);
+        timer.stop();
+        double elapsed = timer.getElapsedTimeInMilliSec();
+        bool ok = c.time_budget_expired() && elapsed<budget+500 && q>0 && valid_membership(c,n);
+        cout << "Time budget of " << method_names[m] << " (" << elapsed << " ms): " << (ok ? "OK" : "FAIL") << endl;
+        nfail += !ok;
+    }
+
+    // A budget large enough leaves the result unchanged
+    CommunityStructure unlimited(binary.get()), limited(binary.get());
+    unlimited.set_random_seed(7);
+    limited.set_random_seed(7);
+    limited.set_time_budget(1E7);
+    double q_unlimited = unlimited.optimize(QualitySurprise,MethodAgglomerative,2);
+    double q_limited = limited.optimize(QualitySurprise,MethodAgglomerative,2);
+    bool same_ok = !limited.time_budget_expired() && q_unlimited==q_limited
+            && unlimited.get_membership_vector()==limited.get_membership_vector();
+    cout << "Time budget not reached: " << (same_ok ? "OK" : "FAIL") << endl;
+    nfail += !same_ok;
+
+    // A budget already over still gives a partition, the one reached by the first moves
+    CommunityStructure tiny(binary.get());
+    tiny.set_random_seed(7);
+    tiny.set_time_budget(1E-3);
+    double q_tiny = tiny.optimize(QualitySurprise,MethodAgglomerative,10);
+    bool tiny_ok = tiny.time_budget_expired() && q_tiny<=q_limited && valid_membership(tiny,n);
+    cout << "Time budget expired at start: " << (tiny_ok ? "OK" : "FAIL") << endl;
+    nfail += !tiny_ok;
+
+    return nfail;
+}
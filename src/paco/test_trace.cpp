@@ -0,0 +1,92 @@
+/* This file is part of PACO-PArtitioning Clustering Optimization a program
+* to find network partitions using modular solvers and quality functions.
+*
+*  Copyright (C) 2015 Carlo Nicolini <carlo.nicolini@iit.it>
+*
+*  PACO is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 3 of the License, or (at your option) any later version.
+*
+*  Alternatively, you can redistribute it and/or
+*  modify it under the terms of the GNU General Public License as
+*  published by the Free Software Foundation; either version 2 of
+*  the License, or (at your option) any later version.
+*
+*  PACO is distributed in the hope that it will be useful, but WITHOUT ANY
+*  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+*  FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License or the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU Lesser General Public
+*  License and a copy of the GNU General Public License along with
+*  PACO. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+
+#include "Trace.h"
+
+using namespace std;
+
+/**
+ * @brief count Number of occurrences of what in text
+ */
+static size_t count(const string &text, const string &what)
+{
+    size_t n = 0;
+    for (size_t pos=text.find(what); pos!=string::npos; pos=text.find(what,pos+1))
+        ++n;
+    return n;
+}
+
+int main(int argc, char *argv[])
+{
+    int nfail = 0;
+
+    // Nested scopes, the inner one ends first and lies within the outer one
+    {
+        TraceScope outer("outer");
+        {
+            TraceScope inner("inner");
+        }
+    }
+    vector<TraceEvent> events;
+    trace_buffer().snapshot(events);
+    bool nested_ok = events.size()==2 && string(events[0].name)=="inner" && string(events[1].name)=="outer"
+            && events[1].begin<=events[0].begin && events[0].end<=events[1].end && events[0].begin<=events[0].end;
+    cout << "Nested scopes: " << (nested_ok ? "OK" : "FAIL") << endl;
+    nfail += !nested_ok;
+
+    // Every thread records in its own buffer, exported with its own thread id
+    vector<thread> workers;
+    for (int t=0; t<4; ++t)
+        workers.push_back(thread([]() {
+            for (int i=0; i<100; ++i)
+                TraceScope scope("worker");
+        }));
+    for (size_t t=0; t<workers.size(); ++t)
+        workers[t].join();
+    string json = trace_to_chrome_json();
+    bool threads_ok = json.compare(0,15,"{\"traceEvents\":")==0 && count(json,"\"name\":\"worker\"")==400
+            && count(json,"\"name\":\"outer\"")==1 && count(json,"\"ph\":\"X\"")==402 && count(json,"\"tid\":1,")==2;
+    cout << "Threads export: " << (threads_ok ? "OK" : "FAIL") << endl;
+    nfail += !threads_ok;
+
+    // The ring keeps the last events, clear drops all of them
+    TraceBuffer ring(7,8);
+    static const char *names[] = {"e0","e1","e2","e3","e4","e5","e6","e7","e8","e9","e10","e11"};
+    for (int i=0; i<12; ++i)
+        ring.record(names[i],i,i+1);
+    events.clear();
+    ring.snapshot(events);
+    bool ring_ok = events.size()==8 && string(events[0].name)=="e4" && string(events[7].name)=="e11";
+    clear_trace();
+    ring_ok = ring_ok && count(trace_to_chrome_json(),"\"ph\":\"X\"")==0;
+    cout << "Ring buffer: " << (ring_ok ? "OK" : "FAIL") << endl;
+    nfail += !ring_ok;
+
+    return nfail;
+}